@@ -0,0 +1,123 @@
+#include "allocTracker.h"
+
+//Using atomics, the C allocator and allocation exceptions
+#include <atomic>
+#include <stdlib.h>
+#include <new>
+
+//The subsystem this thread's allocations count against
+static thread_local int tSubsystem = ALLOC_UNSCOPED;
+
+//Allocation counts and bytes per subsystem, zero before any constructor runs
+static std::atomic<long long> gAllocationCounts[ ALLOC_SUBSYSTEMS ];
+static std::atomic<long long> gAllocationBytes[ ALLOC_SUBSYSTEMS ];
+
+AllocationScope::AllocationScope( int subsystem )
+{
+	mPrevious = tSubsystem;
+	tSubsystem = subsystem;
+}
+
+AllocationScope::~AllocationScope()
+{
+	tSubsystem = mPrevious;
+}
+
+bool allocationTracking()
+{
+	#ifdef TRACK_ALLOCATIONS
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+void recordAllocation( size_t bytes )
+{
+	gAllocationCounts[ tSubsystem ].fetch_add( 1, std::memory_order_relaxed );
+	gAllocationBytes[ tSubsystem ].fetch_add( (long long)bytes, std::memory_order_relaxed );
+}
+
+long long allocationCount( int subsystem )
+{
+	return gAllocationCounts[ subsystem ].load( std::memory_order_relaxed );
+}
+
+long long allocationBytes( int subsystem )
+{
+	return gAllocationBytes[ subsystem ].load( std::memory_order_relaxed );
+}
+
+const char* allocationSubsystemName( int subsystem )
+{
+	switch( subsystem )
+	{
+		case ALLOC_UNSCOPED: return "unscoped";
+		case ALLOC_LOADING: return "loading";
+		case ALLOC_INPUT: return "input";
+		case ALLOC_SIMULATION: return "simulation";
+		case ALLOC_RENDER: return "render";
+		case ALLOC_FRAME: return "frame";
+	}
+
+	return "unknown";
+}
+
+#ifdef TRACK_ALLOCATIONS
+
+//Counts and makes an allocation, new never returns null
+static void* countedAllocate( size_t size )
+{
+	recordAllocation( size );
+	void* memory = malloc( size > 0 ? size : 1 );
+	if( memory == NULL )
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+void* operator new( size_t size )
+{
+	return countedAllocate( size );
+}
+
+void* operator new[]( size_t size )
+{
+	return countedAllocate( size );
+}
+
+void* operator new( size_t size, const std::nothrow_t& ) noexcept
+{
+	recordAllocation( size );
+	return malloc( size > 0 ? size : 1 );
+}
+
+void* operator new[]( size_t size, const std::nothrow_t& ) noexcept
+{
+	recordAllocation( size );
+	return malloc( size > 0 ? size : 1 );
+}
+
+void operator delete( void* memory ) noexcept
+{
+	free( memory );
+}
+
+void operator delete[]( void* memory ) noexcept
+{
+	free( memory );
+}
+
+void operator delete( void* memory, const std::nothrow_t& ) noexcept
+{
+	free( memory );
+}
+
+void operator delete[]( void* memory, const std::nothrow_t& ) noexcept
+{
+	free( memory );
+}
+
+#endif
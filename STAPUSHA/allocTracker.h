@@ -0,0 +1,48 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+//Using sizes
+#include <stddef.h>
+
+/*Builds with TRACK_ALLOCATIONS defined replace the global operator new and delete to count
+every heap allocation, split by the subsystem the allocating thread is working for.
+Without it every count stays 0 and scopes cost next to nothing.*/
+
+//The subsystems allocations are counted against
+enum AllocationSubsystem
+{
+	ALLOC_UNSCOPED,
+	ALLOC_LOADING,
+	ALLOC_INPUT,
+	ALLOC_SIMULATION,
+	ALLOC_RENDER,
+	ALLOC_FRAME,
+	ALLOC_SUBSYSTEMS
+};
+
+//Counts allocations on this thread against a subsystem until it goes out of scope
+class AllocationScope
+{
+	public:
+		AllocationScope( int subsystem );
+		~AllocationScope();
+
+	private:
+		//The subsystem to go back to
+		int mPrevious;
+};
+
+//Checks whether allocations are being counted in this build
+bool allocationTracking();
+
+//Counts an allocation made outside operator new, like one through SDL's allocator
+void recordAllocation( size_t bytes );
+
+//Gets the allocations counted against a subsystem so far
+long long allocationCount( int subsystem );
+long long allocationBytes( int subsystem );
+
+//Gets a subsystem's name for reports
+const char* allocationSubsystemName( int subsystem );
+
+#endif
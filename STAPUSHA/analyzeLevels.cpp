@@ -0,0 +1,137 @@
+/*Measures the difficulty of every level in a pack, or the shipped ones, across every core.
+Usage: LevelAnalyzer [--pack path] [--out path] [--node-limit n] [--solution-cap n]
+Writes one CSV row per level to --out, or to standard output.*/
+
+//Using standard IO, the standard library, strings, vectors and timers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+
+#include "board.h"
+#include "levels.h"
+#include "levelPack.h"
+#include "levelMetrics.h"
+#include "parallel.h"
+
+int main( int argc, char* args[] )
+{
+	const char* packPath = NULL;
+	const char* outPath = NULL;
+	MetricSettings settings;
+
+	for( int i = 1; i + 1 < argc; i += 2 )
+	{
+		const char* value = args[ i + 1 ];
+		if( strcmp( args[ i ], "--pack" ) == 0 )
+		{
+			packPath = value;
+		}
+		else if( strcmp( args[ i ], "--out" ) == 0 )
+		{
+			outPath = value;
+		}
+		else if( strcmp( args[ i ], "--node-limit" ) == 0 )
+		{
+			settings.nodeLimit = atoi( value );
+		}
+		else if( strcmp( args[ i ], "--solution-cap" ) == 0 )
+		{
+			settings.solutionCap = atoll( value );
+		}
+		else
+		{
+			printf( "Unknown option %s!\n", args[ i ] );
+			return 1;
+		}
+	}
+
+	//Every level as a self-contained pack level, the shipped ones share levelOne.map's grid
+	std::vector<PackLevel> levels;
+	Board shippedBoard;
+	if( packPath != NULL )
+	{
+		if( !loadLevelPack( packPath, levels ) )
+		{
+			return 1;
+		}
+	}
+	else
+	{
+		if( !shippedBoard.loadFromFile( LEVEL_MAP_PATH ) )
+		{
+			printf( "Failed to load board!\n" );
+			return 1;
+		}
+
+		levels.resize( TOTAL_LEVELS );
+		for( int i = 0; i < TOTAL_LEVELS; ++i )
+		{
+			levels[ i ].columns = shippedBoard.getColumns();
+			levels[ i ].rows = shippedBoard.getRows();
+			levels[ i ].start.player = shippedBoard.cellFromEntity( gLevels[ i ].dot.x, gLevels[ i ].dot.y );
+			levels[ i ].start.starCount = levelStarCells( shippedBoard, gLevels[ i ], levels[ i ].start.stars );
+			sortStars( levels[ i ].start );
+			levels[ i ].goalCount = levelGoalCells( shippedBoard, gLevels[ i ], levels[ i ].goals );
+		}
+	}
+
+	if( levels.empty() )
+	{
+		printf( "No levels to analyze!\n" );
+		return 1;
+	}
+
+	//Each level is one job, the slow ones decide how long the pack takes
+	int count = (int)levels.size();
+	std::vector<LevelMetrics> metrics( count );
+	std::vector<double> milliseconds( count );
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	parallelFor( count, [ & ]( int i )
+	{
+		std::chrono::steady_clock::time_point levelStart = std::chrono::steady_clock::now();
+		if( packPath != NULL )
+		{
+			Board board;
+			packLevelBoard( levels[ i ], board );
+			analyzeLevel( board, levels[ i ].start, levels[ i ].goals, levels[ i ].goalCount, settings, metrics[ i ] );
+		}
+		else
+		{
+			analyzeLevel( shippedBoard, levels[ i ].start, levels[ i ].goals, levels[ i ].goalCount, settings, metrics[ i ] );
+		}
+		milliseconds[ i ] = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - levelStart ).count();
+	} );
+	double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	FILE* out = outPath != NULL ? fopen( outPath, "w" ) : stdout;
+	if( out == NULL )
+	{
+		printf( "Unable to write metrics %s!\n", outPath );
+		return 1;
+	}
+
+	fprintf( out, "level,columns,rows,stars,optimal_moves,optimal_pushes,pushes_in_optimal_moves,branching_factor,"
+		"floor_squares,dead_squares,optimal_solutions,move_nodes,push_nodes,milliseconds\n" );
+	int unsolved = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		const LevelMetrics& level = metrics[ i ];
+		fprintf( out, "%d,%d,%d,%d,%d,%d,%d,%.3f,%d,%d,%lld,%d,%d,%.1f\n", i + 1, levels[ i ].columns, levels[ i ].rows,
+			levels[ i ].start.starCount, level.optimalMoves, level.optimalPushes, level.pushesInOptimalMoves, level.branchingFactor,
+			level.floorSquares, level.deadSquares, level.optimalSolutions, level.moveNodes, level.pushNodes, milliseconds[ i ] );
+		unsolved += level.optimalMoves < 0 || level.optimalPushes < 0;
+	}
+
+	if( out != stdout && fclose( out ) != 0 )
+	{
+		printf( "Unable to write metrics %s!\n", outPath );
+		return 1;
+	}
+
+	//Keep the summary out of the CSV when that goes to standard output
+	fprintf( out == stdout ? stderr : stdout, "Analyzed %d levels in %.2f s on %d workers, %.1f levels per second, %d searches gave up\n",
+		count, seconds, workerCount(), count / seconds, unsolved );
+	return 0;
+}
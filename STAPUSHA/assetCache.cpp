@@ -0,0 +1,510 @@
+#include "assetCache.h"
+#include "mappedFile.h"
+#include "parallel.h"
+
+//Using standard IO, string functions, timers and directory creation
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+//The stored pixel file format version
+const unsigned int PIXEL_BLOB_VERSION = 1;
+
+//Kept to this file
+namespace
+{
+
+//Stored pixels start with this header, the rows follow
+struct PixelBlobHeader
+{
+	char magic[ 4 ];
+	unsigned int version;
+	unsigned long long sourceHash;
+	unsigned int format;
+	int width;
+	int height;
+	int pitch;
+};
+
+}
+
+//Gets milliseconds elapsed since a start time
+static double millisecondsSince( std::chrono::steady_clock::time_point start )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+//Picks the first 32 bit format with alpha the renderer takes without converting
+static Uint32 nativeFormat( SDL_Renderer* renderer )
+{
+	SDL_RendererInfo info;
+	if( SDL_GetRendererInfo( renderer, &info ) == 0 )
+	{
+		for( Uint32 i = 0; i < info.num_texture_formats; ++i )
+		{
+			if( SDL_ISPIXELFORMAT_ALPHA( info.texture_formats[ i ] ) && SDL_BYTESPERPIXEL( info.texture_formats[ i ] ) == 4 )
+			{
+				return info.texture_formats[ i ];
+			}
+		}
+	}
+
+	return SDL_PIXELFORMAT_ARGB8888;
+}
+
+//Creates a blended texture from pixels already in its format
+static SDL_Texture* uploadPixels( SDL_Renderer* renderer, Uint32 format, int width, int height, const void* pixels, int pitch )
+{
+	SDL_Texture* texture = SDL_CreateTexture( renderer, format, SDL_TEXTUREACCESS_STATIC, width, height );
+	if( texture == NULL )
+	{
+		return NULL;
+	}
+
+	//The color key is already alpha
+	if( SDL_UpdateTexture( texture, NULL, pixels, pitch ) != 0 || SDL_SetTextureBlendMode( texture, SDL_BLENDMODE_BLEND ) != 0 )
+	{
+		SDL_DestroyTexture( texture );
+		return NULL;
+	}
+
+	return texture;
+}
+
+//Reads the header of stored pixels, returns false if it's stale
+//Stale if the image changed, the renderer wants another format or the file was cut short
+static bool readPixelHeader( const MappedFile& blob, unsigned long long sourceHash, Uint32 format, PixelBlobHeader& header )
+{
+	if( blob.getSize() < sizeof( header ) )
+	{
+		return false;
+	}
+
+	memcpy( &header, blob.getData(), sizeof( header ) );
+	return memcmp( header.magic, "SIMG", 4 ) == 0 && header.version == PIXEL_BLOB_VERSION && header.sourceHash == sourceHash &&
+		header.format == format && header.width > 0 && header.height > 0 && header.pitch >= header.width * 4 &&
+		blob.getSize() >= sizeof( header ) + (size_t)header.pitch * header.height;
+}
+
+//Writes converted pixels beside blobPath and renames them into place, so a blob is only ever seen whole
+static bool storePixels( const std::string& blobPath, unsigned long long sourceHash, Uint32 format, const SDL_Surface* converted )
+{
+	PixelBlobHeader header;
+	memcpy( header.magic, "SIMG", 4 );
+	header.version = PIXEL_BLOB_VERSION;
+	header.sourceHash = sourceHash;
+	header.format = format;
+	header.width = converted->w;
+	header.height = converted->h;
+	header.pitch = converted->pitch;
+
+	std::string temporary = blobPath + ".tmp";
+	FILE* file = fopen( temporary.c_str(), "wb" );
+	if( file == NULL )
+	{
+		return false;
+	}
+
+	bool written = fwrite( &header, sizeof( header ), 1, file ) == 1 &&
+		fwrite( converted->pixels, converted->pitch, converted->h, file ) == (size_t)converted->h;
+	if( fclose( file ) != 0 || !written )
+	{
+		remove( temporary.c_str() );
+		return false;
+	}
+
+	#ifdef _WIN32
+	remove( blobPath.c_str() );
+	#endif
+	if( rename( temporary.c_str(), blobPath.c_str() ) != 0 )
+	{
+		remove( temporary.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+AssetCache::AssetCache()
+{
+	//Initialize
+	mHits = 0;
+	mMisses = 0;
+	mSurfaceBytes = 0;
+	mTextureBytes = 0;
+	mDecodes = 0;
+	mUploads = 0;
+	mDecodeMs = 0.0;
+	mUploadMs = 0.0;
+}
+
+void AssetCache::setImageCacheDirectory( const std::string& directory )
+{
+	mImageCacheDirectory = directory;
+	if( !directory.empty() )
+	{
+		#ifdef _WIN32
+		_mkdir( directory.c_str() );
+		#else
+		mkdir( directory.c_str(), 0755 );
+		#endif
+	}
+}
+
+SurfaceHandle AssetCache::loadSurface( const std::string& path )
+{
+	std::unordered_map<std::string, SurfaceEntry>::iterator cached = mSurfaces.find( path );
+	if( cached != mSurfaces.end() )
+	{
+		++mHits;
+		return cached->second.surface;
+	}
+
+	++mMisses;
+
+	//Load image at specified path
+	SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+	if( loadedSurface == NULL )
+	{
+		printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+		return SurfaceHandle();
+	}
+
+	SurfaceEntry entry;
+	entry.surface = SurfaceHandle( loadedSurface, SDL_FreeSurface );
+	entry.bytes = (size_t)loadedSurface->pitch * loadedSurface->h;
+	mSurfaces[ path ] = entry;
+	mSurfaceBytes += entry.bytes;
+
+	return entry.surface;
+}
+
+TextureHandle AssetCache::loadTexture( SDL_Renderer* renderer, const std::string& path, int* width, int* height )
+{
+	std::unordered_map<std::string, TextureEntry>::iterator cached = mTextures.find( path );
+	if( cached == mTextures.end() )
+	{
+		++mMisses;
+
+		//Upload what prepareTextures decoded, or stored pixels if they're still good, otherwise decode and store them
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		int imageWidth = 0, imageHeight = 0;
+		SDL_Texture* newTexture = NULL;
+		std::unordered_map<std::string, SurfaceHandle>::iterator prepared = mPrepared.find( path );
+		if( prepared != mPrepared.end() )
+		{
+			SDL_Surface* surface = prepared->second.get();
+			imageWidth = surface->w;
+			imageHeight = surface->h;
+			newTexture = uploadPixels( renderer, surface->format->format, imageWidth, imageHeight, surface->pixels, surface->pitch );
+			mPrepared.erase( prepared );
+		}
+
+		if( newTexture != NULL )
+		{
+			//The decode was counted when it was prepared
+			++mUploads;
+			mUploadMs += millisecondsSince( start );
+		}
+		else
+		{
+			unsigned long long sourceHash = 0;
+			std::string blobPath = mImageCacheDirectory.empty() ? std::string() : storedPixelPath( path, sourceHash );
+			newTexture = blobPath.empty() ? NULL : uploadStoredTexture( renderer, blobPath, sourceHash, imageWidth, imageHeight );
+			if( newTexture != NULL )
+			{
+				++mUploads;
+				mUploadMs += millisecondsSince( start );
+			}
+			else
+			{
+				newTexture = decodeTexture( renderer, path, blobPath, sourceHash, imageWidth, imageHeight );
+				if( newTexture == NULL )
+				{
+					return TextureHandle();
+				}
+
+				++mDecodes;
+				mDecodeMs += millisecondsSince( start );
+			}
+		}
+
+		Uint32 format = 0;
+		TextureEntry entry;
+		entry.texture = TextureHandle( newTexture, SDL_DestroyTexture );
+		entry.width = imageWidth;
+		entry.height = imageHeight;
+		SDL_QueryTexture( newTexture, &format, NULL, NULL, NULL );
+		entry.bytes = (size_t)entry.width * entry.height * SDL_BYTESPERPIXEL( format );
+
+		cached = mTextures.insert( std::make_pair( path, entry ) ).first;
+		mTextureBytes += entry.bytes;
+	}
+	else
+	{
+		++mHits;
+	}
+
+	if( width != NULL )
+	{
+		*width = cached->second.width;
+	}
+
+	if( height != NULL )
+	{
+		*height = cached->second.height;
+	}
+
+	return cached->second.texture;
+}
+
+void AssetCache::prepareTextures( SDL_Renderer* renderer, const std::vector<std::string>& paths )
+{
+	//What one job decodes
+	struct Preparation
+	{
+		std::string path;
+		SurfaceHandle surface;
+	};
+
+	std::vector<Preparation> preparations;
+	for( size_t i = 0; i < paths.size(); ++i )
+	{
+		if( mTextures.find( paths[ i ] ) == mTextures.end() && mPrepared.find( paths[ i ] ) == mPrepared.end() )
+		{
+			Preparation preparation;
+			preparation.path = paths[ i ];
+			preparations.push_back( preparation );
+		}
+	}
+
+	if( preparations.empty() )
+	{
+		return;
+	}
+
+	//The renderer is only touched here on the calling thread, the jobs just decode and convert
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Uint32 format = nativeFormat( renderer );
+	std::vector<JobHandle> jobs;
+	for( size_t i = 0; i < preparations.size(); ++i )
+	{
+		Preparation* preparation = &preparations[ i ];
+		jobs.push_back( submitJob( [ this, preparation, format ]()
+		{
+			//Stored pixels that are still good upload fast enough as they are
+			unsigned long long sourceHash = 0;
+			std::string blobPath = mImageCacheDirectory.empty() ? std::string() : storedPixelPath( preparation->path, sourceHash );
+			if( !blobPath.empty() )
+			{
+				MappedFile blob;
+				PixelBlobHeader header;
+				if( blob.open( blobPath ) && readPixelHeader( blob, sourceHash, format, header ) )
+				{
+					return;
+				}
+			}
+
+			//Failures are left for loadTexture to decode again and report
+			SDL_Surface* loadedSurface = IMG_Load( preparation->path.c_str() );
+			if( loadedSurface == NULL )
+			{
+				return;
+			}
+
+			SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 255, 255 ) );
+			SDL_Surface* converted = SDL_ConvertSurfaceFormat( loadedSurface, format, 0 );
+			SDL_FreeSurface( loadedSurface );
+			if( converted == NULL )
+			{
+				return;
+			}
+
+			if( !blobPath.empty() )
+			{
+				storePixels( blobPath, sourceHash, format, converted );
+			}
+			preparation->surface = SurfaceHandle( converted, SDL_FreeSurface );
+		} ) );
+	}
+
+	for( size_t i = 0; i < jobs.size(); ++i )
+	{
+		waitForJob( jobs[ i ] );
+	}
+
+	for( size_t i = 0; i < preparations.size(); ++i )
+	{
+		if( preparations[ i ].surface )
+		{
+			mPrepared[ preparations[ i ].path ] = preparations[ i ].surface;
+			++mDecodes;
+		}
+	}
+	mDecodeMs += millisecondsSince( start );
+}
+
+void AssetCache::releaseUnused()
+{
+	for( std::unordered_map<std::string, SurfaceEntry>::iterator i = mSurfaces.begin(); i != mSurfaces.end(); )
+	{
+		if( i->second.surface.use_count() == 1 )
+		{
+			mSurfaceBytes -= i->second.bytes;
+			i = mSurfaces.erase( i );
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	for( std::unordered_map<std::string, TextureEntry>::iterator i = mTextures.begin(); i != mTextures.end(); )
+	{
+		if( i->second.texture.use_count() == 1 )
+		{
+			mTextureBytes -= i->second.bytes;
+			i = mTextures.erase( i );
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void AssetCache::clear()
+{
+	mPrepared.clear();
+	mSurfaces.clear();
+	mTextures.clear();
+	mSurfaceBytes = 0;
+	mTextureBytes = 0;
+}
+
+int AssetCache::getHits() const
+{
+	return mHits;
+}
+
+int AssetCache::getMisses() const
+{
+	return mMisses;
+}
+
+size_t AssetCache::getSurfaceBytes() const
+{
+	return mSurfaceBytes;
+}
+
+size_t AssetCache::getTextureBytes() const
+{
+	return mTextureBytes;
+}
+
+void AssetCache::printStats() const
+{
+	printf( "Image decoding: %d decoded in %.2f ms, %d uploaded from stored pixels in %.2f ms\n", mDecodes, mDecodeMs, mUploads, mUploadMs );
+	printf( "Asset cache: %d hits, %d misses, %d surfaces in %.1f KB, %d textures in %.1f KB\n", mHits, mMisses,
+		(int)mSurfaces.size(), mSurfaceBytes / 1024.0, (int)mTextures.size(), mTextureBytes / 1024.0 );
+}
+
+SDL_Texture* AssetCache::decodeTexture( SDL_Renderer* renderer, const std::string& path, const std::string& blobPath, unsigned long long sourceHash, int& width, int& height )
+{
+	//Load image at specified path
+	SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
+	if( loadedSurface == NULL )
+	{
+		printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+		return NULL;
+	}
+
+	//Color key image
+	SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 255, 255 ) );
+	width = loadedSurface->w;
+	height = loadedSurface->h;
+
+	SDL_Texture* newTexture = NULL;
+	if( blobPath.empty() )
+	{
+		//Create texture from surface pixels
+		newTexture = SDL_CreateTextureFromSurface( renderer, loadedSurface );
+	}
+	else
+	{
+		//Turn the color key into alpha in the renderer's own format, then keep a copy of the pixels
+		Uint32 format = nativeFormat( renderer );
+		SDL_Surface* converted = SDL_ConvertSurfaceFormat( loadedSurface, format, 0 );
+		if( converted != NULL )
+		{
+			if( !storePixels( blobPath, sourceHash, format, converted ) )
+			{
+				printf( "Warning: Unable to store decoded pixels of %s!\n", path.c_str() );
+			}
+
+			newTexture = uploadPixels( renderer, format, converted->w, converted->h, converted->pixels, converted->pitch );
+			SDL_FreeSurface( converted );
+		}
+	}
+
+	if( newTexture == NULL )
+	{
+		printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+	}
+
+	//Get rid of old loaded surface
+	SDL_FreeSurface( loadedSurface );
+
+	return newTexture;
+}
+
+SDL_Texture* AssetCache::uploadStoredTexture( SDL_Renderer* renderer, const std::string& blobPath, unsigned long long sourceHash, int& width, int& height )
+{
+	MappedFile blob;
+	if( !blob.open( blobPath ) )
+	{
+		return NULL;
+	}
+
+	PixelBlobHeader header;
+	if( !readPixelHeader( blob, sourceHash, nativeFormat( renderer ), header ) )
+	{
+		return NULL;
+	}
+
+	SDL_Texture* newTexture = uploadPixels( renderer, header.format, header.width, header.height, blob.getData() + sizeof( header ), header.pitch );
+	if( newTexture == NULL )
+	{
+		return NULL;
+	}
+
+	width = header.width;
+	height = header.height;
+	return newTexture;
+}
+
+std::string AssetCache::storedPixelPath( const std::string& path, unsigned long long& sourceHash ) const
+{
+	MappedFile source;
+	if( !source.open( path ) )
+	{
+		return std::string();
+	}
+
+	//FNV-1a over the file bytes
+	sourceHash = 14695981039346656037ull;
+	const unsigned char* data = source.getData();
+	for( size_t i = 0; i < source.getSize(); ++i )
+	{
+		sourceHash = ( sourceHash ^ data[ i ] ) * 1099511628211ull;
+	}
+
+	char name[ 32 ];
+	snprintf( name, sizeof( name ), "/%016llx.px", sourceHash );
+	return mImageCacheDirectory + name;
+}
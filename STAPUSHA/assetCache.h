@@ -0,0 +1,109 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+//Using SDL, SDL_image, strings, vectors, hash maps and shared pointers
+#include <SDL.h>
+#include <SDL_image.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+//Where pre-decoded pixels are kept between runs
+const char IMAGE_CACHE_PATH[] = "39_tiling/cache";
+
+//Shared handles to cached images, the image is freed once the cache and every holder let go
+typedef std::shared_ptr<SDL_Surface> SurfaceHandle;
+typedef std::shared_ptr<SDL_Texture> TextureHandle;
+
+//Loads every image once and hands out shared handles to it
+class AssetCache
+{
+	public:
+		//Initializes an empty cache
+		AssetCache();
+
+		//Keeps decoded, color keyed pixels in a directory so later runs skip decoding, empty turns it off
+		void setImageCacheDirectory( const std::string& directory );
+
+		//Gets the decoded surface of an image, decoding it on first use
+		SurfaceHandle loadSurface( const std::string& path );
+
+		//Gets the color keyed texture of an image, creating it on first use
+		TextureHandle loadTexture( SDL_Renderer* renderer, const std::string& path, int* width = NULL, int* height = NULL );
+
+		//Decodes the images not cached yet as jobs on the worker threads, so loadTexture only has to upload them
+		//Images with good stored pixels are left alone, uploading those is already cheap
+		void prepareTextures( SDL_Renderer* renderer, const std::vector<std::string>& paths );
+
+		//Drops the cache's hold on images nothing else is using
+		void releaseUnused();
+
+		//Drops the cache's hold on every image, call before destroying the renderer
+		void clear();
+
+		//Gets the lookup counters
+		int getHits() const;
+		int getMisses() const;
+
+		//Gets the bytes of surfaces and textures the cache holds
+		size_t getSurfaceBytes() const;
+		size_t getTextureBytes() const;
+
+		//Prints the counters
+		void printStats() const;
+
+	private:
+		//Decodes an image into a texture, storing its pixels at blobPath unless that's empty
+		SDL_Texture* decodeTexture( SDL_Renderer* renderer, const std::string& path, const std::string& blobPath, unsigned long long sourceHash, int& width, int& height );
+
+		//Uploads stored pixels, returns NULL if they're missing or stale
+		SDL_Texture* uploadStoredTexture( SDL_Renderer* renderer, const std::string& blobPath, unsigned long long sourceHash, int& width, int& height );
+
+		//Gets where an image's pixels are stored, keyed by a hash of its file, empty if the file can't be read
+		std::string storedPixelPath( const std::string& path, unsigned long long& sourceHash ) const;
+
+		//Copying would double count the images
+		AssetCache( const AssetCache& );
+		AssetCache& operator=( const AssetCache& );
+
+		//A cached texture with its size
+		struct TextureEntry
+		{
+			TextureHandle texture;
+			int width;
+			int height;
+			size_t bytes;
+		};
+
+		//A cached surface with its size
+		struct SurfaceEntry
+		{
+			SurfaceHandle surface;
+			size_t bytes;
+		};
+
+		//The images by path
+		std::unordered_map<std::string, SurfaceEntry> mSurfaces;
+		std::unordered_map<std::string, TextureEntry> mTextures;
+
+		//Images prepareTextures decoded into the renderer's format, waiting for loadTexture to upload them
+		std::unordered_map<std::string, SurfaceHandle> mPrepared;
+
+		//The persistent pixel cache
+		std::string mImageCacheDirectory;
+
+		//Time spent decoding and uploading stored pixels
+		int mDecodes;
+		int mUploads;
+		double mDecodeMs;
+		double mUploadMs;
+
+		//The counters
+		int mHits;
+		int mMisses;
+		size_t mSurfaceBytes;
+		size_t mTextureBytes;
+};
+
+#endif
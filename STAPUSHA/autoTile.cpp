@@ -0,0 +1,96 @@
+#include "autoTile.h"
+
+int openSides( const Board& board, int cell )
+{
+	int sides = 0;
+	sides |= board.isWall( board.stepTowards<MOVE_UP>( cell ) ) ? 0 : OPEN_UP;
+	sides |= board.isWall( board.stepTowards<MOVE_DOWN>( cell ) ) ? 0 : OPEN_DOWN;
+	sides |= board.isWall( board.stepTowards<MOVE_LEFT>( cell ) ) ? 0 : OPEN_LEFT;
+	sides |= board.isWall( board.stepTowards<MOVE_RIGHT>( cell ) ) ? 0 : OPEN_RIGHT;
+	return sides;
+}
+
+//Gives an auto tiled wall the sprite its sides call for, recording it if that changed anything
+static void retile( Board& board, int cell, int changed[], int& changedCount )
+{
+	if( cell < 0 || !isAutoTile( board.getTileType( cell ) ) )
+	{
+		return;
+	}
+
+	int tileType = EDGE_TILES[ openSides( board, cell ) ];
+	if( tileType != board.getTileType( cell ) )
+	{
+		board.setTileType( cell, tileType );
+		changed[ changedCount++ ] = cell;
+	}
+}
+
+int paintTile( Board& board, int cell, bool wall, int changed[], bool edges )
+{
+	int changedCount = 0;
+	if( cell < 0 || cell >= board.getCellCount() )
+	{
+		return changedCount;
+	}
+
+	//Without edge sprites only the painted cell changes, and walls already there stay as they were drawn
+	if( !edges )
+	{
+		if( wall != board.isWall( cell ) )
+		{
+			board.setTileType( cell, wall ? TILE_RED : TILE_GREEN );
+			changed[ changedCount++ ] = cell;
+		}
+		return changedCount;
+	}
+
+	//Nothing around it changes unless it goes between wall and floor
+	bool wasWall = board.isWall( cell );
+	if( wall && !isAutoTile( board.getTileType( cell ) ) )
+	{
+		//Any auto tiled wall will do here, retile picks the sprite
+		board.setTileType( cell, TILE_CENTER );
+		retile( board, cell, changed, changedCount );
+		if( changedCount == 0 )
+		{
+			changed[ changedCount++ ] = cell;
+		}
+	}
+	else if( !wall && wasWall )
+	{
+		board.setTileType( cell, TILE_GREEN );
+		changed[ changedCount++ ] = cell;
+	}
+
+	if( wasWall == wall )
+	{
+		return changedCount;
+	}
+
+	//Only the sides of the cells next to it can have changed
+	retile( board, board.stepTowards<MOVE_UP>( cell ), changed, changedCount );
+	retile( board, board.stepTowards<MOVE_DOWN>( cell ), changed, changedCount );
+	retile( board, board.stepTowards<MOVE_LEFT>( cell ), changed, changedCount );
+	retile( board, board.stepTowards<MOVE_RIGHT>( cell ), changed, changedCount );
+	return changedCount;
+}
+
+int autoTileBoard( Board& board )
+{
+	int changedCount = 0;
+	for( int i = 0; i < board.getCellCount(); ++i )
+	{
+		if( isAutoTile( board.getTileType( i ) ) )
+		{
+			int tileType = EDGE_TILES[ openSides( board, i ) ];
+			if( tileType != board.getTileType( i ) )
+			{
+				board.setTileType( i, tileType );
+				++changedCount;
+			}
+		}
+	}
+
+	return changedCount;
+}
@@ -0,0 +1,57 @@
+#ifndef AUTO_TILE_H
+#define AUTO_TILE_H
+
+#include "board.h"
+
+//The sides of a wall cell that face floor, off the board counts as wall
+const int OPEN_UP = 1;
+const int OPEN_DOWN = 2;
+const int OPEN_LEFT = 4;
+const int OPEN_RIGHT = 8;
+
+//Whether the tile sheet draws the edge sprites, tiles.png only has art for red, green, blue and top left
+//Without them painted walls are plain red like the shipped map's and the walls around them are left as placed
+const bool TILE_SHEET_HAS_EDGES = false;
+
+//The edge sprite a wall takes on a sheet that has them, indexed by its open sides
+//There's no sprite for walls one cell thin, so those and lone walls take the plain red wall
+constexpr int EDGE_TILES[ 16 ] =
+{
+	TILE_CENTER,		//No side open
+	TILE_TOP,			//Up
+	TILE_BOTTOM,		//Down
+	TILE_RED,			//Up and down
+	TILE_LEFT,			//Left
+	TILE_TOPLEFT,		//Up and left
+	TILE_BOTTOMLEFT,	//Down and left
+	TILE_RED,			//Up, down and left
+	TILE_RIGHT,			//Right
+	TILE_TOPRIGHT,		//Up and right
+	TILE_BOTTOMRIGHT,	//Down and right
+	TILE_RED,			//Up, down and right
+	TILE_RED,			//Left and right
+	TILE_RED,			//Up, left and right
+	TILE_RED,			//Down, left and right
+	TILE_RED			//Every side
+};
+
+//The most cells one paint can change, the painted cell and its edge neighbours
+const int MAX_PAINTED_CELLS = 5;
+
+//Checks whether a tile type is a wall the auto tiler picks sprites for, blue walls are left as placed
+constexpr bool isAutoTile( int tileType )
+{
+	return isWallTile( tileType ) && tileType != TILE_BLUE;
+}
+
+//Gets the open sides of a cell
+int openSides( const Board& board, int cell );
+
+//Paints a cell as wall or floor, with edges it picks new sprites for it and the walls beside it
+//Writes the cells whose type changed to changed, which needs room for MAX_PAINTED_CELLS, and returns how many there are
+int paintTile( Board& board, int cell, bool wall, int changed[], bool edges = TILE_SHEET_HAS_EDGES );
+
+//Picks the edge sprite of every auto tiled wall on the board, returns how many changed
+int autoTileBoard( Board& board );
+
+#endif
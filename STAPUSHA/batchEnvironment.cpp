@@ -0,0 +1,197 @@
+#include "batchEnvironment.h"
+#include "parallel.h"
+
+//Using memory copies
+#include <string.h>
+
+//How many games one parallelFor index steps, enough to keep scheduling cheap
+const int BATCH_CHUNK = 256;
+
+BatchEnvironment::BatchEnvironment( const Board& board, const LevelInfo levels[], int levelCount, int instanceCount, int maxSteps )
+{
+	//Initialize
+	mBoard = &board;
+	mLevelCount = levelCount;
+	mMaxSteps = maxSteps;
+	mCellCount = board.getCellCount();
+	mInstanceCount = instanceCount;
+
+	//Draw every level's fixed cells once
+	mStarts.resize( levelCount );
+	mGoals.resize( levelCount * MAX_STARS );
+	mGoalCounts.resize( levelCount );
+	mBaseObservations.assign( levelCount * mCellCount, 0 );
+	for( int level = 0; level < levelCount; ++level )
+	{
+		BoardState& start = mStarts[ level ];
+		start.player = board.cellFromEntity( levels[ level ].dot.x, levels[ level ].dot.y );
+		start.starCount = levelStarCells( board, levels[ level ], start.stars );
+		sortStars( start );
+		mGoalCounts[ level ] = levelGoalCells( board, levels[ level ], &mGoals[ level * MAX_STARS ] );
+
+		unsigned char* base = &mBaseObservations[ level * mCellCount ];
+		for( int cell = 0; cell < mCellCount; ++cell )
+		{
+			base[ cell ] = board.isWall( cell ) ? OBSERVE_WALL : 0;
+		}
+
+		for( int i = 0; i < mGoalCounts[ level ]; ++i )
+		{
+			base[ mGoals[ level * MAX_STARS + i ] ] |= OBSERVE_GOAL;
+		}
+	}
+
+	mStates.resize( instanceCount );
+	mLevels.assign( instanceCount, 0 );
+	mSteps.assign( instanceCount, 0 );
+	mRewards.assign( instanceCount, 0.0f );
+	mDone.assign( instanceCount, 0 );
+	mObservations.resize( (size_t)instanceCount * mCellCount );
+
+	reset();
+}
+
+void BatchEnvironment::reset( const int levels[] )
+{
+	int chunks = ( mInstanceCount + BATCH_CHUNK - 1 ) / BATCH_CHUNK;
+	parallelFor( chunks, [ & ]( int chunk )
+	{
+		int end = ( chunk + 1 ) * BATCH_CHUNK < mInstanceCount ? ( chunk + 1 ) * BATCH_CHUNK : mInstanceCount;
+		for( int i = chunk * BATCH_CHUNK; i < end; ++i )
+		{
+			if( levels == NULL )
+			{
+				resetInstance( i, mLevels[ i ] );
+			}
+			else if( levels[ i ] >= 0 && levels[ i ] < mLevelCount )
+			{
+				resetInstance( i, levels[ i ] );
+			}
+		}
+	} );
+}
+
+void BatchEnvironment::step( const unsigned char actions[] )
+{
+	int chunks = ( mInstanceCount + BATCH_CHUNK - 1 ) / BATCH_CHUNK;
+	parallelFor( chunks, [ & ]( int chunk )
+	{
+		int end = ( chunk + 1 ) * BATCH_CHUNK < mInstanceCount ? ( chunk + 1 ) * BATCH_CHUNK : mInstanceCount;
+		for( int i = chunk * BATCH_CHUNK; i < end; ++i )
+		{
+			stepInstance( i, actions[ i ] );
+		}
+	} );
+}
+
+int BatchEnvironment::getInstanceCount() const
+{
+	return mInstanceCount;
+}
+
+int BatchEnvironment::getObservationSize() const
+{
+	return mCellCount;
+}
+
+const unsigned char* BatchEnvironment::getObservations() const
+{
+	return &mObservations[ 0 ];
+}
+
+const float* BatchEnvironment::getRewards() const
+{
+	return &mRewards[ 0 ];
+}
+
+const unsigned char* BatchEnvironment::getDone() const
+{
+	return &mDone[ 0 ];
+}
+
+const int* BatchEnvironment::getLevels() const
+{
+	return &mLevels[ 0 ];
+}
+
+const int* BatchEnvironment::getSteps() const
+{
+	return &mSteps[ 0 ];
+}
+
+const BoardState* BatchEnvironment::getStates() const
+{
+	return &mStates[ 0 ];
+}
+
+void BatchEnvironment::resetInstance( int instance, int level )
+{
+	const BoardState& start = mStarts[ level ];
+	mStates[ instance ] = start;
+	mLevels[ instance ] = level;
+	mSteps[ instance ] = 0;
+	mRewards[ instance ] = 0.0f;
+	mDone[ instance ] = 0;
+
+	unsigned char* observation = &mObservations[ (size_t)instance * mCellCount ];
+	memcpy( observation, &mBaseObservations[ level * mCellCount ], mCellCount );
+	observation[ start.player ] |= OBSERVE_DOT;
+	for( int i = 0; i < start.starCount; ++i )
+	{
+		observation[ start.stars[ i ] ] |= OBSERVE_STAR;
+	}
+}
+
+void BatchEnvironment::stepInstance( int instance, int action )
+{
+	if( mDone[ instance ] )
+	{
+		mRewards[ instance ] = 0.0f;
+		return;
+	}
+
+	BoardState& state = mStates[ instance ];
+	unsigned char* observation = &mObservations[ (size_t)instance * mCellCount ];
+	float reward = REWARD_STEP;
+
+	//Blocked moves and unknown codes just spend the step
+	int from = state.player;
+	bool pushed = false;
+	if( action >= MOVE_UP && action <= MOVE_RIGHT && mBoard->applyMove( state, action, &pushed ) )
+	{
+		observation[ from ] &= ~OBSERVE_DOT;
+		observation[ state.player ] |= OBSERVE_DOT;
+
+		//Only the pushed star's two cells change
+		if( pushed )
+		{
+			int to = mBoard->step( state.player, action );
+			observation[ state.player ] &= ~OBSERVE_STAR;
+			observation[ to ] |= OBSERVE_STAR;
+
+			if( observation[ state.player ] & OBSERVE_GOAL )
+			{
+				reward -= REWARD_STAR_ON_GOAL;
+			}
+
+			if( observation[ to ] & OBSERVE_GOAL )
+			{
+				reward += REWARD_STAR_ON_GOAL;
+			}
+		}
+	}
+
+	int level = mLevels[ instance ];
+	++mSteps[ instance ];
+	if( pushed && isSolved( state, &mGoals[ level * MAX_STARS ], mGoalCounts[ level ] ) )
+	{
+		reward += REWARD_SOLVED;
+		mDone[ instance ] = 1;
+	}
+	else if( mSteps[ instance ] >= mMaxSteps )
+	{
+		mDone[ instance ] = 1;
+	}
+
+	mRewards[ instance ] = reward;
+}
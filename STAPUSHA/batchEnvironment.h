@@ -0,0 +1,79 @@
+#ifndef BATCH_ENVIRONMENT_H
+#define BATCH_ENVIRONMENT_H
+
+#include "board.h"
+#include "levels.h"
+
+//Using vectors
+#include <vector>
+
+//What each observation cell holds, walls and goals never change during an episode
+const unsigned char OBSERVE_WALL = 1;
+const unsigned char OBSERVE_GOAL = 2;
+const unsigned char OBSERVE_STAR = 4;
+const unsigned char OBSERVE_DOT = 8;
+
+//The rewards a step can earn
+const float REWARD_STEP = -0.01f;
+const float REWARD_STAR_ON_GOAL = 1.0f;
+const float REWARD_SOLVED = 10.0f;
+
+//Many independent games stepped in lockstep, for bots to train and be evaluated on
+class BatchEnvironment
+{
+	public:
+		//Creates instanceCount games on the shipped levels, each ending after maxSteps moves
+		BatchEnvironment( const Board& board, const LevelInfo levels[], int levelCount, int instanceCount, int maxSteps );
+
+		//Restarts games on new levels, levels[ i ] < 0 leaves game i alone, NULL restarts every game on its current level
+		void reset( const int levels[] = NULL );
+
+		//Plays one move code per game, finished games stand still until they're reset
+		void step( const unsigned char actions[] );
+
+		//Gets the number of games and cells in each observation
+		int getInstanceCount() const;
+		int getObservationSize() const;
+
+		//Gets the observation grids, one getObservationSize() block per game, valid until the next step or reset
+		const unsigned char* getObservations() const;
+
+		//Gets the last step's rewards and which games are finished
+		const float* getRewards() const;
+		const unsigned char* getDone() const;
+
+		//Gets each game's level, moves played and full state
+		const int* getLevels() const;
+		const int* getSteps() const;
+		const BoardState* getStates() const;
+
+	private:
+		//Restarts one game
+		void resetInstance( int instance, int level );
+
+		//Plays one move in one game
+		void stepInstance( int instance, int action );
+
+		//The shared level data
+		const Board* mBoard;
+		int mLevelCount;
+		int mMaxSteps;
+		int mCellCount;
+
+		//Each level's start, goals and observation with walls and goals drawn in
+		std::vector<BoardState> mStarts;
+		std::vector<int> mGoals;
+		std::vector<int> mGoalCounts;
+		std::vector<unsigned char> mBaseObservations;
+
+		//Per game data, each kept contiguous across games
+		int mInstanceCount;
+		std::vector<BoardState> mStates;
+		std::vector<int> mLevels;
+		std::vector<int> mSteps;
+		std::vector<float> mRewards;
+		std::vector<unsigned char> mDone;
+		std::vector<unsigned char> mObservations;
+};
+
+#endif
@@ -0,0 +1,1139 @@
+/*Benchmarks for the headless game components.
+Run from the STAPUSHA directory so the tile map is found.*/
+
+//Using standard IO, strings, vectors, searching, atomics and timers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include "board.h"
+#include "levels.h"
+#include "heuristic.h"
+#include "patternDb.h"
+#include "pathFinder.h"
+#include "batchEnvironment.h"
+#include "parallel.h"
+#include "solver.h"
+#include "levelGenerator.h"
+#include "externalSolver.h"
+#include "macroMoves.h"
+#include "ghostReplay.h"
+#include "autoTile.h"
+
+//Gets seconds elapsed since a start time
+static double secondsSince( std::chrono::steady_clock::time_point start )
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+//Collects the floor cells reachable from a start cell
+static void floodFloor( const Board& board, int start, std::vector<int>& cells )
+{
+	std::vector<bool> seen( board.getCellCount(), false );
+	cells.clear();
+	cells.push_back( start );
+	seen[ start ] = true;
+
+	for( size_t i = 0; i < cells.size(); ++i )
+	{
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int next = board.step( cells[ i ], direction );
+			if( next >= 0 && !board.isWall( next ) && !seen[ next ] )
+			{
+				seen[ next ] = true;
+				cells.push_back( next );
+			}
+		}
+	}
+}
+
+//Compares full and incremental assignment heuristic evaluations
+static bool benchHeuristic( const Board& board )
+{
+	const int EVALUATIONS = 200000;
+	bool success = true;
+
+	printf( "Assignment heuristic, %d evaluations per level\n", EVALUATIONS );
+
+	for( int level = 0; level < TOTAL_LEVELS; ++level )
+	{
+		int stars[ MAX_STARS ], goals[ MAX_STARS ];
+		int starCount = levelStarCells( board, gLevels[ level ], stars );
+		int goalCount = levelGoalCells( board, gLevels[ level ], goals );
+
+		std::vector<int> floor;
+		floodFloor( board, board.cellFromEntity( gLevels[ level ].dot.x, gLevels[ level ].dot.y ), floor );
+
+		PushDistances distances;
+		distances.build( board, goals, goalCount );
+
+		//Pick the random star moves up front so both runs see the same walk
+		std::vector<int> moves( EVALUATIONS * 2 );
+		srand( 1234 + level );
+		for( int i = 0; i < EVALUATIONS; ++i )
+		{
+			moves[ i * 2 ] = rand() % starCount;
+			moves[ i * 2 + 1 ] = floor[ rand() % floor.size() ];
+		}
+
+		AssignmentHeuristic full( distances ), incremental( distances );
+		int fullStars[ MAX_STARS ];
+		memcpy( fullStars, stars, sizeof( stars ) );
+		incremental.reset( stars, starCount );
+
+		long long fullSum = 0, incrementalSum = 0;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for( int i = 0; i < EVALUATIONS; ++i )
+		{
+			fullStars[ moves[ i * 2 ] ] = moves[ i * 2 + 1 ];
+			fullSum += full.reset( fullStars, starCount );
+		}
+		double fullSeconds = secondsSince( start );
+
+		start = std::chrono::steady_clock::now();
+		for( int i = 0; i < EVALUATIONS; ++i )
+		{
+			incrementalSum += incremental.moveStar( moves[ i * 2 ], moves[ i * 2 + 1 ] );
+		}
+		double incrementalSeconds = secondsSince( start );
+
+		//Both must agree on every value
+		if( fullSum != incrementalSum || full.getValue() != incremental.getValue() )
+		{
+			printf( "  level %d: incremental matching disagrees with full matching!\n", level + 1 );
+			success = false;
+		}
+
+		printf( "  level %d: %d stars, start value %d, full %.0f evals/s, incremental %.0f evals/s\n",
+			level + 1, starCount, AssignmentHeuristic( distances ).reset( stars, starCount ),
+			EVALUATIONS / fullSeconds, EVALUATIONS / incrementalSeconds );
+	}
+
+	return success;
+}
+
+//The move rules as they were before applyMove was specialized per direction, kept to compare against
+static bool referenceMove( const Board& board, BoardState& state, int direction, bool* pushed )
+{
+	*pushed = false;
+
+	int next = board.step( state.player, direction );
+	if( next < 0 || board.isWall( next ) )
+	{
+		return false;
+	}
+
+	int star = findStar( state, next );
+	if( star >= 0 )
+	{
+		int beyond = board.step( next, direction );
+		if( beyond < 0 || board.isWall( beyond ) || findStar( state, beyond ) >= 0 )
+		{
+			return false;
+		}
+
+		while( star > 0 && state.stars[ star - 1 ] > beyond )
+		{
+			state.stars[ star ] = state.stars[ star - 1 ];
+			--star;
+		}
+		while( star + 1 < state.starCount && state.stars[ star + 1 ] < beyond )
+		{
+			state.stars[ star ] = state.stars[ star + 1 ];
+			++star;
+		}
+		state.stars[ star ] = beyond;
+		*pushed = true;
+	}
+
+	state.player = next;
+	return true;
+}
+
+//Plays the same random walks through the runtime and the direction-specialized move rules
+static bool benchMoves( const Board& board )
+{
+	const int MOVES = 2000000;
+	bool success = true;
+
+	printf( "Move rules, %d random moves per level\n", MOVES );
+
+	for( int level = 0; level < TOTAL_LEVELS; ++level )
+	{
+		BoardState start;
+		start.player = board.cellFromEntity( gLevels[ level ].dot.x, gLevels[ level ].dot.y );
+		start.starCount = levelStarCells( board, gLevels[ level ], start.stars );
+		sortStars( start );
+
+		std::vector<unsigned char> moves( MOVES );
+		srand( 4321 + level );
+		for( int i = 0; i < MOVES; ++i )
+		{
+			moves[ i ] = (unsigned char)( MOVE_UP + rand() % 4 );
+		}
+
+		//Count what happened so both runs can be checked against each other
+		BoardState reference = start;
+		long long referenceCount = 0;
+		bool pushed = false;
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		for( int i = 0; i < MOVES; ++i )
+		{
+			referenceCount += referenceMove( board, reference, moves[ i ], &pushed ) + pushed * 2;
+		}
+		double referenceSeconds = secondsSince( begin );
+
+		BoardState specialized = start;
+		long long specializedCount = 0;
+		begin = std::chrono::steady_clock::now();
+		for( int i = 0; i < MOVES; ++i )
+		{
+			specializedCount += board.applyMove( specialized, moves[ i ], &pushed ) + pushed * 2;
+		}
+		double specializedSeconds = secondsSince( begin );
+
+		if( referenceCount != specializedCount || reference.player != specialized.player ||
+			memcmp( reference.stars, specialized.stars, sizeof( int ) * reference.starCount ) != 0 )
+		{
+			printf( "  level %d: specialized moves disagree with the runtime rules!\n", level + 1 );
+			success = false;
+		}
+
+		printf( "  level %d: runtime %.1f M moves/s, specialized %.1f M moves/s\n", level + 1,
+			MOVES / referenceSeconds / 1e6, MOVES / specializedSeconds / 1e6 );
+	}
+
+	return success;
+}
+
+//Builds, maps and queries the pattern database
+static bool benchPatternDb( const Board& board )
+{
+	const int LOOKUPS = 1000000;
+	const char* path = "benchmark.pdb";
+	bool success = true;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if( !buildPatternDatabase( board, gLevels, TOTAL_LEVELS, path ) )
+	{
+		return false;
+	}
+	double buildSeconds = secondsSince( start );
+
+	PatternDatabase database;
+	start = std::chrono::steady_clock::now();
+	if( !database.open( path, board, gLevels, TOTAL_LEVELS ) )
+	{
+		remove( path );
+		return false;
+	}
+	double openSeconds = secondsSince( start );
+
+	printf( "Pattern database, built in %.1f ms, mapped in %.3f ms\n", buildSeconds * 1000.0, openSeconds * 1000.0 );
+
+	for( int level = 0; level < TOTAL_LEVELS; ++level )
+	{
+		int stars[ MAX_STARS ], goals[ MAX_STARS ];
+		int starCount = levelStarCells( board, gLevels[ level ], stars );
+		int goalCount = levelGoalCells( board, gLevels[ level ], goals );
+
+		std::vector<int> floor;
+		floodFloor( board, board.cellFromEntity( gLevels[ level ].dot.x, gLevels[ level ].dot.y ), floor );
+
+		PushDistances distances;
+		distances.build( board, goals, goalCount );
+
+		//Exact single star costs can never be below the relaxed push distance
+		for( size_t i = 0; i < floor.size(); ++i )
+		{
+			int relaxed = PUSH_UNREACHABLE;
+			for( int goal = 0; goal < goalCount; ++goal )
+			{
+				relaxed = distances.distance( goal, floor[ i ] ) < relaxed ? distances.distance( goal, floor[ i ] ) : relaxed;
+			}
+
+			int exact = database.singleCost( level, floor[ i ] );
+			if( exact != PATTERN_DEAD && ( relaxed == PUSH_UNREACHABLE || exact < relaxed ) )
+			{
+				printf( "  level %d: single cost %d below push distance %d!\n", level + 1, exact, relaxed );
+				success = false;
+			}
+		}
+
+		//Time lower bounds over random star placements
+		std::vector<int> placements( LOOKUPS * 2 );
+		srand( 4321 + level );
+		for( size_t i = 0; i < placements.size(); ++i )
+		{
+			placements[ i ] = floor[ rand() % floor.size() ];
+		}
+
+		long long sum = 0;
+		start = std::chrono::steady_clock::now();
+		for( int i = 0; i < LOOKUPS; ++i )
+		{
+			sum += database.pairCost( level, placements[ i * 2 ], placements[ i * 2 + 1 ] );
+		}
+		double seconds = secondsSince( start );
+
+		printf( "  level %d: start bound %d (assignment %d), %.0f pair lookups/s (checksum %lld)\n",
+			level + 1, database.lowerBound( level, stars, starCount ), AssignmentHeuristic( distances ).reset( stars, starCount ),
+			LOOKUPS / seconds, sum );
+	}
+
+	database.close();
+	remove( path );
+	return success;
+}
+
+//Replays planned moves, checking the dot isn't blocked and only pushes where allowed
+static bool replayPlan( const Board& board, BoardState state, const std::vector<int>& moves, bool allowPushes, BoardState& end )
+{
+	for( size_t i = 0; i < moves.size(); ++i )
+	{
+		bool pushed = false;
+		if( !board.applyMove( state, moves[ i ], &pushed ) || ( pushed && !allowPushes ) )
+		{
+			return false;
+		}
+	}
+
+	end = state;
+	return true;
+}
+
+//Times click-to-move walk and push queries, cold and from the distance map cache
+static bool benchPathFinding( const Board& board )
+{
+	const int QUERIES = 2000;
+	bool success = true;
+
+	printf( "Path finding, %d queries per level\n", QUERIES );
+
+	for( int level = 0; level < TOTAL_LEVELS; ++level )
+	{
+		BoardState state;
+		state.player = board.cellFromEntity( gLevels[ level ].dot.x, gLevels[ level ].dot.y );
+		state.starCount = levelStarCells( board, gLevels[ level ], state.stars );
+		sortStars( state );
+
+		std::vector<int> floor;
+		floodFloor( board, state.player, floor );
+
+		std::vector<int> targets( QUERIES );
+		srand( 8765 + level );
+		for( int i = 0; i < QUERIES; ++i )
+		{
+			targets[ i ] = floor[ rand() % floor.size() ];
+		}
+
+		//Walks with the cache dropped before each one, then with it kept
+		PathFinder finder( board );
+		std::vector<int> moves;
+		BoardState end;
+		int walks = 0;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for( int i = 0; i < QUERIES; ++i )
+		{
+			finder.invalidate();
+			walks += finder.findWalk( state, targets[ i ], moves ) ? 1 : 0;
+		}
+		double coldSeconds = secondsSince( start );
+
+		start = std::chrono::steady_clock::now();
+		for( int i = 0; i < QUERIES; ++i )
+		{
+			if( finder.findWalk( state, targets[ i ], moves ) && ( !replayPlan( board, state, moves, false, end ) || end.player != targets[ i ] ) )
+			{
+				printf( "  level %d: walk to %d doesn't get there!\n", level + 1, targets[ i ] );
+				success = false;
+			}
+		}
+		double warmSeconds = secondsSince( start );
+
+		//Push the first star to every target it can reach
+		int pushes = 0;
+		start = std::chrono::steady_clock::now();
+		for( int i = 0; i < QUERIES; ++i )
+		{
+			if( finder.findPush( state, state.stars[ 0 ], targets[ i ], moves ) )
+			{
+				++pushes;
+				if( !replayPlan( board, state, moves, true, end ) || findStar( end, targets[ i ] ) < 0 )
+				{
+					printf( "  level %d: push to %d doesn't get there!\n", level + 1, targets[ i ] );
+					success = false;
+				}
+			}
+		}
+		double pushSeconds = secondsSince( start );
+
+		printf( "  level %d: %d walkable, %.2f us cold, %.2f us cached (with replay), %d pushable at %.2f us\n", level + 1, walks,
+			coldSeconds * 1e6 / QUERIES, warmSeconds * 1e6 / QUERIES, pushes, pushSeconds * 1e6 / QUERIES );
+	}
+
+	//An open 316 x 316 map with scattered walls, few enough targets that their maps all fit the cache
+	const int SIDE = 316;
+	const int LARGE_QUERIES = 32;
+	std::vector<int> types( SIDE * SIDE, TILE_GREEN );
+	srand( 97 );
+	for( int i = 0; i < SIDE * SIDE; ++i )
+	{
+		if( i < SIDE || i % SIDE == 0 || rand() % 8 == 0 )
+		{
+			types[ i ] = TILE_RED;
+		}
+	}
+
+	Board large;
+	large.loadFromTypes( &types[ 0 ], SIDE, SIDE );
+
+	BoardState state;
+	state.player = SIDE + 1;
+	state.starCount = 0;
+	types[ state.player ] = TILE_GREEN;
+	large.setTileType( state.player, TILE_GREEN );
+
+	std::vector<int> floor;
+	floodFloor( large, state.player, floor );
+
+	PathFinder finder( large );
+	std::vector<int> moves;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for( int i = 0; i < LARGE_QUERIES; ++i )
+	{
+		finder.invalidate();
+		finder.findWalk( state, floor[ floor.size() - 1 - i ], moves );
+	}
+	double coldSeconds = secondsSince( start );
+
+	for( int i = 0; i < LARGE_QUERIES; ++i )
+	{
+		finder.findWalk( state, floor[ floor.size() - 1 - i ], moves );
+	}
+
+	start = std::chrono::steady_clock::now();
+	for( int i = 0; i < LARGE_QUERIES; ++i )
+	{
+		finder.findWalk( state, floor[ floor.size() - 1 - i ], moves );
+	}
+	double warmSeconds = secondsSince( start );
+
+	printf( "  %d x %d map: %d floor cells, %.1f us cold, %.1f us cached\n", SIDE, SIDE, (int)floor.size(), coldSeconds * 1e6 / LARGE_QUERIES, warmSeconds * 1e6 / LARGE_QUERIES );
+	return success;
+}
+
+//Times random play across a batch of games with more and more worker threads
+static bool benchBatch( const Board& board )
+{
+	const int INSTANCES = 4096;
+	const int MAX_STEPS = 200;
+	const int STEPS = 500;
+
+	BatchEnvironment environment( board, gLevels, TOTAL_LEVELS, INSTANCES, MAX_STEPS );
+	std::vector<int> levels( INSTANCES );
+	std::vector<unsigned char> actions( INSTANCES );
+
+	printf( "Batch environment, %d games, %d steps each run\n", INSTANCES, STEPS );
+
+	bool success = true;
+	int firstEpisodes = -1;
+	double firstReward = 0.0;
+	for( int threads = 1; ; threads *= 2 )
+	{
+		if( threads > workerCount() )
+		{
+			threads = workerCount();
+		}
+
+		setWorkerLimit( threads );
+		for( int i = 0; i < INSTANCES; ++i )
+		{
+			levels[ i ] = i % TOTAL_LEVELS;
+		}
+		environment.reset( &levels[ 0 ] );
+
+		//Same moves for every thread count so the totals must agree
+		unsigned int seed = 12345;
+		int episodes = 0;
+		int solved = 0;
+		double totalReward = 0.0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for( int step = 0; step < STEPS; ++step )
+		{
+			for( int i = 0; i < INSTANCES; ++i )
+			{
+				seed = seed * 1664525u + 1013904223u;
+				actions[ i ] = (unsigned char)( MOVE_UP + ( seed >> 24 ) % 4 );
+			}
+
+			environment.step( &actions[ 0 ] );
+
+			//Finished games start over on the same level
+			const unsigned char* done = environment.getDone();
+			const float* rewards = environment.getRewards();
+			for( int i = 0; i < INSTANCES; ++i )
+			{
+				totalReward += rewards[ i ];
+				levels[ i ] = -1;
+				if( done[ i ] )
+				{
+					++episodes;
+					solved += rewards[ i ] >= REWARD_SOLVED / 2;
+					levels[ i ] = environment.getLevels()[ i ];
+				}
+			}
+			environment.reset( &levels[ 0 ] );
+		}
+		double seconds = secondsSince( start );
+
+		printf( "  %2d threads: %.2f M steps/s, %d episodes, %d solved, reward %.1f\n", threads,
+			(double)INSTANCES * STEPS / seconds / 1e6, episodes, solved, totalReward );
+
+		if( firstEpisodes < 0 )
+		{
+			firstEpisodes = episodes;
+			firstReward = totalReward;
+		}
+		else if( episodes != firstEpisodes || totalReward != firstReward )
+		{
+			printf( "  Results changed with the thread count!\n" );
+			success = false;
+		}
+
+		if( threads == workerCount() )
+		{
+			break;
+		}
+	}
+
+	setWorkerLimit( 0 );
+	return success;
+}
+
+//Solves one level forward and bidirectionally, checking both find equally short solutions
+static bool compareSearches( const Board& board, const BoardState& start, const int goals[], int goalCount, const char* name, long long totals[ 2 ] )
+{
+	int lengths[ 2 ], expanded[ 2 ];
+	double seconds[ 2 ];
+	bool success = true;
+
+	for( int mode = 0; mode < 2; ++mode )
+	{
+		Solver solver( board, goals, goalCount );
+		solver.setBidirectional( mode == 1 );
+
+		std::vector<int> moves;
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		bool solved = solver.solve( start, moves );
+		seconds[ mode ] = secondsSince( begin );
+		expanded[ mode ] = solver.getExpandedNodes();
+		lengths[ mode ] = solved ? (int)moves.size() : -1;
+		totals[ mode ] += expanded[ mode ];
+
+		//The answer has to play out by the game rules
+		BoardState state = start;
+		for( size_t i = 0; i < moves.size(); ++i )
+		{
+			solved = solved && board.applyMove( state, moves[ i ] );
+		}
+		if( !solved || !isSolved( state, goals, goalCount ) )
+		{
+			printf( "  %s: %s search found no valid solution!\n", name, mode == 0 ? "forward" : "bidirectional" );
+			success = false;
+		}
+	}
+
+	printf( "  %s: %d moves, forward %d nodes in %.1f ms, bidirectional %d nodes in %.1f ms (%.2fx)\n", name, lengths[ 0 ],
+		expanded[ 0 ], seconds[ 0 ] * 1000.0, expanded[ 1 ], seconds[ 1 ] * 1000.0, expanded[ 1 ] > 0 ? (double)expanded[ 0 ] / expanded[ 1 ] : 0.0 );
+
+	if( lengths[ 0 ] != lengths[ 1 ] )
+	{
+		printf( "  %s: bidirectional search found %d moves instead of %d!\n", name, lengths[ 1 ], lengths[ 0 ] );
+		success = false;
+	}
+
+	return success;
+}
+
+static bool benchBidirectional( const Board& board )
+{
+	const int GENERATED_LEVELS = 8;
+
+	printf( "Bidirectional search, nodes expanded against forward search\n" );
+
+	bool success = true;
+	long long shippedTotals[ 2 ] = { 0, 0 };
+	for( int level = 0; level < TOTAL_LEVELS; ++level )
+	{
+		BoardState start;
+		int goals[ MAX_STARS ];
+		start.player = board.cellFromEntity( gLevels[ level ].dot.x, gLevels[ level ].dot.y );
+		start.starCount = levelStarCells( board, gLevels[ level ], start.stars );
+		sortStars( start );
+		int goalCount = levelGoalCells( board, gLevels[ level ], goals );
+
+		char name[ 32 ];
+		snprintf( name, sizeof( name ), "level %d", level + 1 );
+		success = compareSearches( board, start, goals, goalCount, name, shippedTotals ) && success;
+	}
+
+	//Generated levels long enough for the search to matter
+	GeneratorSettings settings;
+	settings.minMoves = 25;
+	long long generatedTotals[ 2 ] = { 0, 0 };
+	int generated = 0;
+	for( unsigned int seed = 1; generated < GENERATED_LEVELS && seed < 5000; ++seed )
+	{
+		PackLevel level;
+		if( generateLevel( settings, seed, level ) != GENERATED )
+		{
+			continue;
+		}
+
+		Board generatedBoard;
+		packLevelBoard( level, generatedBoard );
+
+		char name[ 32 ];
+		snprintf( name, sizeof( name ), "seed %u", seed );
+		success = compareSearches( generatedBoard, level.start, level.goals, level.goalCount, name, generatedTotals ) && success;
+		++generated;
+	}
+
+	printf( "  shipped: %lld -> %lld nodes, generated: %lld -> %lld nodes\n", shippedTotals[ 0 ], shippedTotals[ 1 ], generatedTotals[ 0 ], generatedTotals[ 1 ] );
+	return success;
+}
+
+//Solves the shipped levels with and without tunnel and goal room macros
+static bool benchMacros( const Board& board )
+{
+	printf( "Macro moves, forward search with and without them\n" );
+
+	bool success = true;
+	long long totals[ 2 ] = { 0, 0 };
+	double totalSeconds[ 2 ] = { 0.0, 0.0 };
+	for( int level = 0; level < TOTAL_LEVELS; ++level )
+	{
+		BoardState start;
+		int goals[ MAX_STARS ];
+		start.player = board.cellFromEntity( gLevels[ level ].dot.x, gLevels[ level ].dot.y );
+		start.starCount = levelStarCells( board, gLevels[ level ], start.stars );
+		sortStars( start );
+		int goalCount = levelGoalCells( board, gLevels[ level ], goals );
+
+		MacroMoves macros;
+		macros.build( board, start, goals, goalCount );
+
+		int lengths[ 2 ], expanded[ 2 ];
+		double seconds[ 2 ];
+		for( int mode = 0; mode < 2; ++mode )
+		{
+			Solver solver( board, goals, goalCount );
+			solver.setMacroMoves( mode == 1 );
+
+			std::vector<int> moves;
+			std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+			bool solved = solver.solve( start, moves );
+			seconds[ mode ] = secondsSince( begin );
+			lengths[ mode ] = (int)moves.size();
+			expanded[ mode ] = solver.getExpandedNodes();
+			totals[ mode ] += expanded[ mode ];
+			totalSeconds[ mode ] += seconds[ mode ];
+
+			//The macro moves have to replay into a solved level like any other solution
+			BoardState state = start;
+			for( size_t i = 0; i < moves.size() && solved; ++i )
+			{
+				solved = board.applyMove( state, moves[ i ] );
+			}
+			if( !solved || !isSolved( state, goals, goalCount ) )
+			{
+				printf( "  level %d: %s search found no valid solution!\n", level + 1, mode == 0 ? "plain" : "macro" );
+				success = false;
+			}
+		}
+
+		printf( "  level %d: %d tunnel cells, %d goal rooms, %d -> %d nodes, %.2f -> %.2f ms, %d -> %d moves\n", level + 1,
+			macros.getTunnelCells(), macros.getGoalRooms(), expanded[ 0 ], expanded[ 1 ], seconds[ 0 ] * 1000.0, seconds[ 1 ] * 1000.0,
+			lengths[ 0 ], lengths[ 1 ] );
+	}
+
+	printf( "  total: %lld -> %lld nodes, %.2f -> %.2f ms\n", totals[ 0 ], totals[ 1 ], totalSeconds[ 0 ] * 1000.0, totalSeconds[ 1 ] * 1000.0 );
+	return success;
+}
+
+//Solves level 2 breadth first from disk under shrinking memory budgets, checking the length against A*
+static bool benchStateStore( const Board& board )
+{
+	//Level 2 has the biggest search of the shipped levels
+	const int LEVEL = 1;
+	const size_t BUDGETS[] = { DEFAULT_STORE_BUDGET, 1 << 20, 64 << 10 };
+	const char* path = "benchmark.states";
+
+	BoardState start;
+	int goals[ MAX_STARS ];
+	start.player = board.cellFromEntity( gLevels[ LEVEL ].dot.x, gLevels[ LEVEL ].dot.y );
+	start.starCount = levelStarCells( board, gLevels[ LEVEL ], start.stars );
+	sortStars( start );
+	int goalCount = levelGoalCells( board, gLevels[ LEVEL ], goals );
+
+	Solver solver( board, goals, goalCount );
+	std::vector<int> expected;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	solver.solve( start, expected );
+	double seconds = secondsSince( begin );
+
+	printf( "State store, level %d breadth first against in-memory A* (%d moves, %d nodes in %.1f ms)\n", LEVEL + 1,
+		(int)expected.size(), solver.getExpandedNodes(), seconds * 1000.0 );
+
+	bool success = true;
+	for( size_t i = 0; i < sizeof( BUDGETS ) / sizeof( BUDGETS[ 0 ] ); ++i )
+	{
+		ExternalSolver external( board, goals, goalCount );
+		external.setMemoryBudget( BUDGETS[ i ] );
+		external.setWorkPath( path );
+
+		std::vector<int> moves;
+		begin = std::chrono::steady_clock::now();
+		bool solved = external.solve( start, moves );
+		seconds = secondsSince( begin );
+
+		printf( "  %6d KB budget: %lld states in %.2f s, %.0f states/s, %.1f bytes a state (%d raw), %d runs spilled, %.1f MB\n",
+			(int)( BUDGETS[ i ] >> 10 ), external.getExpandedNodes(), seconds, external.getExpandedNodes() / seconds,
+			external.getPackedStateSize(), (int)sizeof( BoardState ), external.getSpilledRuns(), external.getSpilledBytes() / 1048576.0 );
+
+		if( !solved || moves.size() != expected.size() )
+		{
+			printf( "  Breadth first search found %d moves instead of %d!\n", solved ? (int)moves.size() : -1, (int)expected.size() );
+			success = false;
+		}
+	}
+
+	return success;
+}
+
+//Measures the job system on tiny jobs, dependency chains, continuations and parallelFor, then prints how busy each thread was
+static bool benchJobs( const Board& board )
+{
+	const int TINY_JOBS = 100000;
+	const int CHAIN_LENGTH = 10000;
+	const int FAN_IN = 1000;
+	const int OUTER_LOOPS = 8;
+
+	printf( "Job system, %d threads\n", workerCount() );
+
+	bool success = true;
+	resetWorkerStats();
+
+	//Jobs doing next to nothing, so the time is all queueing and stealing
+	std::atomic<long long> sum( 0 );
+	std::vector<JobHandle> jobs;
+	jobs.reserve( TINY_JOBS );
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for( int i = 0; i < TINY_JOBS; ++i )
+	{
+		jobs.push_back( submitJob( [ &sum, i ]()
+		{
+			sum += i;
+		} ) );
+	}
+	for( int i = 0; i < TINY_JOBS; ++i )
+	{
+		waitForJob( jobs[ i ] );
+	}
+	double seconds = secondsSince( start );
+	printf( "  Tiny jobs: %.2f M jobs/s\n", TINY_JOBS / seconds / 1e6 );
+	if( sum != (long long)TINY_JOBS * ( TINY_JOBS - 1 ) / 2 )
+	{
+		printf( "  Tiny jobs lost work!\n" );
+		success = false;
+	}
+
+	//Each link waits on the one before, so they must run in order
+	std::vector<int> order;
+	order.reserve( CHAIN_LENGTH );
+	start = std::chrono::steady_clock::now();
+	JobHandle link = submitJob( [ &order ]()
+	{
+		order.push_back( 0 );
+	} );
+	for( int i = 1; i < CHAIN_LENGTH; ++i )
+	{
+		link = continueWith( link, [ &order, i ]()
+		{
+			order.push_back( i );
+		} );
+	}
+	waitForJob( link );
+	seconds = secondsSince( start );
+	printf( "  Dependency chain: %.2f M links/s\n", CHAIN_LENGTH / seconds / 1e6 );
+	for( int i = 0; i < CHAIN_LENGTH; ++i )
+	{
+		if( i >= (int)order.size() || order[ i ] != i )
+		{
+			printf( "  Chain ran out of order!\n" );
+			success = false;
+			break;
+		}
+	}
+
+	//One job waiting on many
+	sum = 0;
+	jobs.clear();
+	start = std::chrono::steady_clock::now();
+	for( int i = 0; i < FAN_IN; ++i )
+	{
+		jobs.push_back( submitJob( [ &sum ]()
+		{
+			++sum;
+		} ) );
+	}
+	long long seen = -1;
+	waitForJob( submitJob( [ &sum, &seen ]()
+	{
+		seen = sum;
+	}, jobs ) );
+	seconds = secondsSince( start );
+	printf( "  Fan in: %d jobs and their continuation in %.2f ms\n", FAN_IN, seconds * 1000.0 );
+	if( seen != FAN_IN )
+	{
+		printf( "  Continuation ran before its dependencies!\n" );
+		success = false;
+	}
+
+	//A flood from every floor cell, nested so waiting threads have to help with the inner loops
+	std::vector<int> floor;
+	floodFloor( board, board.cellFromEntity( gLevels[ 0 ].dot.x, gLevels[ 0 ].dot.y ), floor );
+	long long serial = 0;
+	std::vector<int> cells;
+	for( size_t i = 0; i < floor.size(); ++i )
+	{
+		floodFloor( board, floor[ i ], cells );
+		serial += cells.size() * ( i % 7 + 1 );
+	}
+
+	sum = 0;
+	start = std::chrono::steady_clock::now();
+	parallelFor( OUTER_LOOPS, [ & ]( int )
+	{
+		parallelFor( (int)floor.size(), [ & ]( int i )
+		{
+			std::vector<int> reached;
+			floodFloor( board, floor[ i ], reached );
+			sum += reached.size() * ( i % 7 + 1 );
+		} );
+	} );
+	seconds = secondsSince( start );
+	printf( "  Nested parallelFor: %.2f k floods/s\n", OUTER_LOOPS * floor.size() / seconds / 1e3 );
+	if( sum != serial * OUTER_LOOPS )
+	{
+		printf( "  Nested parallelFor results differ from serial!\n" );
+		success = false;
+	}
+
+	std::vector<WorkerStats> stats;
+	getWorkerStats( stats );
+	for( size_t i = 0; i < stats.size(); ++i )
+	{
+		double total = stats[ i ].busySeconds + stats[ i ].idleSeconds;
+		printf( "  %s %2d: %8lld jobs, %7lld stolen, busy %.3f s", i == 0 ? "outside" : "worker ", (int)i, stats[ i ].jobs, stats[ i ].steals, stats[ i ].busySeconds );
+		if( i > 0 && total > 0.0 )
+		{
+			printf( ", %.0f%% utilized", stats[ i ].busySeconds / total * 100.0 );
+		}
+		printf( "\n" );
+	}
+
+	return success;
+}
+
+//Races many recorded runs at once, timing the per frame work of playing their moves and gathering their sprites
+static bool benchGhosts( const Board& board )
+{
+	const int GHOSTS = 200;
+	printf( "Ghost replay, %d runs across the shipped levels\n", GHOSTS );
+
+	//Each level's solution, the ghosts play it straight or after wandering a while and starting over
+	std::vector<int> solutions[ TOTAL_LEVELS ];
+	for( int level = 0; level < TOTAL_LEVELS; ++level )
+	{
+		BoardState start;
+		int goals[ MAX_STARS ];
+		start.player = board.cellFromEntity( gLevels[ level ].dot.x, gLevels[ level ].dot.y );
+		start.starCount = levelStarCells( board, gLevels[ level ], start.stars );
+		sortStars( start );
+		int goalCount = levelGoalCells( board, gLevels[ level ], goals );
+
+		Solver solver( board, goals, goalCount );
+		if( !solver.solve( start, solutions[ level ] ) )
+		{
+			printf( "  level %d: no solution to race!\n", level + 1 );
+			return false;
+		}
+	}
+
+	GhostReplay ghosts;
+	ghosts.setLevels( board, gLevels, TOTAL_LEVELS );
+	srand( 49 );
+	for( int i = 0; i < GHOSTS; ++i )
+	{
+		int level = i % TOTAL_LEVELS;
+		std::vector<int> moves;
+		int wander = rand() % 40;
+		for( int j = 0; j < wander; ++j )
+		{
+			moves.push_back( MOVE_UP + rand() % 4 );
+		}
+		if( wander > 0 )
+		{
+			moves.push_back( MOVE_RESET );
+		}
+		moves.insert( moves.end(), solutions[ level ].begin(), solutions[ level ].end() );
+
+		if( !ghosts.add( level, moves ) )
+		{
+			printf( "  ghost %d was refused!\n", i );
+			return false;
+		}
+	}
+
+	std::vector<GhostSprite> dots, stars;
+	dots.reserve( GHOSTS );
+	stars.reserve( GHOSTS * MAX_STARS );
+
+	bool success = true;
+	for( int level = 0; level < TOTAL_LEVELS; ++level )
+	{
+		//Every ghost plays to the end, one move a frame
+		ghosts.restart( level );
+		int frames = 0;
+		double stepSeconds = 0.0, collectSeconds = 0.0;
+		int running = 1;
+		while( running > 0 && frames < 1000 )
+		{
+			std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+			running = ghosts.step( level );
+			stepSeconds += secondsSince( begin );
+
+			begin = std::chrono::steady_clock::now();
+			ghosts.collect( level, dots, stars );
+			collectSeconds += secondsSince( begin );
+			++frames;
+		}
+
+		//Each ghost on the level has its dot and every star
+		int levelGhosts = (int)dots.size();
+		if( running > 0 || levelGhosts != GHOSTS / TOTAL_LEVELS || (int)stars.size() != levelGhosts * gLevels[ level ].starCount )
+		{
+			printf( "  level %d: ghosts didn't finish or lost sprites!\n", level + 1 );
+			success = false;
+		}
+
+		//Finished ghosts stand on the solution's end, so every star sits on a goal
+		int goals[ MAX_STARS ];
+		int goalCount = levelGoalCells( board, gLevels[ level ], goals );
+		for( size_t i = 0; i < stars.size() && success; ++i )
+		{
+			int cell = board.cellFromEntity( stars[ i ].x, stars[ i ].y );
+			if( std::find( goals, goals + goalCount, cell ) == goals + goalCount )
+			{
+				printf( "  level %d: a finished ghost left a star off its goal!\n", level + 1 );
+				success = false;
+			}
+		}
+
+		printf( "  level %d: %d ghosts over %d frames, %.2f us step + %.2f us collect per frame\n", level + 1, levelGhosts, frames,
+			stepSeconds * 1000000.0 / frames, collectSeconds * 1000000.0 / frames );
+	}
+
+	return success;
+}
+
+//Paints random cells of a big map with edge sprites, timing each incremental retile against retiling the whole map
+//Then paints the shipped map, which has no edge art, where nothing but the painted cell may change
+static bool benchEditor( const Board& shipped )
+{
+	const int COLUMNS = 400;
+	const int ROWS = 250;
+	const int PAINTS = 100000;
+	const int CHECK_EVERY = 10000;
+	printf( "Editor auto tiling, %d paints on a %dx%d map\n", PAINTS, COLUMNS, ROWS );
+
+	//Caves of floor and wall, then sprites for every wall
+	srand( 50 );
+	std::vector<int> types( COLUMNS * ROWS );
+	for( size_t i = 0; i < types.size(); ++i )
+	{
+		types[ i ] = rand() % 3 == 0 ? TILE_RED : TILE_GREEN;
+	}
+
+	Board board;
+	board.loadFromTypes( &types[ 0 ], COLUMNS, ROWS );
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	int tiled = autoTileBoard( board );
+	double fullSeconds = secondsSince( begin );
+	printf( "  whole map: %d tiles picked in %.2f ms\n", tiled, fullSeconds * 1000.0 );
+
+	bool success = true;
+	int changed[ MAX_PAINTED_CELLS ];
+	long long changedTotal = 0;
+	double totalSeconds = 0.0, worstSeconds = 0.0;
+	for( int i = 0; i < PAINTS; ++i )
+	{
+		int cell = rand() % board.getCellCount();
+		bool wall = rand() % 2 == 0;
+
+		begin = std::chrono::steady_clock::now();
+		changedTotal += paintTile( board, cell, wall, changed, true );
+		double seconds = secondsSince( begin );
+		totalSeconds += seconds;
+		worstSeconds = seconds > worstSeconds ? seconds : worstSeconds;
+
+		//Retiling everything again has to find nothing the paints missed
+		if( ( i + 1 ) % CHECK_EVERY == 0 )
+		{
+			Board full = board;
+			if( autoTileBoard( full ) != 0 )
+			{
+				printf( "  after %d paints the map is out of date!\n", i + 1 );
+				success = false;
+				break;
+			}
+		}
+	}
+
+	printf( "  %.3f us per paint, %.2f us worst, %.2f tiles changed per paint\n", totalSeconds * 1000000.0 / PAINTS,
+		worstSeconds * 1000000.0, changedTotal / (double)PAINTS );
+
+	//Painting the shipped map the way the game does keeps every hand placed sprite
+	Board edited = shipped;
+	std::vector<unsigned char> touched( shipped.getCellCount(), 0 );
+	int painted = 0;
+	for( int i = 0; i < PAINTS / 1000 && success; ++i )
+	{
+		int cell = rand() % edited.getCellCount();
+		bool wall = rand() % 2 == 0;
+		touched[ cell ] = 1;
+		int changedCount = paintTile( edited, cell, wall, changed );
+		painted += changedCount;
+		if( changedCount > 1 || ( changedCount == 1 && changed[ 0 ] != cell ) )
+		{
+			printf( "  painting cell %d of the shipped map changed its neighbours!\n", cell );
+			success = false;
+		}
+	}
+
+	int kept = 0, walls = 0;
+	for( int i = 0; i < shipped.getCellCount(); ++i )
+	{
+		if( shipped.isWall( i ) && !touched[ i ] )
+		{
+			++walls;
+			kept += shipped.getTileType( i ) == edited.getTileType( i );
+		}
+	}
+	if( kept != walls )
+	{
+		printf( "  %d of the shipped map's walls were re-sprited!\n", walls - kept );
+		success = false;
+	}
+	printf( "  shipped map: %d paints changed %d tiles, %d of %d unpainted walls keep their sprites\n", PAINTS / 1000, painted, kept, walls );
+	return success;
+}
+
+//Checks whether a benchmark was asked for, all run when none are named
+static bool wanted( int argc, char* args[], const char* name )
+{
+	if( argc < 2 )
+	{
+		return true;
+	}
+
+	for( int i = 1; i < argc; ++i )
+	{
+		if( strcmp( args[ i ], name ) == 0 )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int main( int argc, char* args[] )
+{
+	//Load the wall grid the game plays on
+	Board board;
+	if( !board.loadFromFile( LEVEL_MAP_PATH ) )
+	{
+		printf( "Failed to load board!\n" );
+		return 1;
+	}
+
+	bool success = true;
+
+	if( wanted( argc, args, "heuristic" ) )
+	{
+		success = benchHeuristic( board ) && success;
+	}
+
+	if( wanted( argc, args, "moves" ) )
+	{
+		success = benchMoves( board ) && success;
+	}
+
+	if( wanted( argc, args, "patterndb" ) )
+	{
+		success = benchPatternDb( board ) && success;
+	}
+
+	if( wanted( argc, args, "pathfinding" ) )
+	{
+		success = benchPathFinding( board ) && success;
+	}
+
+	if( wanted( argc, args, "batch" ) )
+	{
+		success = benchBatch( board ) && success;
+	}
+
+	if( wanted( argc, args, "jobs" ) )
+	{
+		success = benchJobs( board ) && success;
+	}
+
+	if( wanted( argc, args, "bidirectional" ) )
+	{
+		success = benchBidirectional( board ) && success;
+	}
+
+	if( wanted( argc, args, "macros" ) )
+	{
+		success = benchMacros( board ) && success;
+	}
+
+	if( wanted( argc, args, "ghosts" ) )
+	{
+		success = benchGhosts( board ) && success;
+	}
+
+	if( wanted( argc, args, "editor" ) )
+	{
+		success = benchEditor( board ) && success;
+	}
+
+	if( wanted( argc, args, "store" ) )
+	{
+		success = benchStateStore( board ) && success;
+	}
+
+	return success ? 0 : 1;
+}
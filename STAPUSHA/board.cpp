@@ -0,0 +1,246 @@
+#include "board.h"
+
+//Using standard IO and file streams
+#include <stdio.h>
+#include <fstream>
+
+void sortStars( BoardState& state )
+{
+	for( int i = 1; i < state.starCount; ++i )
+	{
+		int cell = state.stars[ i ];
+		int j = i;
+		while( j > 0 && state.stars[ j - 1 ] > cell )
+		{
+			state.stars[ j ] = state.stars[ j - 1 ];
+			--j;
+		}
+		state.stars[ j ] = cell;
+	}
+}
+
+int findStar( const BoardState& state, int cell )
+{
+	for( int i = 0; i < state.starCount; ++i )
+	{
+		if( state.stars[ i ] == cell )
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+bool isSolved( const BoardState& state, const int goals[], int goalCount )
+{
+	for( int i = 0; i < goalCount; ++i )
+	{
+		if( findStar( state, goals[ i ] ) < 0 )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int oppositeMove( int direction )
+{
+	switch( direction )
+	{
+		case MOVE_UP: return MOVE_DOWN;
+		case MOVE_DOWN: return MOVE_UP;
+		case MOVE_LEFT: return MOVE_RIGHT;
+		case MOVE_RIGHT: return MOVE_LEFT;
+	}
+
+	return MOVE_NONE;
+}
+
+Board::Board()
+{
+	//Initialize
+	mColumns = 0;
+	mRows = 0;
+}
+
+bool Board::loadFromFile( const std::string& path, int columns )
+{
+	//Open the map
+	std::ifstream map( path.c_str() );
+
+	//If the map couldn't be loaded
+	if( map.fail() )
+	{
+		printf( "Unable to load map file %s!\n", path.c_str() );
+		return false;
+	}
+
+	//Read every tile in the map
+	std::vector<int> types;
+	int tileType = -1;
+	while( map >> tileType )
+	{
+		//If we don't recognize the tile type
+		if( ( tileType < 0 ) || ( tileType >= TOTAL_TILE_SPRITES ) )
+		{
+			printf( "Error loading map %s: Invalid tile type at %d!\n", path.c_str(), (int)types.size() );
+			return false;
+		}
+
+		types.push_back( tileType );
+	}
+
+	//The map has to be made of whole rows
+	if( types.empty() || ( types.size() % columns ) != 0 )
+	{
+		printf( "Error loading map %s: Unexpected end of file!\n", path.c_str() );
+		return false;
+	}
+
+	loadFromTypes( &types[ 0 ], columns, (int)types.size() / columns );
+	return true;
+}
+
+void Board::loadFromTypes( const int types[], int columns, int rows )
+{
+	mColumns = columns;
+	mRows = rows;
+	mTypes.resize( columns * rows );
+
+	for( int i = 0; i < columns * rows; ++i )
+	{
+		mTypes[ i ] = (unsigned char)types[ i ];
+	}
+}
+
+bool Board::saveToFile( const std::string& path ) const
+{
+	//Write beside the old map and swap it in, a failed write leaves the old one whole and watchers only see whole files
+	std::string temporary = path + ".tmp";
+	FILE* file = fopen( temporary.c_str(), "w" );
+	if( file == NULL )
+	{
+		printf( "Unable to write map file %s!\n", temporary.c_str() );
+		return false;
+	}
+
+	//Two digit types in rows, the same as the hand written maps
+	for( int y = 0; y < mRows; ++y )
+	{
+		for( int x = 0; x < mColumns; ++x )
+		{
+			fprintf( file, x == 0 ? "%02d" : " %02d", mTypes[ y * mColumns + x ] );
+		}
+		fprintf( file, "\n" );
+	}
+
+	bool written = !ferror( file );
+	if( fclose( file ) != 0 || !written )
+	{
+		printf( "Unable to write map file %s!\n", temporary.c_str() );
+		remove( temporary.c_str() );
+		return false;
+	}
+
+	#ifdef _WIN32
+	remove( path.c_str() );
+	#endif
+	if( rename( temporary.c_str(), path.c_str() ) != 0 )
+	{
+		printf( "Unable to replace map file %s!\n", path.c_str() );
+		remove( temporary.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+void Board::setTileType( int cell, int tileType )
+{
+	mTypes[ cell ] = (unsigned char)tileType;
+}
+
+int Board::getColumns() const
+{
+	return mColumns;
+}
+
+int Board::getRows() const
+{
+	return mRows;
+}
+
+int Board::getCellCount() const
+{
+	return mColumns * mRows;
+}
+
+int Board::getTileType( int cell ) const
+{
+	return mTypes[ cell ];
+}
+
+bool Board::isWall( int cell ) const
+{
+	//Off the board counts as wall
+	if( ( cell < 0 ) || ( cell >= getCellCount() ) )
+	{
+		return true;
+	}
+
+	return isWallTile( mTypes[ cell ] );
+}
+
+int Board::step( int cell, int direction ) const
+{
+	switch( direction )
+	{
+		case MOVE_UP: return stepTowards<MOVE_UP>( cell );
+		case MOVE_DOWN: return stepTowards<MOVE_DOWN>( cell );
+		case MOVE_LEFT: return stepTowards<MOVE_LEFT>( cell );
+		case MOVE_RIGHT: return stepTowards<MOVE_RIGHT>( cell );
+	}
+
+	return -1;
+}
+
+int Board::cellFromEntity( int x, int y ) const
+{
+	return ( ( y - ENTITY_OFFSET_Y ) / CELL_STEP_Y ) * mColumns + ( x - ENTITY_OFFSET_X ) / CELL_STEP_X;
+}
+
+int Board::cellFromGoal( int x, int y ) const
+{
+	return ( y / CELL_STEP_Y ) * mColumns + x / CELL_STEP_X;
+}
+
+int Board::entityX( int cell ) const
+{
+	return ( cell % mColumns ) * CELL_STEP_X + ENTITY_OFFSET_X;
+}
+
+int Board::entityY( int cell ) const
+{
+	return ( cell / mColumns ) * CELL_STEP_Y + ENTITY_OFFSET_Y;
+}
+
+bool Board::applyMove( BoardState& state, int direction, bool* pushed ) const
+{
+	//Pick the specialized move once, the rest of it is straight-line code for that direction
+	switch( direction )
+	{
+		case MOVE_UP: return applyMoveTowards<MOVE_UP>( state, pushed );
+		case MOVE_DOWN: return applyMoveTowards<MOVE_DOWN>( state, pushed );
+		case MOVE_LEFT: return applyMoveTowards<MOVE_LEFT>( state, pushed );
+		case MOVE_RIGHT: return applyMoveTowards<MOVE_RIGHT>( state, pushed );
+	}
+
+	if( pushed != NULL )
+	{
+		*pushed = false;
+	}
+
+	return false;
+}
@@ -0,0 +1,259 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+//Using strings and vectors
+#include <string>
+#include <vector>
+
+//The dimensions of the level
+const int LEVEL_WIDTH = 675;
+const int LEVEL_HEIGHT = 4950;
+
+//Tile constants
+const int TILE_WIDTH = 80;
+const int TILE_HEIGHT = 80;
+const int TOTAL_TILES = 693;
+const int TOTAL_TILE_SPRITES = 12;
+
+//The different tile sprites
+const int TILE_RED = 0;
+const int TILE_GREEN = 1;
+const int TILE_BLUE = 2;
+const int TILE_CENTER = 3;
+const int TILE_TOP = 4;
+const int TILE_TOPRIGHT = 5;
+const int TILE_RIGHT = 6;
+const int TILE_BOTTOMRIGHT = 7;
+const int TILE_BOTTOM = 8;
+const int TILE_BOTTOMLEFT = 9;
+const int TILE_LEFT = 10;
+const int TILE_TOPLEFT = 11;
+
+//What each tile type is, indexed by tile type
+struct TileInfo
+{
+	//Whether the dot can walk onto it and a star can be pushed onto it
+	bool walkable;
+	bool pushable;
+
+	//Where its sprite sits in the tile sheet
+	int clipX;
+	int clipY;
+};
+
+//Known at compile time, so lookups on a constant type fold away
+constexpr TileInfo TILE_INFO[ TOTAL_TILE_SPRITES ] =
+{
+	{ false, false, 0, 0 },		//TILE_RED
+	{ true, true, 0, 80 },		//TILE_GREEN
+	{ false, false, 0, 160 },	//TILE_BLUE
+	{ false, false, 160, 80 },	//TILE_CENTER
+	{ false, false, 160, 0 },	//TILE_TOP
+	{ false, false, 240, 0 },	//TILE_TOPRIGHT
+	{ false, false, 240, 80 },	//TILE_RIGHT
+	{ false, false, 240, 160 },	//TILE_BOTTOMRIGHT
+	{ false, false, 160, 160 },	//TILE_BOTTOM
+	{ false, false, 80, 160 },	//TILE_BOTTOMLEFT
+	{ false, false, 80, 80 },	//TILE_LEFT
+	{ false, false, 80, 0 }		//TILE_TOPLEFT
+};
+
+//The tile map every level is carved out of
+const char LEVEL_MAP_PATH[] = "39_tiling/levelOne.map";
+
+//Tiles overlap, so neighbouring cells are closer than a tile apart
+const int CELL_STEP_X = TILE_WIDTH - 5;
+const int CELL_STEP_Y = TILE_HEIGHT - 24;
+
+//Dots and stars sit this far inside their cell
+const int ENTITY_OFFSET_X = 22;
+const int ENTITY_OFFSET_Y = 11;
+
+//The number of tile columns in a map row
+const int BOARD_COLUMNS = LEVEL_WIDTH / CELL_STEP_X;
+
+//The move codes Dot::handleEvent produces
+const int MOVE_NONE = 0;
+const int MOVE_UP = 1;
+const int MOVE_DOWN = 2;
+const int MOVE_LEFT = 3;
+const int MOVE_RIGHT = 4;
+
+//The code a reset is played and logged as
+const int MOVE_RESET = 5;
+
+//The most stars a single level may hold
+const int MAX_STARS = 16;
+
+//The dot cell and sorted star cells of one level
+struct BoardState
+{
+	int player;
+	int starCount;
+	int stars[ MAX_STARS ];
+};
+
+//Puts the stars of a hand-built state in order
+void sortStars( BoardState& state );
+
+//Gets the index of the star on a cell, or -1 if there is none
+int findStar( const BoardState& state, int cell );
+
+//Checks whether every goal has a star on it
+bool isSolved( const BoardState& state, const int goals[], int goalCount );
+
+//Gets the move that undoes the given one
+int oppositeMove( int direction );
+
+//Checks whether a tile type blocks dots, unknown types don't
+constexpr bool isWallTile( int tileType )
+{
+	return tileType >= 0 && tileType < TOTAL_TILE_SPRITES && !TILE_INFO[ tileType ].walkable;
+}
+
+//Checks whether a tile type stops pushed stars, unknown types don't
+constexpr bool stopsStars( int tileType )
+{
+	return tileType >= 0 && tileType < TOTAL_TILE_SPRITES && !TILE_INFO[ tileType ].pushable;
+}
+
+//The wall grid of a tile map, one cell per tile
+class Board
+{
+	public:
+		//Initializes an empty board
+		Board();
+
+		//Loads the grid from a tile map in the format setTiles reads
+		bool loadFromFile( const std::string& path, int columns = BOARD_COLUMNS );
+
+		//Builds the grid from row-major tile types
+		void loadFromTypes( const int types[], int columns, int rows );
+
+		//Writes the grid as a tile map loadFromFile reads back, returns false if it couldn't be written
+		bool saveToFile( const std::string& path ) const;
+
+		//Changes the type of a single tile
+		void setTileType( int cell, int tileType );
+
+		//Gets the grid dimensions
+		int getColumns() const;
+		int getRows() const;
+		int getCellCount() const;
+
+		//Gets the tile type of a cell
+		int getTileType( int cell ) const;
+
+		//Checks whether a cell blocks dots and stars
+		bool isWall( int cell ) const;
+
+		//Gets the cell one move away, or -1 if that leaves the board
+		int step( int cell, int direction ) const;
+
+		//Converts dot/star and goal pixel positions to cells
+		int cellFromEntity( int x, int y ) const;
+		int cellFromGoal( int x, int y ) const;
+
+		//Converts a cell back to dot/star pixel positions
+		int entityX( int cell ) const;
+		int entityY( int cell ) const;
+
+		//Gets the cell one move towards DIRECTION, or -1 if that leaves the board
+		template<int DIRECTION>
+		int stepTowards( int cell ) const;
+
+		//Plays a move by the rules of Dot::move, DotOnStar and starOnStar
+		//Returns false and leaves the state alone if the dot is blocked
+		bool applyMove( BoardState& state, int direction, bool* pushed = NULL ) const;
+
+		//applyMove with the direction fixed at compile time, so only its own bounds check is left
+		template<int DIRECTION>
+		bool applyMoveTowards( BoardState& state, bool* pushed = NULL ) const;
+
+	private:
+		//The grid dimensions
+		int mColumns;
+		int mRows;
+
+		//The tile type of every cell
+		std::vector<unsigned char> mTypes;
+};
+
+template<int DIRECTION>
+int Board::stepTowards( int cell ) const
+{
+	static_assert( DIRECTION >= MOVE_UP && DIRECTION <= MOVE_RIGHT, "Not a move direction" );
+
+	if( DIRECTION == MOVE_UP )
+	{
+		return cell >= mColumns ? cell - mColumns : -1;
+	}
+	else if( DIRECTION == MOVE_DOWN )
+	{
+		return cell + mColumns < (int)mTypes.size() ? cell + mColumns : -1;
+	}
+	else if( DIRECTION == MOVE_LEFT )
+	{
+		return cell % mColumns > 0 ? cell - 1 : -1;
+	}
+	else
+	{
+		return cell % mColumns + 1 < mColumns ? cell + 1 : -1;
+	}
+}
+
+template<int DIRECTION>
+bool Board::applyMoveTowards( BoardState& state, bool* pushed ) const
+{
+	if( pushed != NULL )
+	{
+		*pushed = false;
+	}
+
+	//The dot can't walk into walls, stepTowards already kept the cell on the board
+	int next = stepTowards<DIRECTION>( state.player );
+	if( next < 0 || isWallTile( mTypes[ next ] ) )
+	{
+		return false;
+	}
+
+	//A star moves ahead of the dot unless a wall or another star stops it
+	int star = findStar( state, next );
+	if( star >= 0 )
+	{
+		int beyond = stepTowards<DIRECTION>( next );
+		if( beyond < 0 || stopsStars( mTypes[ beyond ] ) || findStar( state, beyond ) >= 0 )
+		{
+			return false;
+		}
+
+		//Slide the star back into sorted order, stars only move to a higher cell going down or right
+		if( DIRECTION == MOVE_UP || DIRECTION == MOVE_LEFT )
+		{
+			while( star > 0 && state.stars[ star - 1 ] > beyond )
+			{
+				state.stars[ star ] = state.stars[ star - 1 ];
+				--star;
+			}
+		}
+		else
+		{
+			while( star + 1 < state.starCount && state.stars[ star + 1 ] < beyond )
+			{
+				state.stars[ star ] = state.stars[ star + 1 ];
+				++star;
+			}
+		}
+		state.stars[ star ] = beyond;
+
+		if( pushed != NULL )
+		{
+			*pushed = true;
+		}
+	}
+
+	state.player = next;
+	return true;
+}
+
+#endif
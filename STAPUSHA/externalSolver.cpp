@@ -0,0 +1,255 @@
+#include "externalSolver.h"
+#include "solver.h"
+
+//Using standard IO
+#include <stdio.h>
+
+//Where search files go unless told otherwise
+const char DEFAULT_WORK_PATH[] = "39_tiling/solver";
+
+ExternalSolver::ExternalSolver( const Board& board, const int goals[], int goalCount )
+{
+	//Initialize
+	mBoard = &board;
+	mGoalCount = goalCount;
+	for( int i = 0; i < goalCount; ++i )
+	{
+		mGoals[ i ] = goals[ i ];
+	}
+
+	mDistances.build( board, goals, goalCount );
+	mMemoryBudget = DEFAULT_STORE_BUDGET;
+	mWorkPath = DEFAULT_WORK_PATH;
+	mNodeLimit = -1;
+	mExpandedNodes = 0;
+	mSpilledRuns = 0;
+	mSpilledBytes = 0;
+	mStoredStates = 0;
+	mPackedBytes = 0;
+	mStopped = false;
+}
+
+void ExternalSolver::setMemoryBudget( size_t bytes )
+{
+	mMemoryBudget = bytes;
+}
+
+void ExternalSolver::setWorkPath( const std::string& path )
+{
+	mWorkPath = path;
+}
+
+void ExternalSolver::setNodeLimit( long long limit )
+{
+	mNodeLimit = limit;
+}
+
+bool ExternalSolver::solve( const BoardState& start, std::vector<int>& moves )
+{
+	moves.clear();
+	mExpandedNodes = 0;
+	mSpilledRuns = 0;
+	mSpilledBytes = 0;
+	mStoredStates = 0;
+	mPackedBytes = 0;
+	mStopped = false;
+
+	if( isSolved( start, mGoals, mGoalCount ) )
+	{
+		return true;
+	}
+
+	//The first layer and the seen file both hold just the start
+	std::string seenPath = mWorkPath + ".seen";
+	std::string mergedPath = mWorkPath + ".merged";
+	StateWriter first, seen;
+	if( !first.open( layerPath( 0 ) ) || !seen.open( seenPath ) )
+	{
+		mStopped = true;
+		removeFiles( 0 );
+		return false;
+	}
+	first.write( start );
+	seen.write( start );
+	if( !first.close() || !seen.close() )
+	{
+		mStopped = true;
+		removeFiles( 0 );
+		return false;
+	}
+
+	//Adds up the store statistics of each layer
+	auto tally = [ this ]( const StateStore& store )
+	{
+		mSpilledRuns += store.getSpilledRuns();
+		mSpilledBytes += store.getSpilledBytes();
+		mStoredStates += store.getAdded();
+		mPackedBytes += store.getPackedBytes();
+	};
+
+	for( int depth = 0; ; ++depth )
+	{
+		StateStore store( mWorkPath + ".store", mMemoryBudget );
+		StateReader layer;
+		if( !layer.open( layerPath( depth ) ) )
+		{
+			mStopped = true;
+			removeFiles( depth );
+			return false;
+		}
+
+		//Expand the whole layer into the store, duplicates and all
+		BoardState state, solved;
+		bool found = false;
+		while( !found && layer.next() )
+		{
+			if( ++mExpandedNodes > mNodeLimit && mNodeLimit >= 0 )
+			{
+				mStopped = true;
+				removeFiles( depth );
+				return false;
+			}
+
+			layer.getState( state );
+			for( int direction = MOVE_UP; direction <= MOVE_RIGHT && !found; ++direction )
+			{
+				BoardState child = state;
+				bool pushed = false;
+				if( !mBoard->applyMove( child, direction, &pushed ) )
+				{
+					continue;
+				}
+
+				if( pushed && mDistances.isDeadCell( mBoard->step( child.player, direction ) ) )
+				{
+					continue;
+				}
+
+				if( pushed && isSolved( child, mGoals, mGoalCount ) )
+				{
+					solved = child;
+					found = true;
+				}
+				else if( !store.add( child ) )
+				{
+					mStopped = true;
+					removeFiles( depth );
+					return false;
+				}
+			}
+		}
+		layer.close();
+
+		if( found )
+		{
+			tally( store );
+			bool traced = traceBack( solved, depth, moves );
+			removeFiles( depth );
+			mStopped = !traced;
+			return traced;
+		}
+
+		//Keep only states no earlier layer reached, and add them to the seen file
+		long long count = store.collapse( layerPath( depth + 1 ), seenPath, mergedPath );
+		tally( store );
+		if( count < 0 || remove( seenPath.c_str() ) != 0 || rename( mergedPath.c_str(), seenPath.c_str() ) != 0 )
+		{
+			mStopped = true;
+			removeFiles( depth + 1 );
+			return false;
+		}
+
+		//Nothing new to expand means no solution
+		if( count == 0 )
+		{
+			removeFiles( depth + 1 );
+			return false;
+		}
+	}
+}
+
+long long ExternalSolver::getExpandedNodes() const
+{
+	return mExpandedNodes;
+}
+
+int ExternalSolver::getSpilledRuns() const
+{
+	return mSpilledRuns;
+}
+
+long long ExternalSolver::getSpilledBytes() const
+{
+	return mSpilledBytes;
+}
+
+double ExternalSolver::getPackedStateSize() const
+{
+	return mStoredStates > 0 ? (double)mPackedBytes / mStoredStates : 0.0;
+}
+
+bool ExternalSolver::wasStopped() const
+{
+	return mStopped;
+}
+
+std::string ExternalSolver::layerPath( int depth ) const
+{
+	char suffix[ 32 ];
+	snprintf( suffix, sizeof( suffix ), ".layer%d", depth );
+	return mWorkPath + suffix;
+}
+
+bool ExternalSolver::traceBack( const BoardState& solved, int depth, std::vector<int>& moves )
+{
+	BoardStateEqual equal;
+	BoardState current = solved;
+	moves.assign( depth + 1, MOVE_NONE );
+
+	//Each layer holds some state one move before the current one
+	for( int layerDepth = depth; layerDepth >= 0; --layerDepth )
+	{
+		StateReader layer;
+		if( !layer.open( layerPath( layerDepth ) ) )
+		{
+			return false;
+		}
+
+		bool found = false;
+		BoardState state;
+		while( !found && layer.next() )
+		{
+			layer.getState( state );
+			for( int direction = MOVE_UP; direction <= MOVE_RIGHT && !found; ++direction )
+			{
+				BoardState child = state;
+				if( mBoard->applyMove( child, direction ) && equal( child, current ) )
+				{
+					moves[ layerDepth ] = direction;
+					found = true;
+				}
+			}
+		}
+
+		if( !found )
+		{
+			printf( "Layer %d has no way into the state after it!\n", layerDepth );
+			return false;
+		}
+
+		current = state;
+	}
+
+	return true;
+}
+
+void ExternalSolver::removeFiles( int depth )
+{
+	for( int i = 0; i <= depth; ++i )
+	{
+		remove( layerPath( i ).c_str() );
+	}
+
+	remove( ( mWorkPath + ".seen" ).c_str() );
+	remove( ( mWorkPath + ".merged" ).c_str() );
+}
@@ -0,0 +1,73 @@
+#ifndef EXTERNAL_SOLVER_H
+#define EXTERNAL_SOLVER_H
+
+#include "board.h"
+#include "heuristic.h"
+#include "stateStore.h"
+
+//Searches breadth first for the shortest solution, keeping every layer and the states seen on disk
+//Slower than Solver, but its memory use is capped, so levels too big for Solver's hash map still finish
+class ExternalSolver
+{
+	public:
+		//Initializes the solver for one level's goals
+		ExternalSolver( const Board& board, const int goals[], int goalCount );
+
+		//Sets how much memory the state store may buffer before spilling runs
+		void setMemoryBudget( size_t bytes );
+
+		//Sets the path prefix of the layer and run files
+		void setWorkPath( const std::string& path );
+
+		//Sets how many states a search may expand before giving up
+		void setNodeLimit( long long limit );
+
+		//Finds a move-optimal solution, returns false if there is none or the search stopped
+		bool solve( const BoardState& start, std::vector<int>& moves );
+
+		//Gets the number of states the last search expanded
+		long long getExpandedNodes() const;
+
+		//Gets how many runs the memory budget forced the last search to spill and their total size
+		int getSpilledRuns() const;
+		long long getSpilledBytes() const;
+
+		//Gets the average bytes a stored state packed to in the last search
+		double getPackedStateSize() const;
+
+		//Checks whether the last search ran out of nodes or hit a file error
+		bool wasStopped() const;
+
+	private:
+		//Gets the file of the states first reached after depth moves
+		std::string layerPath( int depth ) const;
+
+		//Walks back from a solved state through the layer files, returns false on a file error
+		bool traceBack( const BoardState& solved, int depth, std::vector<int>& moves );
+
+		//Deletes the files of a search
+		void removeFiles( int depth );
+
+		//The level
+		const Board* mBoard;
+		int mGoals[ MAX_STARS ];
+		int mGoalCount;
+
+		//Push distances, to drop states with a star that can't reach any goal
+		PushDistances mDistances;
+
+		//The search settings
+		size_t mMemoryBudget;
+		std::string mWorkPath;
+		long long mNodeLimit;
+
+		//The last search statistics
+		long long mExpandedNodes;
+		int mSpilledRuns;
+		long long mSpilledBytes;
+		long long mStoredStates;
+		long long mPackedBytes;
+		bool mStopped;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "fileWatcher.h"
+
+//Using standard IO and the platform file calls
+#include <stdio.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+//How often the polling fallback looks at the file
+const int WATCH_POLL_MS = 250;
+
+FileWatcher::FileWatcher()
+{
+	//Initialize
+	mNotify = -1;
+	mTime = 0;
+	mSize = 0;
+}
+
+FileWatcher::~FileWatcher()
+{
+	//Deallocate
+	stop();
+}
+
+bool FileWatcher::watch( const std::string& path )
+{
+	stop();
+
+	mPath = path;
+	size_t slash = path.find_last_of( "/\\" );
+	mName = slash == std::string::npos ? path : path.substr( slash + 1 );
+	std::string directory = slash == std::string::npos ? "." : path.substr( 0, slash );
+
+	if( !readStamp( mTime, mSize ) )
+	{
+		printf( "Unable to watch %s!\n", path.c_str() );
+		return false;
+	}
+	mLastPoll = std::chrono::steady_clock::now();
+
+	#ifdef __linux__
+	//Watch the directory, editors often save by renaming a new file over the old one
+	mNotify = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if( mNotify >= 0 && inotify_add_watch( mNotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO ) < 0 )
+	{
+		close( mNotify );
+		mNotify = -1;
+	}
+
+	if( mNotify < 0 )
+	{
+		printf( "Warning: inotify unavailable, polling %s instead!\n", path.c_str() );
+	}
+	#endif
+
+	return true;
+}
+
+void FileWatcher::stop()
+{
+	#ifdef __linux__
+	if( mNotify >= 0 )
+	{
+		close( mNotify );
+	}
+	#endif
+
+	mNotify = -1;
+	mPath.clear();
+}
+
+bool FileWatcher::changed()
+{
+	if( mPath.empty() )
+	{
+		return false;
+	}
+
+	#ifdef __linux__
+	if( mNotify >= 0 )
+	{
+		//Drain every pending event, only ones naming the file count
+		bool found = false;
+		char buffer[ 4096 ] __attribute__( ( aligned( __alignof__( struct inotify_event ) ) ) );
+		ssize_t length;
+		while( ( length = read( mNotify, buffer, sizeof( buffer ) ) ) > 0 )
+		{
+			for( char* next = buffer; next < buffer + length; )
+			{
+				struct inotify_event* event = (struct inotify_event*)next;
+				if( event->len > 0 && mName == event->name )
+				{
+					found = true;
+				}
+
+				next += sizeof( struct inotify_event ) + event->len;
+			}
+		}
+
+		return found;
+	}
+	#endif
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if( now - mLastPoll < std::chrono::milliseconds( WATCH_POLL_MS ) )
+	{
+		return false;
+	}
+	mLastPoll = now;
+
+	long long time, size;
+	if( !readStamp( time, size ) || ( time == mTime && size == mSize ) )
+	{
+		return false;
+	}
+
+	mTime = time;
+	mSize = size;
+	return true;
+}
+
+bool FileWatcher::isNotified() const
+{
+	return mNotify >= 0;
+}
+
+bool FileWatcher::readStamp( long long& time, long long& size ) const
+{
+	struct stat info;
+	if( stat( mPath.c_str(), &info ) != 0 )
+	{
+		return false;
+	}
+
+	time = (long long)info.st_mtime;
+	size = (long long)info.st_size;
+	return true;
+}
@@ -0,0 +1,51 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+//Using strings and timers
+#include <string>
+#include <chrono>
+
+//Notices when a file is rewritten, using inotify where there is one and polling its timestamp otherwise
+class FileWatcher
+{
+	public:
+		//Initializes variables
+		FileWatcher();
+
+		//Stops watching
+		~FileWatcher();
+
+		//Starts watching the file at the specified path
+		bool watch( const std::string& path );
+
+		//Stops watching
+		void stop();
+
+		//Checks whether the file changed since the last call, never waits
+		bool changed();
+
+		//Checks whether changes come from inotify rather than polling
+		bool isNotified() const;
+
+	private:
+		//Copying would close the watch twice
+		FileWatcher( const FileWatcher& );
+		FileWatcher& operator=( const FileWatcher& );
+
+		//Gets the file's modification time and size, returns false if it's missing
+		bool readStamp( long long& time, long long& size ) const;
+
+		//The watched file and the name inotify reports it by
+		std::string mPath;
+		std::string mName;
+
+		//The inotify descriptor, -1 when polling
+		int mNotify;
+
+		//The polling fallback's last stamp and check time
+		long long mTime;
+		long long mSize;
+		std::chrono::steady_clock::time_point mLastPoll;
+};
+
+#endif
@@ -0,0 +1,195 @@
+#include "gameState.h"
+
+//Using standard IO and string functions
+#include <stdio.h>
+#include <string.h>
+
+//The serialized state format version
+const unsigned int GAME_STATE_VERSION = 1;
+
+//Appends little endian values to a byte buffer
+static unsigned char* putInt( unsigned char* out, unsigned int value, int bytes )
+{
+	for( int i = 0; i < bytes; ++i )
+	{
+		out[ i ] = (unsigned char)( value >> ( 8 * i ) );
+	}
+
+	return out + bytes;
+}
+
+//Reads little endian values from a byte buffer
+static const unsigned char* getInt( const unsigned char* in, unsigned int& value, int bytes )
+{
+	value = 0;
+	for( int i = 0; i < bytes; ++i )
+	{
+		value |= (unsigned int)in[ i ] << ( 8 * i );
+	}
+
+	return in + bytes;
+}
+
+//FNV-1a over the serialized fields
+static unsigned int checksum( const unsigned char* bytes, int size )
+{
+	unsigned int hash = 2166136261u;
+	for( int i = 0; i < size; ++i )
+	{
+		hash = ( hash ^ bytes[ i ] ) * 16777619u;
+	}
+
+	return hash;
+}
+
+GameState startGameState()
+{
+	GameState state;
+	memset( &state, 0, sizeof( state ) );
+
+	state.level = 1;
+	state.dotX = (short)gLevels[ 0 ].dot.x;
+	state.dotY = (short)gLevels[ 0 ].dot.y;
+	for( int i = 0; i < TOTAL_LEVELS; ++i )
+	{
+		for( int j = 0; j < gLevels[ i ].starCount; ++j )
+		{
+			state.starX[ i ][ j ] = (short)gLevels[ i ].stars[ j ].x;
+			state.starY[ i ][ j ] = (short)gLevels[ i ].stars[ j ].y;
+		}
+	}
+
+	return state;
+}
+
+void serializeGameState( const GameState& state, unsigned char bytes[ GAME_STATE_BYTES ] )
+{
+	unsigned char* out = bytes;
+	memcpy( out, "SPGS", 4 );
+	out += 4;
+	out = putInt( out, GAME_STATE_VERSION, 4 );
+	out = putInt( out, (unsigned int)state.level, 4 );
+	out = putInt( out, (unsigned short)state.dotX, 2 );
+	out = putInt( out, (unsigned short)state.dotY, 2 );
+
+	for( int i = 0; i < TOTAL_LEVELS; ++i )
+	{
+		for( int j = 0; j < MAX_STARS; ++j )
+		{
+			out = putInt( out, (unsigned short)state.starX[ i ][ j ], 2 );
+			out = putInt( out, (unsigned short)state.starY[ i ][ j ], 2 );
+			out = putInt( out, state.goalLit[ i ][ j ], 1 );
+		}
+	}
+
+	putInt( out, checksum( bytes, GAME_STATE_BYTES - 4 ), 4 );
+}
+
+bool deserializeGameState( const unsigned char bytes[ GAME_STATE_BYTES ], GameState& state )
+{
+	unsigned int value = 0;
+	const unsigned char* in = bytes + 4;
+	if( memcmp( bytes, "SPGS", 4 ) != 0 )
+	{
+		return false;
+	}
+
+	in = getInt( in, value, 4 );
+	if( value != GAME_STATE_VERSION )
+	{
+		return false;
+	}
+
+	getInt( bytes + GAME_STATE_BYTES - 4, value, 4 );
+	if( value != checksum( bytes, GAME_STATE_BYTES - 4 ) )
+	{
+		return false;
+	}
+
+	//Only fill the caller's state once everything checks out
+	GameState read;
+	in = getInt( in, value, 4 );
+	read.level = (int)value;
+	if( read.level < 1 || read.level > TOTAL_LEVELS + 1 )
+	{
+		return false;
+	}
+
+	in = getInt( in, value, 2 );
+	read.dotX = (short)value;
+	in = getInt( in, value, 2 );
+	read.dotY = (short)value;
+
+	for( int i = 0; i < TOTAL_LEVELS; ++i )
+	{
+		for( int j = 0; j < MAX_STARS; ++j )
+		{
+			in = getInt( in, value, 2 );
+			read.starX[ i ][ j ] = (short)value;
+			in = getInt( in, value, 2 );
+			read.starY[ i ][ j ] = (short)value;
+			in = getInt( in, value, 1 );
+			read.goalLit[ i ][ j ] = value != 0;
+		}
+	}
+
+	state = read;
+	return true;
+}
+
+bool saveGameState( const char* path, const GameState& state )
+{
+	unsigned char bytes[ GAME_STATE_BYTES ];
+	serializeGameState( state, bytes );
+
+	//Write beside the old save and swap it in, a crash mid write leaves the old one whole
+	char temporary[ 1024 ];
+	snprintf( temporary, sizeof( temporary ), "%s.tmp", path );
+	FILE* file = fopen( temporary, "wb" );
+	if( file == NULL )
+	{
+		printf( "Unable to write save %s!\n", temporary );
+		return false;
+	}
+
+	bool written = fwrite( bytes, GAME_STATE_BYTES, 1, file ) == 1;
+	if( fclose( file ) != 0 || !written )
+	{
+		printf( "Unable to write save %s!\n", temporary );
+		remove( temporary );
+		return false;
+	}
+
+	#ifdef _WIN32
+	remove( path );
+	#endif
+	if( rename( temporary, path ) != 0 )
+	{
+		printf( "Unable to replace save %s!\n", path );
+		remove( temporary );
+		return false;
+	}
+
+	return true;
+}
+
+bool loadGameState( const char* path, GameState& state )
+{
+	FILE* file = fopen( path, "rb" );
+	if( file == NULL )
+	{
+		return false;
+	}
+
+	unsigned char bytes[ GAME_STATE_BYTES ];
+	bool read = fread( bytes, GAME_STATE_BYTES, 1, file ) == 1 && fgetc( file ) == EOF;
+	fclose( file );
+
+	if( !read || !deserializeGameState( bytes, state ) )
+	{
+		printf( "Save %s is corrupt!\n", path );
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,53 @@
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include "levels.h"
+
+//Using type traits
+#include <type_traits>
+
+//Where the game keeps its running save, --resume picks it up
+const char AUTOSAVE_PATH[] = "39_tiling/autosave.sav";
+
+//The number of in-game save slots
+const int SAVE_SLOTS = 4;
+
+//Everything that changes during play, plain data so a copy is a single assignment
+struct GameState
+{
+	//The level being played, TOTAL_LEVELS + 1 once every level is done
+	int level;
+
+	//The dot's pixel position
+	short dotX;
+	short dotY;
+
+	//Every level's star pixel positions, any level's stars can be pushed
+	short starX[ TOTAL_LEVELS ][ MAX_STARS ];
+	short starY[ TOTAL_LEVELS ][ MAX_STARS ];
+
+	//Which goals have a star on them
+	unsigned char goalLit[ TOTAL_LEVELS ][ MAX_STARS ];
+};
+
+static_assert( std::is_trivially_copyable<GameState>::value, "GameState must stay plain data" );
+
+//The size of a serialized state, the same on every platform
+const int GAME_STATE_BYTES = 4 + 4 + 4 + 2 + 2 + TOTAL_LEVELS * MAX_STARS * ( 2 + 2 + 1 ) + 4;
+
+//Gets the state of a fresh game with every level as the level table lays it out
+GameState startGameState();
+
+//Writes a state as little endian bytes with a checksum
+void serializeGameState( const GameState& state, unsigned char bytes[ GAME_STATE_BYTES ] );
+
+//Reads serialized bytes back, returns false if they're corrupt or from another version
+bool deserializeGameState( const unsigned char bytes[ GAME_STATE_BYTES ], GameState& state );
+
+//Writes a state to a file, replacing the old one only once the new one is complete, without allocating
+bool saveGameState( const char* path, const GameState& state );
+
+//Reads a state from a file, returns false if it's missing or corrupt
+bool loadGameState( const char* path, GameState& state );
+
+#endif
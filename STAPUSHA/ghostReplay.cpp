@@ -0,0 +1,170 @@
+#include "ghostReplay.h"
+#include "moveLog.h"
+
+//Using standard IO
+#include <stdio.h>
+
+GhostReplay::GhostReplay()
+{
+}
+
+void GhostReplay::setLevels( const Board& board, const LevelInfo levels[], int levelCount )
+{
+	mBoard = board;
+	mStarts.resize( levelCount );
+	for( int i = 0; i < levelCount; ++i )
+	{
+		mStarts[ i ].player = board.cellFromEntity( levels[ i ].dot.x, levels[ i ].dot.y );
+		mStarts[ i ].starCount = levelStarCells( board, levels[ i ], mStarts[ i ].stars );
+		sortStars( mStarts[ i ] );
+	}
+
+	mGhosts.clear();
+	mMoves.clear();
+}
+
+void GhostReplay::setTileType( int cell, int tileType )
+{
+	mBoard.setTileType( cell, tileType );
+}
+
+bool GhostReplay::load( const std::string& path, int limit )
+{
+	FILE* file = fopen( path.c_str(), "r" );
+	if( file == NULL )
+	{
+		printf( "Unable to open ghost runs %s!\n", path.c_str() );
+		return false;
+	}
+
+	bool success = true;
+	std::string line;
+	std::vector<int> moves;
+	for( int number = 1; readSolutionLine( file, line ) && ( limit <= 0 || (int)mGhosts.size() < limit ); ++number )
+	{
+		int level = parseSolutionLine( line.c_str(), moves );
+		if( level == 0 )
+		{
+			continue;
+		}
+
+		if( level < 0 || !add( level - 1, moves ) )
+		{
+			printf( "Error reading ghost runs %s: Bad run on line %d!\n", path.c_str(), number );
+			success = false;
+			break;
+		}
+	}
+
+	fclose( file );
+	return success;
+}
+
+bool GhostReplay::add( int level, const std::vector<int>& moves )
+{
+	if( level < 0 || level >= (int)mStarts.size() )
+	{
+		return false;
+	}
+
+	Ghost ghost;
+	ghost.level = level;
+	ghost.first = (int)mMoves.size();
+	ghost.count = (int)moves.size();
+	ghost.next = 0;
+	ghost.state = mStarts[ level ];
+	ghost.previous = ghost.state;
+
+	for( size_t i = 0; i < moves.size(); ++i )
+	{
+		if( moves[ i ] < MOVE_UP || moves[ i ] > MOVE_RESET )
+		{
+			mMoves.resize( ghost.first );
+			return false;
+		}
+		mMoves.push_back( (unsigned char)moves[ i ] );
+	}
+
+	mGhosts.push_back( ghost );
+	return true;
+}
+
+void GhostReplay::restart( int level )
+{
+	for( size_t i = 0; i < mGhosts.size(); ++i )
+	{
+		if( mGhosts[ i ].level == level )
+		{
+			mGhosts[ i ].next = 0;
+			mGhosts[ i ].state = mStarts[ level ];
+			mGhosts[ i ].previous = mGhosts[ i ].state;
+		}
+	}
+}
+
+int GhostReplay::step( int level )
+{
+	int running = 0;
+	for( size_t i = 0; i < mGhosts.size(); ++i )
+	{
+		Ghost& ghost = mGhosts[ i ];
+		if( ghost.level != level )
+		{
+			continue;
+		}
+
+		//A finished ghost stands still where it ended
+		ghost.previous = ghost.state;
+		if( ghost.next >= ghost.count )
+		{
+			continue;
+		}
+
+		int move = mMoves[ ghost.first + ghost.next++ ];
+		if( move == MOVE_RESET )
+		{
+			ghost.state = mStarts[ level ];
+			ghost.previous = ghost.state;
+		}
+		else
+		{
+			mBoard.applyMove( ghost.state, move );
+		}
+
+		running += ghost.next < ghost.count;
+	}
+
+	return running;
+}
+
+void GhostReplay::collect( int level, std::vector<GhostSprite>& dots, std::vector<GhostSprite>& stars ) const
+{
+	dots.clear();
+	stars.clear();
+	for( size_t i = 0; i < mGhosts.size(); ++i )
+	{
+		const Ghost& ghost = mGhosts[ i ];
+		if( ghost.level != level )
+		{
+			continue;
+		}
+
+		GhostSprite dot = { mBoard.entityX( ghost.state.player ), mBoard.entityY( ghost.state.player ),
+			mBoard.entityX( ghost.previous.player ), mBoard.entityY( ghost.previous.player ) };
+		dots.push_back( dot );
+
+		//Stars are kept sorted by cell, so match each with where it was by the one the move pushed
+		for( int j = 0; j < ghost.state.starCount; ++j )
+		{
+			int cell = ghost.state.stars[ j ];
+			int from = findStar( ghost.previous, cell ) >= 0 ? cell : ghost.state.player;
+			GhostSprite star = { mBoard.entityX( cell ), mBoard.entityY( cell ), mBoard.entityX( from ), mBoard.entityY( from ) };
+			stars.push_back( star );
+		}
+	}
+}
+
+int GhostReplay::getGhostCount() const
+{
+	return (int)mGhosts.size();
+}
@@ -0,0 +1,79 @@
+#ifndef GHOST_REPLAY_H
+#define GHOST_REPLAY_H
+
+#include "board.h"
+#include "levels.h"
+
+//Using strings and vectors
+#include <string>
+#include <vector>
+
+//A ghost's dot or star in pixels, where it stands and where it stood when the move began
+struct GhostSprite
+{
+	int x;
+	int y;
+	int prevX;
+	int prevY;
+};
+
+//Recorded runs played back alongside the player, on their own copy of the board
+class GhostReplay
+{
+	public:
+		//Initializes an empty replay
+		GhostReplay();
+
+		//Takes the board and level starts the runs are played on
+		void setLevels( const Board& board, const LevelInfo levels[], int levelCount );
+
+		//Changes a tile of the board the runs are played on, for when the map is painted or reloaded
+		//Ghosts already under way keep going, restart them to replay their runs on the new map
+		void setTileType( int cell, int tileType );
+
+		//Adds every run in a solutions file, one level number and move log per line, up to limit runs if it's positive
+		//Returns false if the file is missing or a line is malformed
+		bool load( const std::string& path, int limit = 0 );
+
+		//Adds one run of a 0 based level, returns false if the level or a move is unknown
+		bool add( int level, const std::vector<int>& moves );
+
+		//Puts every ghost on a level back at the start of its run
+		void restart( int level );
+
+		//Plays the next move of every ghost on a level, returns how many still have moves left
+		int step( int level );
+
+		//Gets the dots and stars of a level's ghosts, the vectors are cleared first
+		//Reserve getGhostCount() dots and getGhostCount() * MAX_STARS stars up front and this never allocates
+		void collect( int level, std::vector<GhostSprite>& dots, std::vector<GhostSprite>& stars ) const;
+
+		//Gets how many runs were added
+		int getGhostCount() const;
+
+	private:
+		//One run and how far it has got
+		struct Ghost
+		{
+			int level;
+
+			//Where its moves sit in mMoves, and the next one to play
+			int first;
+			int count;
+			int next;
+
+			//Now and at the start of the current move
+			BoardState state;
+			BoardState previous;
+		};
+
+		//The board and each level's start
+		Board mBoard;
+		std::vector<BoardState> mStarts;
+
+		//The runs, with every run's moves packed one byte each into one buffer
+		std::vector<Ghost> mGhosts;
+		std::vector<unsigned char> mMoves;
+};
+
+#endif
@@ -0,0 +1,283 @@
+#include "heuristic.h"
+
+//Using limits
+#include <limits.h>
+
+//Larger than any reduced cost the matching can see
+const int MATCH_INFINITY = INT_MAX / 2;
+
+PushDistances::PushDistances()
+{
+	//Initialize
+	mCellCount = 0;
+	mGoalCount = 0;
+}
+
+void PushDistances::build( const Board& board, const int goals[], int goalCount )
+{
+	search( board, goals, goalCount, true );
+}
+
+void PushDistances::buildFrom( const Board& board, const int sources[], int sourceCount )
+{
+	search( board, sources, sourceCount, false );
+}
+
+void PushDistances::search( const Board& board, const int roots[], int rootCount, bool pulls )
+{
+	mCellCount = board.getCellCount();
+	mGoalCount = rootCount;
+	mDistances.assign( mCellCount * rootCount, PUSH_UNREACHABLE );
+
+	std::vector<int> queue( mCellCount );
+
+	for( int root = 0; root < rootCount; ++root )
+	{
+		unsigned short* distances = &mDistances[ root * mCellCount ];
+
+		//Pull the star away from the goal, or push it away from its source, one push at a time
+		int head = 0, tail = 0;
+		distances[ roots[ root ] ] = 0;
+		queue[ tail++ ] = roots[ root ];
+
+		while( head < tail )
+		{
+			int cell = queue[ head++ ];
+
+			for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+			{
+				//Pulled, the star came from behind and the dot stood behind that
+				//Pushed, the star goes ahead and the dot stands behind it
+				int next = board.step( cell, pulls ? oppositeMove( direction ) : direction );
+				if( next < 0 || board.isWall( next ) || distances[ next ] != PUSH_UNREACHABLE )
+				{
+					continue;
+				}
+
+				int pusher = pulls ? board.step( next, oppositeMove( direction ) ) : board.step( cell, oppositeMove( direction ) );
+				if( pusher < 0 || board.isWall( pusher ) )
+				{
+					continue;
+				}
+
+				distances[ next ] = distances[ cell ] + 1;
+				queue[ tail++ ] = next;
+			}
+		}
+	}
+}
+
+int PushDistances::getGoalCount() const
+{
+	return mGoalCount;
+}
+
+bool PushDistances::isDeadCell( int cell ) const
+{
+	for( int goal = 0; goal < mGoalCount; ++goal )
+	{
+		if( distance( goal, cell ) < PUSH_UNREACHABLE )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+AssignmentHeuristic::AssignmentHeuristic( const PushDistances& distances )
+{
+	//Initialize
+	mDistances = &distances;
+	mStarCount = 0;
+	mSize = 0;
+	mValue = 0;
+}
+
+int AssignmentHeuristic::reset( const int stars[], int starCount )
+{
+	mStarCount = starCount;
+	mSize = starCount > mDistances->getGoalCount() ? starCount : mDistances->getGoalCount();
+
+	//Spare goals are matched to free padding rows
+	for( int row = 1; row <= mSize; ++row )
+	{
+		if( row <= starCount )
+		{
+			mStars[ row - 1 ] = stars[ row - 1 ];
+		}
+
+		loadRow( row );
+	}
+
+	for( int i = 0; i <= mSize; ++i )
+	{
+		mRowPotential[ i ] = 0;
+		mColumnPotential[ i ] = 0;
+		mMatch[ i ] = 0;
+	}
+
+	//Add the rows one at a time
+	for( int row = 1; row <= mSize; ++row )
+	{
+		augment( row );
+	}
+
+	updateValue();
+	return mValue;
+}
+
+int AssignmentHeuristic::moveStar( int star, int cell )
+{
+	int row = star + 1;
+	mStars[ star ] = cell;
+	loadRow( row );
+
+	//Unmatch the star
+	for( int column = 1; column <= mSize; ++column )
+	{
+		if( mMatch[ column ] == row )
+		{
+			mMatch[ column ] = 0;
+		}
+	}
+
+	//Lower its potential until every reduced cost is non-negative again
+	int potential = MATCH_INFINITY;
+	for( int column = 1; column <= mSize; ++column )
+	{
+		int reduced = mCost[ row ][ column ] - mColumnPotential[ column ];
+		if( reduced < potential )
+		{
+			potential = reduced;
+		}
+	}
+	mRowPotential[ row ] = potential;
+
+	//The other rows stay optimal, so one augmenting path restores the matching
+	augment( row );
+
+	updateValue();
+	return mValue;
+}
+
+int AssignmentHeuristic::getValue() const
+{
+	return mValue;
+}
+
+int AssignmentHeuristic::getGoalFor( int star ) const
+{
+	for( int column = 1; column <= mSize; ++column )
+	{
+		if( mMatch[ column ] == star + 1 )
+		{
+			return column - 1;
+		}
+	}
+
+	return -1;
+}
+
+void AssignmentHeuristic::loadRow( int row )
+{
+	for( int column = 1; column <= mSize; ++column )
+	{
+		//Padding rows and columns cost nothing
+		if( row > mStarCount || column > mDistances->getGoalCount() )
+		{
+			mCost[ row ][ column ] = 0;
+		}
+		else
+		{
+			mCost[ row ][ column ] = mDistances->distance( column - 1, mStars[ row - 1 ] );
+		}
+	}
+}
+
+void AssignmentHeuristic::augment( int row )
+{
+	int slack[ MAX_STARS + 1 ];
+	bool used[ MAX_STARS + 1 ];
+
+	for( int column = 0; column <= mSize; ++column )
+	{
+		slack[ column ] = MATCH_INFINITY;
+		used[ column ] = false;
+	}
+
+	//Column 0 is the virtual start of the augmenting path
+	mMatch[ 0 ] = row;
+	int current = 0;
+
+	do
+	{
+		used[ current ] = true;
+		int currentRow = mMatch[ current ];
+		int delta = MATCH_INFINITY;
+		int next = 0;
+
+		for( int column = 1; column <= mSize; ++column )
+		{
+			if( !used[ column ] )
+			{
+				int reduced = mCost[ currentRow ][ column ] - mRowPotential[ currentRow ] - mColumnPotential[ column ];
+				if( reduced < slack[ column ] )
+				{
+					slack[ column ] = reduced;
+					mWay[ column ] = current;
+				}
+
+				if( slack[ column ] < delta )
+				{
+					delta = slack[ column ];
+					next = column;
+				}
+			}
+		}
+
+		for( int column = 0; column <= mSize; ++column )
+		{
+			if( used[ column ] )
+			{
+				mRowPotential[ mMatch[ column ] ] += delta;
+				mColumnPotential[ column ] -= delta;
+			}
+			else
+			{
+				slack[ column ] -= delta;
+			}
+		}
+
+		current = next;
+	}
+	while( mMatch[ current ] != 0 );
+
+	//Flip the matching along the path
+	do
+	{
+		int previous = mWay[ current ];
+		mMatch[ current ] = mMatch[ previous ];
+		current = previous;
+	}
+	while( current != 0 );
+}
+
+void AssignmentHeuristic::updateValue()
+{
+	mValue = 0;
+
+	for( int column = 1; column <= mSize; ++column )
+	{
+		int cost = mCost[ mMatch[ column ] ][ column ];
+
+		//A star matched to a goal it can never reach
+		if( cost >= PUSH_UNREACHABLE )
+		{
+			mValue = HEURISTIC_DEADLOCK;
+			return;
+		}
+
+		mValue += cost;
+	}
+}
@@ -0,0 +1,102 @@
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include "board.h"
+
+//Distance of a cell no push sequence brings to the goal
+const int PUSH_UNREACHABLE = 10000;
+
+//Heuristic value of a position that can never be solved
+const int HEURISTIC_DEADLOCK = 0x3FFFFFFF;
+
+//Fewest pushes from every cell to every goal of a level on an empty board
+class PushDistances
+{
+	public:
+		//Initializes an empty table
+		PushDistances();
+
+		//Runs a reverse push search from each goal
+		void build( const Board& board, const int goals[], int goalCount );
+
+		//Runs a forward push search from each source instead, goals then stand for the sources
+		//and distance( source, cell ) is the pushes that bring a star from the source to the cell
+		void buildFrom( const Board& board, const int sources[], int sourceCount );
+
+		//Gets the number of goals the table was built for
+		int getGoalCount() const;
+
+		//Gets the pushes a star on cell needs to reach a goal
+		int distance( int goal, int cell ) const
+		{
+			return mDistances[ goal * mCellCount + cell ];
+		}
+
+		//Checks whether a star on cell can never reach any goal
+		bool isDeadCell( int cell ) const;
+
+	private:
+		//Fills the table with a breadth-first search out of each root, by pulls or by pushes
+		void search( const Board& board, const int roots[], int rootCount, bool pulls );
+
+		//The table dimensions
+		int mCellCount;
+		int mGoalCount;
+
+		//One row of cell distances per goal
+		std::vector<unsigned short> mDistances;
+};
+
+//Minimum-cost star to goal matching over push distances
+class AssignmentHeuristic
+{
+	public:
+		//Initializes the matching against a distance table
+		AssignmentHeuristic( const PushDistances& distances );
+
+		//Solves the matching from scratch, returns the heuristic value
+		int reset( const int stars[], int starCount );
+
+		//Moves one star and repairs the matching with a single augmentation
+		int moveStar( int star, int cell );
+
+		//Gets the current heuristic value
+		int getValue() const;
+
+		//Gets the goal index matched to a star
+		int getGoalFor( int star ) const;
+
+	private:
+		//Re-reads the cost row of a star from the distance table
+		void loadRow( int row );
+
+		//Finds an augmenting path for an unmatched row
+		void augment( int row );
+
+		//Sums the matched costs
+		void updateValue();
+
+		//The distance table
+		const PushDistances* mDistances;
+
+		//The current star cells and matrix size
+		int mStars[ MAX_STARS ];
+		int mStarCount;
+		int mSize;
+
+		//The cost matrix, 1-based with padding rows for spare goals
+		int mCost[ MAX_STARS + 1 ][ MAX_STARS + 1 ];
+
+		//Row and column potentials
+		int mRowPotential[ MAX_STARS + 1 ];
+		int mColumnPotential[ MAX_STARS + 1 ];
+
+		//The row matched to each column and the augmenting path links
+		int mMatch[ MAX_STARS + 1 ];
+		int mWay[ MAX_STARS + 1 ];
+
+		//The heuristic value
+		int mValue;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include "hintEngine.h"
+#include "solver.h"
+
+//Using timers
+#include <chrono>
+
+//How long the idle worker sleeps before looking at its queue again
+const int HINT_IDLE_MS = 5;
+
+HintEngine::HintEngine() : mGeneration( 0 ), mAnswered( 0 ), mQuit( false )
+{
+	//Initialize
+	mBoard = NULL;
+	mLevels = NULL;
+	mLevelCount = 0;
+	mRequested = 0;
+}
+
+HintEngine::~HintEngine()
+{
+	//Deallocate
+	stop();
+}
+
+bool HintEngine::start( const Board& board, const LevelInfo levels[], int levelCount )
+{
+	stop();
+
+	mBoard = &board;
+	mLevels = levels;
+	mLevelCount = levelCount;
+
+	//The pattern database is optional, hints just search longer without it
+	mDatabase.open( PATTERN_DB_PATH, board, levels, levelCount );
+
+	mQuit = false;
+	mThread = std::thread( &HintEngine::run, this );
+	return true;
+}
+
+void HintEngine::stop()
+{
+	if( mThread.joinable() )
+	{
+		mQuit = true;
+		++mGeneration;
+		mWake.notify_one();
+		mThread.join();
+	}
+
+	mDatabase.close();
+}
+
+void HintEngine::request( int level, const BoardState& state )
+{
+	HintRequest request;
+	request.generation = mGeneration.load() + 1;
+	request.level = level;
+	request.state = state;
+	request.requestTime = now();
+
+	//A full queue means the worker is behind, it only answers the newest request anyway
+	//The generation moves on only once the request is in, so a dropped one leaves the running search alone
+	if( mRequests.push( request ) )
+	{
+		mGeneration = request.generation;
+		mRequested = request.generation;
+		mWake.notify_one();
+	}
+}
+
+void HintEngine::cancel()
+{
+	++mGeneration;
+}
+
+bool HintEngine::poll( HintResult& result )
+{
+	bool found = false;
+	HintResult next;
+
+	//Drop answers to requests that were replaced or cancelled
+	while( mResults.pop( next ) )
+	{
+		if( next.generation == mGeneration.load() )
+		{
+			result = next;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+bool HintEngine::isBusy() const
+{
+	return mRequested == mGeneration.load() && mAnswered.load() != mRequested;
+}
+
+void HintEngine::run()
+{
+	while( !mQuit )
+	{
+		//Only the newest request matters
+		HintRequest request;
+		bool pending = false;
+		while( mRequests.pop( request ) )
+		{
+			pending = true;
+		}
+
+		if( !pending )
+		{
+			std::unique_lock<std::mutex> lock( mWakeMutex );
+			mWake.wait_for( lock, std::chrono::milliseconds( HINT_IDLE_MS ) );
+			continue;
+		}
+
+		//Requests older than the generation were replaced or cancelled, the newest may be popped before its bump lands
+		if( request.generation < mGeneration.load() || request.level < 0 || request.level >= mLevelCount )
+		{
+			continue;
+		}
+
+		int goals[ MAX_STARS ];
+		int goalCount = levelGoalCells( *mBoard, mLevels[ request.level ], goals );
+
+		//Give up as soon as the player moves on
+		Solver solver( *mBoard, goals, goalCount );
+		solver.setPatternDatabase( &mDatabase, request.level );
+		solver.setCancelCheck( [ & ]()
+		{
+			return mQuit || request.generation < mGeneration.load();
+		} );
+
+		std::vector<int> moves;
+		bool solved = solver.solve( request.state, moves );
+		if( request.generation < mGeneration.load() )
+		{
+			continue;
+		}
+
+		HintResult result;
+		result.generation = request.generation;
+		result.move = solved && !moves.empty() ? moves[ 0 ] : MOVE_NONE;
+		result.movesLeft = solved ? (int)moves.size() : -1;
+		result.latencyMs = now() - request.requestTime;
+		result.expandedNodes = solver.getExpandedNodes();
+
+		mResults.push( result );
+		mAnswered = request.generation;
+	}
+}
+
+double HintEngine::now()
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
@@ -0,0 +1,101 @@
+#ifndef HINT_ENGINE_H
+#define HINT_ENGINE_H
+
+#include "board.h"
+#include "levels.h"
+#include "patternDb.h"
+#include "spscQueue.h"
+
+//Using threads, atomics and condition variables
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//A position the player wants a hint for
+struct HintRequest
+{
+	int generation;
+	int level;
+	BoardState state;
+	double requestTime;
+};
+
+//The answer to a hint request
+struct HintResult
+{
+	int generation;
+
+	//The move to make next, MOVE_NONE if the position can't be solved
+	int move;
+
+	//Moves left on the best solution
+	int movesLeft;
+
+	//How long the answer took and how many nodes it searched
+	double latencyMs;
+	int expandedNodes;
+};
+
+//Searches for hints on a worker thread so the frame loop never waits
+class HintEngine
+{
+	public:
+		//Initializes variables
+		HintEngine();
+
+		//Stops the worker
+		~HintEngine();
+
+		//Starts the worker for the given board and levels
+		bool start( const Board& board, const LevelInfo levels[], int levelCount );
+
+		//Stops the worker, abandoning any search
+		void stop();
+
+		//Asks for the next move from a position, replacing any request in flight
+		void request( int level, const BoardState& state );
+
+		//Abandons the search in flight, if any
+		void cancel();
+
+		//Takes a finished hint for the latest request, never waits
+		bool poll( HintResult& result );
+
+		//Checks whether a request is still being searched
+		bool isBusy() const;
+
+	private:
+		//The worker thread body
+		void run();
+
+		//Gets a timestamp in milliseconds
+		static double now();
+
+		//The level data the worker searches on
+		const Board* mBoard;
+		const LevelInfo* mLevels;
+		int mLevelCount;
+		PatternDatabase mDatabase;
+
+		//Requests to the worker and results back
+		SpscQueue<HintRequest, 8> mRequests;
+		SpscQueue<HintResult, 8> mResults;
+
+		//Bumped on every queued request and cancel, searches older than it are stale
+		std::atomic<int> mGeneration;
+
+		//The generation of the last result posted
+		std::atomic<int> mAnswered;
+
+		//The generation of the last request, only touched by the frame loop
+		int mRequested;
+
+		//Wakes the worker, which only sleeps while its queue is empty
+		std::mutex mWakeMutex;
+		std::condition_variable mWake;
+		std::atomic<bool> mQuit;
+		std::thread mThread;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "levelGenerator.h"
+#include "solver.h"
+
+//Using random numbers
+#include <random>
+
+//Picks a random floor cell clear of the dot and stars, or -1 after too many misses
+static int randomFloor( const Board& board, std::mt19937& random, const BoardState& avoid )
+{
+	std::uniform_int_distribution<int> cells( 0, board.getCellCount() - 1 );
+	for( int tries = 0; tries < 1000; ++tries )
+	{
+		int cell = cells( random );
+		if( !board.isWall( cell ) && avoid.player != cell && findStar( avoid, cell ) < 0 )
+		{
+			return cell;
+		}
+	}
+
+	return -1;
+}
+
+//Checks that every floor cell can reach every other one
+static bool floorConnected( const Board& board )
+{
+	std::vector<char> seen( board.getCellCount(), 0 );
+	std::vector<int> queue;
+	int floorCount = 0;
+
+	for( int i = 0; i < board.getCellCount(); ++i )
+	{
+		if( !board.isWall( i ) )
+		{
+			if( queue.empty() )
+			{
+				queue.push_back( i );
+				seen[ i ] = 1;
+			}
+			++floorCount;
+		}
+	}
+
+	for( size_t head = 0; head < queue.size(); ++head )
+	{
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int next = board.step( queue[ head ], direction );
+			if( !board.isWall( next ) && !seen[ next ] )
+			{
+				seen[ next ] = 1;
+				queue.push_back( next );
+			}
+		}
+	}
+
+	return (int)queue.size() == floorCount;
+}
+
+//Walks the dot around at random, pulling stars behind it, the reverse of pushing them
+static void scramble( const Board& board, std::mt19937& random, int steps, BoardState& state )
+{
+	std::uniform_int_distribution<int> directions( MOVE_UP, MOVE_RIGHT );
+	std::bernoulli_distribution pull( 0.5 );
+
+	for( int i = 0; i < steps; ++i )
+	{
+		int direction = directions( random );
+		int next = board.step( state.player, direction );
+		if( board.isWall( next ) || findStar( state, next ) >= 0 )
+		{
+			continue;
+		}
+
+		//Pull the star on the far side of the dot along with it
+		int behind = findStar( state, board.step( state.player, oppositeMove( direction ) ) );
+		if( behind >= 0 && pull( random ) )
+		{
+			state.stars[ behind ] = state.player;
+			sortStars( state );
+		}
+
+		state.player = next;
+	}
+}
+
+GeneratorResult generateLevel( const GeneratorSettings& settings, unsigned int seed, PackLevel& level )
+{
+	std::mt19937 random( seed );
+
+	//Wall the border like the rooms of levelOne.map and scatter wall blocks inside
+	level.columns = settings.columns;
+	level.rows = settings.rows;
+	level.types.assign( settings.columns * settings.rows, TILE_GREEN );
+	for( int y = 0; y < settings.rows; ++y )
+	{
+		for( int x = 0; x < settings.columns; ++x )
+		{
+			if( x == 0 || y == 0 || x == settings.columns - 1 || y == settings.rows - 1 )
+			{
+				level.types[ y * settings.columns + x ] = TILE_RED;
+			}
+		}
+	}
+
+	std::uniform_int_distribution<int> columns( 1, settings.columns - 2 );
+	std::uniform_int_distribution<int> rows( 1, settings.rows - 2 );
+	for( int i = 0; i < settings.wallCount; ++i )
+	{
+		level.types[ rows( random ) * settings.columns + columns( random ) ] = TILE_TOPLEFT;
+	}
+
+	Board board;
+	packLevelBoard( level, board );
+	if( !floorConnected( board ) )
+	{
+		return REJECTED_LAYOUT;
+	}
+
+	//Start solved, with every star on a goal
+	BoardState state;
+	state.player = -1;
+	state.starCount = 0;
+	for( int i = 0; i < settings.starCount; ++i )
+	{
+		int cell = randomFloor( board, random, state );
+		if( cell < 0 )
+		{
+			return REJECTED_LAYOUT;
+		}
+
+		state.stars[ state.starCount++ ] = cell;
+		level.goals[ i ] = cell;
+	}
+	level.goalCount = settings.starCount;
+	sortStars( state );
+
+	state.player = randomFloor( board, random, state );
+	if( state.player < 0 )
+	{
+		return REJECTED_LAYOUT;
+	}
+
+	//Anything reached by pulling can be solved by pushing
+	scramble( board, random, settings.scrambleSteps, state );
+	level.start = state;
+	if( isSolved( state, level.goals, level.goalCount ) )
+	{
+		return REJECTED_TOO_EASY;
+	}
+
+	//Score it by its optimal solution
+	Solver solver( board, level.goals, level.goalCount );
+	solver.setNodeLimit( settings.nodeLimit );
+
+	std::vector<int> moves;
+	if( !solver.solve( state, moves ) )
+	{
+		return REJECTED_UNSOLVED;
+	}
+
+	level.solutionMoves = (int)moves.size();
+	level.solutionPushes = 0;
+	for( size_t i = 0; i < moves.size(); ++i )
+	{
+		bool pushed = false;
+		board.applyMove( state, moves[ i ], &pushed );
+		level.solutionPushes += pushed ? 1 : 0;
+	}
+
+	return level.solutionMoves >= settings.minMoves ? GENERATED : REJECTED_TOO_EASY;
+}
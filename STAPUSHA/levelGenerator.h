@@ -0,0 +1,44 @@
+#ifndef LEVEL_GENERATOR_H
+#define LEVEL_GENERATOR_H
+
+#include "levelPack.h"
+
+//The shape and difficulty of the levels to generate
+struct GeneratorSettings
+{
+	//The grid, walls included, in the same 9 column layout as levelOne.map
+	int columns;
+	int rows;
+
+	//How many stars and inner wall tiles to place
+	int starCount;
+	int wallCount;
+
+	//How many random steps to scramble the stars off their goals with
+	int scrambleSteps;
+
+	//The shortest solution a level may have to be kept
+	int minMoves;
+
+	//How many nodes verifying a candidate may search
+	int nodeLimit;
+
+	GeneratorSettings() : columns( BOARD_COLUMNS ), rows( 10 ), starCount( 2 ), wallCount( 6 ), scrambleSteps( 400 ), minMoves( 12 ), nodeLimit( 200000 )
+	{
+	}
+};
+
+//Why a candidate was thrown away
+enum GeneratorResult
+{
+	GENERATED,
+	REJECTED_LAYOUT,
+	REJECTED_UNSOLVED,
+	REJECTED_TOO_EASY
+};
+
+//Builds one candidate from a seed and verifies it with the solver
+//The same settings and seed always give the same level
+GeneratorResult generateLevel( const GeneratorSettings& settings, unsigned int seed, PackLevel& level );
+
+#endif
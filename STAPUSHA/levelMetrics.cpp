@@ -0,0 +1,196 @@
+#include "levelMetrics.h"
+#include "heuristic.h"
+#include "solver.h"
+
+//Using hash maps
+#include <unordered_map>
+
+//Kept to this file, pathFinder.cpp has a PushNode of its own
+namespace
+{
+
+//A position the push search reached, how deep and by how many shortest push sequences
+struct PushNode
+{
+	BoardState state;
+	int depth;
+	long long paths;
+};
+
+}
+
+//Marks the cells the dot walks to without pushing, returns the smallest to name the region by
+static int floodRegion( const Board& board, const BoardState& state, std::vector<unsigned char>& reached, std::vector<int>& queue )
+{
+	reached.assign( board.getCellCount(), 0 );
+
+	int head = 0, tail = 0;
+	int smallest = state.player;
+	reached[ state.player ] = 1;
+	queue[ tail++ ] = state.player;
+
+	while( head < tail )
+	{
+		int cell = queue[ head++ ];
+		smallest = cell < smallest ? cell : smallest;
+
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int next = board.step( cell, direction );
+			if( next < 0 || reached[ next ] || board.isWall( next ) || findStar( state, next ) >= 0 )
+			{
+				continue;
+			}
+
+			reached[ next ] = 1;
+			queue[ tail++ ] = next;
+		}
+	}
+
+	return smallest;
+}
+
+//Adds to a path count without going past the cap
+static long long addPaths( long long paths, long long more, long long cap )
+{
+	return paths + more > cap ? cap : paths + more;
+}
+
+void analyzeLevel( const Board& board, const BoardState& start, const int goals[], int goalCount, const MetricSettings& settings, LevelMetrics& metrics )
+{
+	std::vector<unsigned char> reached, childReached;
+	std::vector<int> queue( board.getCellCount() );
+
+	PushDistances distances;
+	distances.build( board, goals, goalCount );
+
+	//Count the floor the dot can ever stand on, and the cells of it no star comes back from
+	BoardState empty;
+	empty.player = start.player;
+	empty.starCount = 0;
+	floodRegion( board, empty, reached, queue );
+	metrics.floorSquares = 0;
+	metrics.deadSquares = 0;
+	for( int cell = 0; cell < board.getCellCount(); ++cell )
+	{
+		if( reached[ cell ] )
+		{
+			++metrics.floorSquares;
+			metrics.deadSquares += distances.isDeadCell( cell );
+		}
+	}
+
+	//The move-optimal solution
+	Solver solver( board, goals, goalCount );
+	solver.setNodeLimit( settings.nodeLimit );
+	std::vector<int> moves;
+	metrics.optimalMoves = -1;
+	metrics.pushesInOptimalMoves = -1;
+	if( solver.solve( start, moves ) )
+	{
+		BoardState state = start;
+		metrics.optimalMoves = (int)moves.size();
+		metrics.pushesInOptimalMoves = 0;
+		for( size_t i = 0; i < moves.size(); ++i )
+		{
+			bool pushed = false;
+			board.applyMove( state, moves[ i ], &pushed );
+			metrics.pushesInOptimalMoves += pushed;
+		}
+	}
+	metrics.moveNodes = solver.getExpandedNodes();
+
+	//Breadth first over pushes, with the dot reduced to the region it can walk around in
+	metrics.optimalPushes = -1;
+	metrics.optimalSolutions = -1;
+	metrics.branchingFactor = 0.0;
+	metrics.pushNodes = 0;
+	if( isSolved( start, goals, goalCount ) )
+	{
+		metrics.optimalPushes = 0;
+		metrics.optimalSolutions = 1;
+		return;
+	}
+
+	std::vector<PushNode> nodes;
+	std::unordered_map<BoardState, int, BoardStateHash, BoardStateEqual> seen;
+
+	PushNode root;
+	root.state = start;
+	root.state.player = floodRegion( board, start, reached, queue );
+	root.depth = 0;
+	root.paths = 1;
+	nodes.push_back( root );
+	seen[ root.state ] = 0;
+
+	int solvedDepth = -1;
+	long long solutions = 0;
+	long long pushes = 0;
+	bool stopped = false;
+	for( size_t i = 0; i < nodes.size(); ++i )
+	{
+		PushNode node = nodes[ i ];
+
+		//Every solution as short as the first one comes from the layer before it
+		if( solvedDepth >= 0 && node.depth >= solvedDepth )
+		{
+			break;
+		}
+
+		if( ++metrics.pushNodes > settings.nodeLimit )
+		{
+			stopped = true;
+			break;
+		}
+
+		floodRegion( board, node.state, reached, queue );
+		for( int star = 0; star < node.state.starCount; ++star )
+		{
+			int cell = node.state.stars[ star ];
+			for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+			{
+				//The dot has to get behind the star, and the star can't be shoved somewhere it's stuck
+				int behind = board.step( cell, oppositeMove( direction ) );
+				int to = board.step( cell, direction );
+				if( behind < 0 || !reached[ behind ] || to < 0 || board.isWall( to ) || findStar( node.state, to ) >= 0 || distances.isDeadCell( to ) )
+				{
+					continue;
+				}
+
+				++pushes;
+				PushNode child;
+				child.state = node.state;
+				child.state.player = behind;
+				board.applyMove( child.state, direction );
+				child.depth = node.depth + 1;
+				child.paths = node.paths;
+
+				if( isSolved( child.state, goals, goalCount ) )
+				{
+					solvedDepth = child.depth;
+					solutions = addPaths( solutions, node.paths, settings.solutionCap );
+					continue;
+				}
+
+				child.state.player = floodRegion( board, child.state, childReached, queue );
+				std::unordered_map<BoardState, int, BoardStateHash, BoardStateEqual>::iterator found = seen.find( child.state );
+				if( found == seen.end() )
+				{
+					seen[ child.state ] = (int)nodes.size();
+					nodes.push_back( child );
+				}
+				else if( nodes[ found->second ].depth == child.depth )
+				{
+					nodes[ found->second ].paths = addPaths( nodes[ found->second ].paths, node.paths, settings.solutionCap );
+				}
+			}
+		}
+	}
+
+	metrics.branchingFactor = metrics.pushNodes > 0 ? (double)pushes / metrics.pushNodes : 0.0;
+	if( !stopped && solvedDepth >= 0 )
+	{
+		metrics.optimalPushes = solvedDepth;
+		metrics.optimalSolutions = solutions;
+	}
+}
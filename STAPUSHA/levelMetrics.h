@@ -0,0 +1,48 @@
+#ifndef LEVEL_METRICS_H
+#define LEVEL_METRICS_H
+
+#include "board.h"
+
+//How far the analysis may search
+struct MetricSettings
+{
+	//How many nodes the move-optimal solve and the push search may each expand
+	int nodeLimit;
+
+	//Counting push-optimal solutions stops here
+	long long solutionCap;
+
+	MetricSettings() : nodeLimit( 2000000 ), solutionCap( 1000000 )
+	{
+	}
+};
+
+//Difficulty and quality measures of one level, -1 where a search gave up
+struct LevelMetrics
+{
+	//The fewest moves and, separately, the fewest pushes that solve the level
+	int optimalMoves;
+	int optimalPushes;
+
+	//How many pushes the move-optimal solution makes
+	int pushesInOptimalMoves;
+
+	//The average number of pushes open to the dot that don't strand a star, over the positions the push search expanded
+	double branchingFactor;
+
+	//Floor cells the dot can reach and those a star could never be pushed to a goal from
+	int floorSquares;
+	int deadSquares;
+
+	//Distinct push sequences of optimalPushes pushes that solve the level, capped at MetricSettings::solutionCap
+	long long optimalSolutions;
+
+	//Nodes the searches expanded
+	int moveNodes;
+	int pushNodes;
+};
+
+//Measures a level from its wall grid, start and goals
+void analyzeLevel( const Board& board, const BoardState& start, const int goals[], int goalCount, const MetricSettings& settings, LevelMetrics& metrics );
+
+#endif
@@ -0,0 +1,151 @@
+#include "levelPack.h"
+
+//Using standard IO and file streams
+#include <stdio.h>
+#include <fstream>
+
+//The pack file starts with this word and version, then the level count
+//Each level is a line "level <columns> <rows> <moves> <pushes>", a "dot <cell>" line,
+//"stars <count> <cells...>" and "goals <count> <cells...>" lines and then its rows of
+//tile types in the same two digit format as levelOne.map
+const char LEVEL_PACK_MAGIC[] = "STARPACK";
+const int LEVEL_PACK_VERSION = 1;
+
+void packLevelBoard( const PackLevel& level, Board& board )
+{
+	board.loadFromTypes( &level.types[ 0 ], level.columns, level.rows );
+}
+
+bool saveLevelPack( const std::string& path, const std::vector<PackLevel>& levels )
+{
+	FILE* file = fopen( path.c_str(), "w" );
+	if( file == NULL )
+	{
+		printf( "Unable to write level pack %s!\n", path.c_str() );
+		return false;
+	}
+
+	fprintf( file, "%s %d\n%d\n", LEVEL_PACK_MAGIC, LEVEL_PACK_VERSION, (int)levels.size() );
+	for( size_t i = 0; i < levels.size(); ++i )
+	{
+		const PackLevel& level = levels[ i ];
+		fprintf( file, "\nlevel %d %d %d %d\n", level.columns, level.rows, level.solutionMoves, level.solutionPushes );
+		fprintf( file, "dot %d\n", level.start.player );
+
+		fprintf( file, "stars %d", level.start.starCount );
+		for( int j = 0; j < level.start.starCount; ++j )
+		{
+			fprintf( file, " %d", level.start.stars[ j ] );
+		}
+
+		fprintf( file, "\ngoals %d", level.goalCount );
+		for( int j = 0; j < level.goalCount; ++j )
+		{
+			fprintf( file, " %d", level.goals[ j ] );
+		}
+		fprintf( file, "\n" );
+
+		for( int y = 0; y < level.rows; ++y )
+		{
+			for( int x = 0; x < level.columns; ++x )
+			{
+				fprintf( file, x == 0 ? "%02d" : " %02d", level.types[ y * level.columns + x ] );
+			}
+			fprintf( file, "\n" );
+		}
+	}
+
+	bool written = !ferror( file );
+	if( fclose( file ) != 0 || !written )
+	{
+		printf( "Error writing level pack %s!\n", path.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+//Reads a "<word> <count> <cells...>" line, checking the word and that the cells are on the grid
+static bool readCells( std::ifstream& pack, const char* word, int cellCount, int& count, int cells[] )
+{
+	std::string label;
+	pack >> label >> count;
+	if( pack.fail() || label != word || count < 0 || count > MAX_STARS )
+	{
+		return false;
+	}
+
+	for( int i = 0; i < count; ++i )
+	{
+		pack >> cells[ i ];
+		if( pack.fail() || cells[ i ] < 0 || cells[ i ] >= cellCount )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool loadLevelPack( const std::string& path, std::vector<PackLevel>& levels )
+{
+	levels.clear();
+
+	std::ifstream pack( path.c_str() );
+	if( pack.fail() )
+	{
+		printf( "Unable to load level pack %s!\n", path.c_str() );
+		return false;
+	}
+
+	std::string magic;
+	int version = 0, levelCount = 0;
+	pack >> magic >> version >> levelCount;
+	if( pack.fail() || magic != LEVEL_PACK_MAGIC || version != LEVEL_PACK_VERSION || levelCount < 0 )
+	{
+		printf( "%s is not a version %d level pack!\n", path.c_str(), LEVEL_PACK_VERSION );
+		return false;
+	}
+
+	for( int i = 0; i < levelCount; ++i )
+	{
+		PackLevel level;
+		std::string label;
+		pack >> label >> level.columns >> level.rows >> level.solutionMoves >> level.solutionPushes;
+		if( pack.fail() || label != "level" || level.columns <= 0 || level.rows <= 0 )
+		{
+			printf( "Error loading level pack: Bad header on level %d!\n", i );
+			return false;
+		}
+
+		int cellCount = level.columns * level.rows;
+		pack >> label >> level.start.player;
+		if( pack.fail() || label != "dot" || level.start.player < 0 || level.start.player >= cellCount )
+		{
+			printf( "Error loading level pack: Bad dot on level %d!\n", i );
+			return false;
+		}
+
+		if( !readCells( pack, "stars", cellCount, level.start.starCount, level.start.stars ) || !readCells( pack, "goals", cellCount, level.goalCount, level.goals ) )
+		{
+			printf( "Error loading level pack: Bad stars or goals on level %d!\n", i );
+			return false;
+		}
+
+		level.types.resize( cellCount );
+		for( int j = 0; j < cellCount; ++j )
+		{
+			pack >> level.types[ j ];
+			if( pack.fail() || level.types[ j ] < 0 || level.types[ j ] >= TOTAL_TILE_SPRITES )
+			{
+				printf( "Error loading level pack: Invalid tile type at %d on level %d!\n", j, i );
+				return false;
+			}
+		}
+
+		sortStars( level.start );
+		levels.push_back( level );
+	}
+
+	return true;
+}
@@ -0,0 +1,39 @@
+#ifndef LEVEL_PACK_H
+#define LEVEL_PACK_H
+
+#include "board.h"
+
+//Using strings and vectors
+#include <string>
+#include <vector>
+
+//A self-contained level, walls and all, as stored in a level pack
+struct PackLevel
+{
+	//The grid dimensions and row-major tile types
+	int columns;
+	int rows;
+	std::vector<int> types;
+
+	//The dot and star cells the level starts from
+	BoardState start;
+
+	//The goal cells
+	int goalCount;
+	int goals[ MAX_STARS ];
+
+	//The length of the best known solution, 0 if none is known
+	int solutionMoves;
+	int solutionPushes;
+};
+
+//Builds the wall grid of a pack level
+void packLevelBoard( const PackLevel& level, Board& board );
+
+//Writes levels to a pack file, returns false if it couldn't be written
+bool saveLevelPack( const std::string& path, const std::vector<PackLevel>& levels );
+
+//Reads every level of a pack file, returns false if it's missing or malformed
+bool loadLevelPack( const std::string& path, std::vector<PackLevel>& levels );
+
+#endif
@@ -0,0 +1,39 @@
+#include "levels.h"
+
+const LevelInfo gLevels[ TOTAL_LEVELS ] =
+{
+	//Level 1
+	{ { 97, 67 }, 2, { { 172, 235 }, { 172, 123 } }, 2, { { 150, 168 }, { 150, 336 } } },
+
+	//Level 2
+	{ { 172, 1019 }, 2, { { 322, 1019 }, { 322, 963 } }, 2, { { 375, 1680 }, { 375, 1736 } } },
+
+	//Level 3
+	{ { 172, 2083 }, 1, { { 172, 2139 } }, 1, { { 450, 2520 } } },
+
+	//Level 4
+	{ { 322, 2867 }, 3, { { 322, 2979 }, { 247, 2923 }, { 397, 2923 } }, 3, { { 75, 2912 }, { 525, 2912 }, { 300, 3248 } } },
+
+	//Level 5
+	{ { 97, 3595 }, 2, { { 322, 3539 }, { 547, 3707 } }, 2, { { 300, 3472 }, { 525, 3976 } } }
+};
+
+int levelStarCells( const Board& board, const LevelInfo& level, int cells[] )
+{
+	for( int i = 0; i < level.starCount; ++i )
+	{
+		cells[ i ] = board.cellFromEntity( level.stars[ i ].x, level.stars[ i ].y );
+	}
+
+	return level.starCount;
+}
+
+int levelGoalCells( const Board& board, const LevelInfo& level, int cells[] )
+{
+	for( int i = 0; i < level.goalCount; ++i )
+	{
+		cells[ i ] = board.cellFromGoal( level.goals[ i ].x, level.goals[ i ].y );
+	}
+
+	return level.goalCount;
+}
@@ -0,0 +1,36 @@
+#ifndef LEVELS_H
+#define LEVELS_H
+
+#include "board.h"
+
+//A pixel position on the level
+struct LevelPoint
+{
+	int x;
+	int y;
+};
+
+//Where a level places its dot, stars and goals
+struct LevelInfo
+{
+	//The dot start position
+	LevelPoint dot;
+
+	//The star start positions
+	int starCount;
+	LevelPoint stars[ MAX_STARS ];
+
+	//The goal positions
+	int goalCount;
+	LevelPoint goals[ MAX_STARS ];
+};
+
+//The levels shipped in levelOne.map
+const int TOTAL_LEVELS = 5;
+extern const LevelInfo gLevels[ TOTAL_LEVELS ];
+
+//Converts a level's star and goal positions to board cells, returns the count
+int levelStarCells( const Board& board, const LevelInfo& level, int cells[] );
+int levelGoalCells( const Board& board, const LevelInfo& level, int cells[] );
+
+#endif
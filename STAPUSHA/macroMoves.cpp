@@ -0,0 +1,352 @@
+#include "macroMoves.h"
+
+//Using sorting
+#include <algorithm>
+
+MacroMoves::MacroMoves()
+{
+	//Initialize
+	mBoard = NULL;
+	mTunnelCells = 0;
+}
+
+void MacroMoves::build( const Board& board, const BoardState& start, const int goals[], int goalCount )
+{
+	mBoard = &board;
+	int cellCount = board.getCellCount();
+
+	mGoalCells.assign( cellCount, 0 );
+	for( int i = 0; i < goalCount; ++i )
+	{
+		mGoalCells[ goals[ i ] ] = 1;
+	}
+
+	std::vector<unsigned char> starCells( cellCount, 0 );
+	for( int i = 0; i < start.starCount; ++i )
+	{
+		starCells[ start.stars[ i ] ] = 1;
+	}
+
+	//The floor the dot can ever reach, stars aside
+	std::vector<int> region;
+	std::vector<unsigned char> inRegion( cellCount, 0 );
+	region.push_back( start.player );
+	inRegion[ start.player ] = 1;
+	for( size_t i = 0; i < region.size(); ++i )
+	{
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int next = board.step( region[ i ], direction );
+			if( next >= 0 && !board.isWall( next ) && !inRegion[ next ] )
+			{
+				inRegion[ next ] = 1;
+				region.push_back( next );
+			}
+		}
+	}
+
+	//Tunnels are floor with walls on both sides, off the board counts as wall
+	mTunnels.assign( cellCount, 0 );
+	mTunnelCells = 0;
+	for( size_t i = 0; i < region.size(); ++i )
+	{
+		int cell = region[ i ];
+		if( board.isWall( board.step( cell, MOVE_LEFT ) ) && board.isWall( board.step( cell, MOVE_RIGHT ) ) )
+		{
+			mTunnels[ cell ] |= TUNNEL_VERTICAL;
+		}
+		if( board.isWall( board.step( cell, MOVE_UP ) ) && board.isWall( board.step( cell, MOVE_DOWN ) ) )
+		{
+			mTunnels[ cell ] |= TUNNEL_HORIZONTAL;
+		}
+		mTunnelCells += mTunnels[ cell ] != 0;
+	}
+
+	//Try every floor cell as an entrance, the parts cut off behind it are rooms if they're small and hold only goals
+	mRooms.clear();
+	mRoomAt.assign( cellCount, -1 );
+	std::vector<int> stamps( cellCount, -1 );
+	std::vector<int> component;
+	int stamp = 0;
+	for( size_t i = 0; i < region.size(); ++i )
+	{
+		int entrance = region[ i ];
+		if( mGoalCells[ entrance ] )
+		{
+			continue;
+		}
+
+		GoalRoom room;
+		stamps[ entrance ] = ++stamp;
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int first = board.step( entrance, direction );
+			if( first < 0 || board.isWall( first ) || stamps[ first ] == stamp )
+			{
+				continue;
+			}
+
+			//Flood behind the entrance, giving up once it's too big for a room
+			bool usable = true;
+			int roomGoals = 0;
+			component.clear();
+			component.push_back( first );
+			stamps[ first ] = stamp;
+			for( size_t j = 0; j < component.size(); ++j )
+			{
+				int cell = component[ j ];
+				roomGoals += mGoalCells[ cell ];
+				if( starCells[ cell ] || cell == start.player || (int)component.size() > MAX_ROOM_CELLS )
+				{
+					usable = false;
+				}
+
+				for( int step = MOVE_UP; step <= MOVE_RIGHT; ++step )
+				{
+					int next = board.step( cell, step );
+					if( next >= 0 && !board.isWall( next ) && stamps[ next ] != stamp )
+					{
+						stamps[ next ] = stamp;
+						component.push_back( next );
+					}
+				}
+			}
+
+			if( usable && roomGoals > 0 && component.size() > room.cells.size() )
+			{
+				room.cells = component;
+			}
+		}
+
+		if( room.cells.empty() )
+		{
+			continue;
+		}
+
+		//Pack the goals furthest from the entrance first so the near ones don't block them
+		room.entrance = entrance;
+		std::vector<int> depths( room.cells.size(), -1 );
+		std::vector<int> queue( 1, entrance );
+		std::vector<int> queueDepths( 1, 0 );
+		for( size_t j = 0; j < queue.size(); ++j )
+		{
+			for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+			{
+				int next = board.step( queue[ j ], direction );
+				std::vector<int>::iterator found = std::find( room.cells.begin(), room.cells.end(), next );
+				if( next >= 0 && found != room.cells.end() && depths[ found - room.cells.begin() ] < 0 )
+				{
+					depths[ found - room.cells.begin() ] = queueDepths[ j ] + 1;
+					queue.push_back( next );
+					queueDepths.push_back( queueDepths[ j ] + 1 );
+				}
+			}
+		}
+
+		std::vector<std::pair<int, int> > deepest;
+		for( size_t j = 0; j < room.cells.size(); ++j )
+		{
+			if( mGoalCells[ room.cells[ j ] ] )
+			{
+				deepest.push_back( std::make_pair( -depths[ j ], room.cells[ j ] ) );
+			}
+		}
+		std::sort( deepest.begin(), deepest.end() );
+		for( size_t j = 0; j < deepest.size(); ++j )
+		{
+			room.goals.push_back( deepest[ j ].second );
+		}
+
+		//The dot packs from the room, the entrance and whatever floor it pushed in from
+		room.area = room.cells;
+		room.area.push_back( entrance );
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int outside = board.step( entrance, direction );
+			if( outside >= 0 && !board.isWall( outside ) && !inRoom( room, outside ) )
+			{
+				room.area.push_back( outside );
+			}
+		}
+
+		room.index.assign( cellCount, -1 );
+		for( size_t j = 0; j < room.area.size(); ++j )
+		{
+			room.index[ room.area[ j ] ] = (signed char)j;
+		}
+
+		mRoomAt[ entrance ] = (int)mRooms.size();
+		mRooms.push_back( room );
+	}
+}
+
+bool MacroMoves::extend( BoardState& state, int direction, std::vector<int>& moves, int& starCell ) const
+{
+	bool extended = extendTunnel( state, direction, moves, starCell );
+
+	//A star that came to a room's entrance from outside goes straight on to its goal
+	int room = mRoomAt[ starCell ];
+	if( room >= 0 && !inRoom( mRooms[ room ], state.player ) && packRoom( mRooms[ room ], state, moves, starCell ) )
+	{
+		extended = true;
+	}
+
+	return extended;
+}
+
+int MacroMoves::getTunnelCells() const
+{
+	return mTunnelCells;
+}
+
+int MacroMoves::getGoalRooms() const
+{
+	return (int)mRooms.size();
+}
+
+bool MacroMoves::extendTunnel( BoardState& state, int direction, std::vector<int>& moves, int& starCell ) const
+{
+	unsigned char axis = direction == MOVE_UP || direction == MOVE_DOWN ? TUNNEL_VERTICAL : TUNNEL_HORIZONTAL;
+	starCell = mBoard->step( state.player, direction );
+
+	//With the dot and star both walled in, backing out is the only other choice and it never helps
+	bool extended = false;
+	while( ( mTunnels[ state.player ] & axis ) && ( mTunnels[ starCell ] & axis ) && !mGoalCells[ starCell ] )
+	{
+		if( !mBoard->applyMove( state, direction ) )
+		{
+			break;
+		}
+
+		moves.push_back( direction );
+		starCell = mBoard->step( starCell, direction );
+		extended = true;
+	}
+
+	return extended;
+}
+
+bool MacroMoves::packRoom( const GoalRoom& room, BoardState& state, std::vector<int>& moves, int& starCell ) const
+{
+	//Only rooms whose stars are all packed already, the next goal being the deepest free one
+	int target = -1;
+	for( size_t i = 0; i < room.goals.size() && target < 0; ++i )
+	{
+		if( findStar( state, room.goals[ i ] ) < 0 )
+		{
+			target = room.goals[ i ];
+		}
+	}
+
+	int areaCount = (int)room.area.size();
+	std::vector<unsigned char> blocked( areaCount, 0 );
+	for( int i = 0; i < areaCount; ++i )
+	{
+		int cell = room.area[ i ];
+		if( cell != starCell && findStar( state, cell ) >= 0 )
+		{
+			if( inRoom( room, cell ) && !mGoalCells[ cell ] )
+			{
+				return false;
+			}
+			blocked[ i ] = 1;
+		}
+	}
+
+	if( target < 0 )
+	{
+		return false;
+	}
+
+	//Breadth first over star and dot positions inside the area, so the packing takes the fewest moves
+	int areaSize = areaCount * areaCount;
+	std::vector<int> parents( areaSize, -1 );
+	std::vector<unsigned char> parentMoves( areaSize, MOVE_NONE );
+	std::vector<int> queue;
+
+	int startStar = room.index[ starCell ];
+	int startDot = room.index[ state.player ];
+	int targetStar = room.index[ target ];
+	if( startDot < 0 )
+	{
+		return false;
+	}
+
+	int first = startStar * areaCount + startDot;
+	parents[ first ] = first;
+	queue.push_back( first );
+	int reached = -1;
+	for( size_t i = 0; i < queue.size() && reached < 0; ++i )
+	{
+		int star = queue[ i ] / areaCount;
+		int dot = queue[ i ] % areaCount;
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int next = mBoard->step( room.area[ dot ], direction );
+			int nextDot = next >= 0 ? room.index[ next ] : -1;
+			if( nextDot < 0 || blocked[ nextDot ] )
+			{
+				continue;
+			}
+
+			//Walking into the star pushes it, it has to stay in the area too
+			int nextStar = star;
+			if( nextDot == star )
+			{
+				int beyond = mBoard->step( next, direction );
+				nextStar = beyond >= 0 ? room.index[ beyond ] : -1;
+				if( nextStar < 0 || blocked[ nextStar ] )
+				{
+					continue;
+				}
+			}
+
+			int child = nextStar * areaCount + nextDot;
+			if( parents[ child ] >= 0 )
+			{
+				continue;
+			}
+
+			parents[ child ] = queue[ i ];
+			parentMoves[ child ] = (unsigned char)direction;
+			queue.push_back( child );
+			if( nextStar == targetStar )
+			{
+				reached = child;
+				break;
+			}
+		}
+	}
+
+	if( reached < 0 )
+	{
+		return false;
+	}
+
+	std::vector<int> packing;
+	for( int i = reached; i != first; i = parents[ i ] )
+	{
+		packing.push_back( parentMoves[ i ] );
+	}
+	std::reverse( packing.begin(), packing.end() );
+
+	//Replay on the real state so the stars stay sorted
+	BoardState packed = state;
+	for( size_t i = 0; i < packing.size(); ++i )
+	{
+		if( !mBoard->applyMove( packed, packing[ i ] ) )
+		{
+			return false;
+		}
+	}
+
+	state = packed;
+	moves.insert( moves.end(), packing.begin(), packing.end() );
+	starCell = target;
+	return true;
+}
+
+bool MacroMoves::inRoom( const GoalRoom& room, int cell )
+{
+	return std::find( room.cells.begin(), room.cells.end(), cell ) != room.cells.end();
+}
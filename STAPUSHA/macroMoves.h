@@ -0,0 +1,78 @@
+#ifndef MACRO_MOVES_H
+#define MACRO_MOVES_H
+
+#include "board.h"
+
+//Using vectors
+#include <vector>
+
+//Goal rooms bigger than this are left to the search push by push
+const int MAX_ROOM_CELLS = 32;
+
+//The tunnels and goal rooms of a level, where a search can take several pushes as one step
+class MacroMoves
+{
+	public:
+		//Initializes an empty level
+		MacroMoves();
+
+		//Finds the tunnels and goal rooms on the floor the dot can reach from the start
+		//A goal room is floor holding goals but no stars, cut off from the rest by a single entrance cell
+		void build( const Board& board, const BoardState& start, const int goals[], int goalCount );
+
+		//Continues a push the dot just made in direction, as far as the star is forced to go
+		//In a tunnel the star is pushed through to the end, into a goal room it is packed onto the deepest free goal
+		//Appends the extra moves, updates the state and where the star ends up, returns false if there was nothing to continue
+		bool extend( BoardState& state, int direction, std::vector<int>& moves, int& starCell ) const;
+
+		//Gets how much of the level was found to be tunnel or goal room
+		int getTunnelCells() const;
+		int getGoalRooms() const;
+
+	private:
+		//Floor with walls on both sides, along one axis
+		static const unsigned char TUNNEL_VERTICAL = 1;
+		static const unsigned char TUNNEL_HORIZONTAL = 2;
+
+		//A goal room and the cells the dot uses to pack it
+		struct GoalRoom
+		{
+			//The cell the room is entered through
+			int entrance;
+
+			//The room's own cells
+			std::vector<int> cells;
+
+			//Its goals, deepest first, the order they are packed in
+			std::vector<int> goals;
+
+			//The room, entrance and floor just outside it, numbered for the packing search
+			std::vector<int> area;
+
+			//Where each cell of the board is in the area, -1 outside it
+			std::vector<signed char> index;
+		};
+
+		//Pushes a star on to the end of a tunnel
+		bool extendTunnel( BoardState& state, int direction, std::vector<int>& moves, int& starCell ) const;
+
+		//Walks a star that was pushed onto a room's entrance to the deepest free goal by the fewest moves
+		bool packRoom( const GoalRoom& room, BoardState& state, std::vector<int>& moves, int& starCell ) const;
+
+		//Checks whether a cell is part of a room
+		static bool inRoom( const GoalRoom& room, int cell );
+
+		//The level
+		const Board* mBoard;
+		std::vector<unsigned char> mGoalCells;
+
+		//The tunnel axes of every cell
+		std::vector<unsigned char> mTunnels;
+		int mTunnelCells;
+
+		//The rooms and the one each cell is the entrance of, -1 for none
+		std::vector<GoalRoom> mRooms;
+		std::vector<int> mRoomAt;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "mappedFile.h"
+
+//Using standard IO and the platform mapping calls
+#include <stdio.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+	//Initialize
+	mData = NULL;
+	mSize = 0;
+
+	#ifdef _WIN32
+	mFile = INVALID_HANDLE_VALUE;
+	mMapping = NULL;
+	#endif
+}
+
+MappedFile::~MappedFile()
+{
+	//Deallocate
+	close();
+}
+
+bool MappedFile::open( const std::string& path )
+{
+	//Get rid of preexisting mapping
+	close();
+
+	#ifdef _WIN32
+	mFile = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( mFile == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if( !GetFileSizeEx( mFile, &size ) || size.QuadPart == 0 )
+	{
+		close();
+		return false;
+	}
+
+	mMapping = CreateFileMappingA( mFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( mMapping == NULL )
+	{
+		printf( "Unable to map %s!\n", path.c_str() );
+		close();
+		return false;
+	}
+
+	mData = (const unsigned char*)MapViewOfFile( mMapping, FILE_MAP_READ, 0, 0, 0 );
+	mSize = (size_t)size.QuadPart;
+	#else
+	int file = ::open( path.c_str(), O_RDONLY );
+	if( file < 0 )
+	{
+		return false;
+	}
+
+	struct stat info;
+	if( fstat( file, &info ) != 0 || info.st_size == 0 )
+	{
+		::close( file );
+		return false;
+	}
+
+	void* data = mmap( NULL, info.st_size, PROT_READ, MAP_SHARED, file, 0 );
+
+	//The mapping keeps the file alive
+	::close( file );
+
+	if( data != MAP_FAILED )
+	{
+		mData = (const unsigned char*)data;
+		mSize = info.st_size;
+	}
+	#endif
+
+	if( mData == NULL )
+	{
+		printf( "Unable to map %s!\n", path.c_str() );
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	#ifdef _WIN32
+	if( mData != NULL )
+	{
+		UnmapViewOfFile( mData );
+	}
+	if( mMapping != NULL )
+	{
+		CloseHandle( mMapping );
+		mMapping = NULL;
+	}
+	if( mFile != INVALID_HANDLE_VALUE )
+	{
+		CloseHandle( mFile );
+		mFile = INVALID_HANDLE_VALUE;
+	}
+	#else
+	if( mData != NULL )
+	{
+		munmap( (void*)mData, mSize );
+	}
+	#endif
+
+	mData = NULL;
+	mSize = 0;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+	return mData;
+}
+
+size_t MappedFile::getSize() const
+{
+	return mSize;
+}
@@ -0,0 +1,43 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+//Using strings
+#include <string>
+
+//A read-only file mapped into memory
+class MappedFile
+{
+	public:
+		//Initializes variables
+		MappedFile();
+
+		//Unmaps the file
+		~MappedFile();
+
+		//Maps the file at the specified path
+		bool open( const std::string& path );
+
+		//Unmaps the file
+		void close();
+
+		//Gets the mapped bytes
+		const unsigned char* getData() const;
+		size_t getSize() const;
+
+	private:
+		//Copying would unmap twice
+		MappedFile( const MappedFile& );
+		MappedFile& operator=( const MappedFile& );
+
+		//The mapped view
+		const unsigned char* mData;
+		size_t mSize;
+
+		//The platform file handles
+		#ifdef _WIN32
+		void* mFile;
+		void* mMapping;
+		#endif
+};
+
+#endif
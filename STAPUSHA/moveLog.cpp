@@ -0,0 +1,163 @@
+#include "moveLog.h"
+#include "board.h"
+
+//Using standard IO and the standard library
+#include <stdio.h>
+#include <stdlib.h>
+
+//Letters per line when writing a log
+const int LOG_LINE_LENGTH = 64;
+
+char moveLetter( int move )
+{
+	switch( move )
+	{
+		case MOVE_UP: return 'U';
+		case MOVE_DOWN: return 'D';
+		case MOVE_LEFT: return 'L';
+		case MOVE_RIGHT: return 'R';
+		case MOVE_RESET: return 'X';
+	}
+
+	return '?';
+}
+
+int moveFromLetter( char letter )
+{
+	switch( letter )
+	{
+		case 'U': case 'u': return MOVE_UP;
+		case 'D': case 'd': return MOVE_DOWN;
+		case 'L': case 'l': return MOVE_LEFT;
+		case 'R': case 'r': return MOVE_RIGHT;
+		case 'X': case 'x': return MOVE_RESET;
+	}
+
+	return MOVE_NONE;
+}
+
+bool readSolutionLine( FILE* file, std::string& line )
+{
+	char chunk[ 4096 ];
+	line.clear();
+	while( fgets( chunk, sizeof( chunk ), file ) != NULL )
+	{
+		line += chunk;
+		if( !line.empty() && line[ line.size() - 1 ] == '\n' )
+		{
+			return true;
+		}
+	}
+
+	return !line.empty();
+}
+
+int parseSolutionLine( const char* line, std::vector<int>& moves )
+{
+	moves.clear();
+
+	while( *line == ' ' || *line == '\t' )
+	{
+		++line;
+	}
+
+	if( *line == '\0' || *line == '\r' || *line == '\n' || *line == '#' )
+	{
+		return 0;
+	}
+
+	char* letters = NULL;
+	long level = strtol( line, &letters, 10 );
+	if( letters == line || level < 1 )
+	{
+		return -1;
+	}
+
+	for( ; *letters != '\0' && *letters != '#'; ++letters )
+	{
+		int move = moveFromLetter( *letters );
+		if( move != MOVE_NONE )
+		{
+			moves.push_back( move );
+		}
+		else if( *letters != ' ' && *letters != '\t' && *letters != '\r' && *letters != '\n' )
+		{
+			return -1;
+		}
+	}
+
+	return (int)level;
+}
+
+bool loadMoveLog( const std::string& path, std::vector<int>& moves )
+{
+	FILE* file = fopen( path.c_str(), "r" );
+	if( file == NULL )
+	{
+		printf( "Unable to open move log %s!\n", path.c_str() );
+		return false;
+	}
+
+	moves.clear();
+	bool success = true;
+	int line = 1;
+	for( int c = fgetc( file ); c != EOF && success; c = fgetc( file ) )
+	{
+		if( c == '#' )
+		{
+			//Skip the comment
+			while( c != '\n' && c != EOF )
+			{
+				c = fgetc( file );
+			}
+		}
+
+		if( c == '\n' )
+		{
+			++line;
+		}
+		else if( c != ' ' && c != '\t' && c != '\r' && c != EOF )
+		{
+			int move = moveFromLetter( (char)c );
+			if( move == MOVE_NONE )
+			{
+				printf( "Error reading move log %s: Unknown move '%c' on line %d!\n", path.c_str(), c, line );
+				success = false;
+			}
+			else
+			{
+				moves.push_back( move );
+			}
+		}
+	}
+
+	fclose( file );
+	return success;
+}
+
+bool saveMoveLog( const std::string& path, const std::vector<int>& moves )
+{
+	FILE* file = fopen( path.c_str(), "w" );
+	if( file == NULL )
+	{
+		printf( "Unable to write move log %s!\n", path.c_str() );
+		return false;
+	}
+
+	for( size_t i = 0; i < moves.size(); ++i )
+	{
+		fputc( moveLetter( moves[ i ] ), file );
+		if( ( i + 1 ) % LOG_LINE_LENGTH == 0 || i + 1 == moves.size() )
+		{
+			fputc( '\n', file );
+		}
+	}
+
+	if( fclose( file ) != 0 )
+	{
+		printf( "Unable to write move log %s!\n", path.c_str() );
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,31 @@
+#ifndef MOVE_LOG_H
+#define MOVE_LOG_H
+
+//Using standard IO, strings and vectors
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/*A move log is plain text, one letter per move: U, D, L and R move, X resets the level.
+Whitespace is skipped and # starts a comment that runs to the end of the line.*/
+
+//Gets the letter of a move code, '?' for codes a log can't hold
+char moveLetter( int move );
+
+//Gets the move code of a letter, MOVE_NONE if it isn't one
+int moveFromLetter( char letter );
+
+//Reads a whole line of a solutions file however long it is, returns false at the end of the file
+bool readSolutionLine( FILE* file, std::string& line );
+
+//Reads a solution line, a 1 based level number and then that level's move log letters
+//Returns the level, 0 for a blank or comment line, or -1 if the line is malformed
+int parseSolutionLine( const char* line, std::vector<int>& moves );
+
+//Reads a move log, returns false if it's missing or holds an unknown letter
+bool loadMoveLog( const std::string& path, std::vector<int>& moves );
+
+//Writes a move log, returns false if it couldn't be written
+bool saveMoveLog( const std::string& path, const std::vector<int>& moves );
+
+#endif
@@ -0,0 +1,315 @@
+/*Shortens a batch of recorded solutions to the shipped levels across every core.
+Usage: SolutionOptimizer [--in path] [--out path] [--generate n] [--seed n] [--passes n]
+A solution file has one solution per line, the 1 based level number and then its move log letters.
+--generate makes n wandering solutions from the solver's own instead of reading --in.*/
+
+//Using standard IO, the standard library, strings and timers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "board.h"
+#include "levels.h"
+#include "moveLog.h"
+#include "parallel.h"
+#include "solver.h"
+#include "solutionOptimizer.h"
+
+//Where solutions are read from and written to unless the options say otherwise
+const char DEFAULT_SOLUTIONS_PATH[] = "39_tiling/solutions.txt";
+const char DEFAULT_OPTIMIZED_PATH[] = "39_tiling/solutions.optimized.txt";
+
+//How many solutions each parallelFor index works through
+const int SOLUTIONS_PER_CHUNK = 16;
+
+//A solution to one of the shipped levels
+struct RecordedSolution
+{
+	int level;
+	std::vector<int> moves;
+};
+
+//Reads a solution file, returns false if it's missing or malformed
+static bool loadSolutions( const char* path, std::vector<RecordedSolution>& solutions )
+{
+	FILE* file = fopen( path, "r" );
+	if( file == NULL )
+	{
+		printf( "Unable to open solutions %s!\n", path );
+		return false;
+	}
+
+	bool success = true;
+	std::string line;
+	for( int number = 1; success && readSolutionLine( file, line ); ++number )
+	{
+		RecordedSolution solution;
+		solution.level = parseSolutionLine( line.c_str(), solution.moves );
+		if( solution.level < 0 || solution.level > TOTAL_LEVELS )
+		{
+			printf( "Error reading solutions %s: Bad solution on line %d!\n", path, number );
+			success = false;
+		}
+		else if( solution.level > 0 )
+		{
+			solutions.push_back( solution );
+		}
+	}
+
+	fclose( file );
+	return success;
+}
+
+//Writes a solution file, returns false if it couldn't be written
+static bool saveSolutions( const char* path, const std::vector<RecordedSolution>& solutions )
+{
+	FILE* file = fopen( path, "w" );
+	if( file == NULL )
+	{
+		printf( "Unable to write solutions %s!\n", path );
+		return false;
+	}
+
+	for( size_t i = 0; i < solutions.size(); ++i )
+	{
+		fprintf( file, "%d ", solutions[ i ].level );
+		for( size_t j = 0; j < solutions[ i ].moves.size(); ++j )
+		{
+			fputc( moveLetter( solutions[ i ].moves[ j ] ), file );
+		}
+		fputc( '\n', file );
+	}
+
+	if( fclose( file ) != 0 )
+	{
+		printf( "Unable to write solutions %s!\n", path );
+		return false;
+	}
+
+	return true;
+}
+
+//Makes a wandering solution out of a shortest one, with detours, walks back and restarts
+static void wander( const Board& board, const BoardState& start, const std::vector<int>& shortest, unsigned int seed, std::vector<int>& moves )
+{
+	moves.clear();
+	BoardState state = start;
+	for( size_t i = 0; i < shortest.size(); ++i )
+	{
+		seed = seed * 1664525u + 1013904223u;
+		int roll = (int)( ( seed >> 16 ) % 100 );
+
+		//Now and then start over and replay what was done so far
+		if( roll < 2 )
+		{
+			moves.push_back( MOVE_RESET );
+			state = start;
+			for( size_t j = 0; j < i; ++j )
+			{
+				moves.push_back( shortest[ j ] );
+				board.applyMove( state, shortest[ j ] );
+			}
+		}
+		//Or wander off without pushing anything and come back the same way
+		else if( roll < 30 )
+		{
+			std::vector<int> detour;
+			int length = 1 + (int)( ( seed >> 8 ) % 6 );
+			for( int j = 0; j < length; ++j )
+			{
+				seed = seed * 1664525u + 1013904223u;
+				int direction = MOVE_UP + (int)( ( seed >> 16 ) % 4 );
+				int next = board.step( state.player, direction );
+				if( next >= 0 && !board.isWall( next ) && findStar( state, next ) < 0 )
+				{
+					state.player = next;
+					detour.push_back( direction );
+				}
+			}
+
+			moves.insert( moves.end(), detour.begin(), detour.end() );
+			for( size_t j = detour.size(); j > 0; --j )
+			{
+				moves.push_back( oppositeMove( detour[ j - 1 ] ) );
+				state.player = board.step( state.player, oppositeMove( detour[ j - 1 ] ) );
+			}
+		}
+
+		moves.push_back( shortest[ i ] );
+		board.applyMove( state, shortest[ i ] );
+	}
+}
+
+int main( int argc, char* args[] )
+{
+	const char* inPath = DEFAULT_SOLUTIONS_PATH;
+	const char* outPath = DEFAULT_OPTIMIZED_PATH;
+	int generate = 0;
+	unsigned int seed = 1;
+	int passes = -1;
+
+	for( int i = 1; i + 1 < argc; i += 2 )
+	{
+		const char* value = args[ i + 1 ];
+		if( strcmp( args[ i ], "--in" ) == 0 )
+		{
+			inPath = value;
+		}
+		else if( strcmp( args[ i ], "--out" ) == 0 )
+		{
+			outPath = value;
+		}
+		else if( strcmp( args[ i ], "--generate" ) == 0 )
+		{
+			generate = atoi( value );
+		}
+		else if( strcmp( args[ i ], "--seed" ) == 0 )
+		{
+			seed = (unsigned int)strtoul( value, NULL, 10 );
+		}
+		else if( strcmp( args[ i ], "--passes" ) == 0 )
+		{
+			passes = atoi( value );
+		}
+		else
+		{
+			printf( "Unknown option %s!\n", args[ i ] );
+			return 1;
+		}
+	}
+
+	//Load the wall grid the levels are played on
+	Board board;
+	if( !board.loadFromFile( LEVEL_MAP_PATH ) )
+	{
+		printf( "Failed to load board!\n" );
+		return 1;
+	}
+
+	//Every level's start and goals
+	BoardState starts[ TOTAL_LEVELS ];
+	int goals[ TOTAL_LEVELS ][ MAX_STARS ];
+	int goalCounts[ TOTAL_LEVELS ];
+	for( int level = 0; level < TOTAL_LEVELS; ++level )
+	{
+		starts[ level ].player = board.cellFromEntity( gLevels[ level ].dot.x, gLevels[ level ].dot.y );
+		starts[ level ].starCount = levelStarCells( board, gLevels[ level ], starts[ level ].stars );
+		sortStars( starts[ level ] );
+		goalCounts[ level ] = levelGoalCells( board, gLevels[ level ], goals[ level ] );
+	}
+
+	std::vector<RecordedSolution> solutions;
+	if( generate > 0 )
+	{
+		//Solve each level once, then scramble copies of the answers
+		std::vector<int> shortest[ TOTAL_LEVELS ];
+		for( int level = 0; level < TOTAL_LEVELS; ++level )
+		{
+			Solver solver( board, goals[ level ], goalCounts[ level ] );
+			if( !solver.solve( starts[ level ], shortest[ level ] ) )
+			{
+				printf( "Level %d couldn't be solved!\n", level + 1 );
+				return 1;
+			}
+			printf( "Level %d: %d moves at best\n", level + 1, (int)shortest[ level ].size() );
+		}
+
+		solutions.resize( generate );
+		for( int i = 0; i < generate; ++i )
+		{
+			solutions[ i ].level = 1 + i % TOTAL_LEVELS;
+			wander( board, starts[ i % TOTAL_LEVELS ], shortest[ i % TOTAL_LEVELS ], seed + i, solutions[ i ].moves );
+		}
+	}
+	else if( !loadSolutions( inPath, solutions ) )
+	{
+		return 1;
+	}
+
+	if( solutions.empty() )
+	{
+		printf( "No solutions to optimize!\n" );
+		return 1;
+	}
+
+	//Each chunk gets its own optimizers, they keep walk maps between solutions
+	int count = (int)solutions.size();
+	std::vector<RecordedSolution> optimized( count );
+	std::vector<OptimizeResult> results( count );
+	std::vector<unsigned char> solved( count, 0 );
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int chunks = ( count + SOLUTIONS_PER_CHUNK - 1 ) / SOLUTIONS_PER_CHUNK;
+	parallelFor( chunks, [ & ]( int chunk )
+	{
+		std::vector<SolutionOptimizer> optimizers;
+		for( int level = 0; level < TOTAL_LEVELS; ++level )
+		{
+			optimizers.push_back( SolutionOptimizer( board, starts[ level ], goals[ level ], goalCounts[ level ] ) );
+			if( passes >= 0 )
+			{
+				optimizers.back().setReorderPasses( passes );
+			}
+		}
+
+		int end = ( chunk + 1 ) * SOLUTIONS_PER_CHUNK < count ? ( chunk + 1 ) * SOLUTIONS_PER_CHUNK : count;
+		for( int i = chunk * SOLUTIONS_PER_CHUNK; i < end; ++i )
+		{
+			optimized[ i ].level = solutions[ i ].level;
+			SolutionOptimizer& optimizer = optimizers[ solutions[ i ].level - 1 ];
+			solved[ i ] = optimizer.optimize( solutions[ i ].moves, optimized[ i ].moves, &results[ i ] );
+
+			//Unsolved input goes out as it came in
+			if( !solved[ i ] )
+			{
+				optimized[ i ].moves = solutions[ i ].moves;
+			}
+		}
+	} );
+	double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	//Check every answer again from scratch, on the same rules the game plays by
+	long long movesBefore = 0, movesAfter = 0, pushesBefore = 0, pushesAfter = 0;
+	int unsolved = 0, broken = 0;
+	for( int i = 0; i < count; ++i )
+	{
+		if( !solved[ i ] )
+		{
+			++unsolved;
+			continue;
+		}
+
+		int level = solutions[ i ].level - 1;
+		SolutionOptimizer checker( board, starts[ level ], goals[ level ], goalCounts[ level ] );
+		if( !checker.verify( optimized[ i ].moves ) )
+		{
+			++broken;
+		}
+
+		movesBefore += results[ i ].movesBefore;
+		movesAfter += results[ i ].movesAfter;
+		pushesBefore += results[ i ].pushesBefore;
+		pushesAfter += results[ i ].pushesAfter;
+	}
+
+	int solvedCount = count - unsolved;
+	printf( "Optimized %d solutions in %.2f s on %d workers, %.0f solutions per second\n", count, seconds, workerCount(), count / seconds );
+	if( solvedCount > 0 )
+	{
+		printf( "Moves %lld -> %lld (%.1f -> %.1f on average, %.1f%% shorter), pushes %lld -> %lld\n", movesBefore, movesAfter,
+			(double)movesBefore / solvedCount, (double)movesAfter / solvedCount, movesBefore > 0 ? 100.0 * ( movesBefore - movesAfter ) / movesBefore : 0.0,
+			pushesBefore, pushesAfter );
+	}
+	printf( "%d solutions didn't solve their level and were left alone, %d failed the rules check\n", unsolved, broken );
+
+	if( !saveSolutions( outPath, optimized ) )
+	{
+		return 1;
+	}
+
+	printf( "Wrote %s\n", outPath );
+	return broken == 0 ? 0 : 1;
+}
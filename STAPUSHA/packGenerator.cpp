@@ -0,0 +1,149 @@
+/*Generates a pack of solver-verified levels across every core.
+Usage: PackGenerator [--count n] [--out path] [--seed n] [--stars n] [--walls n] [--rows n] [--min-moves n]*/
+
+//Using standard IO, the standard library, strings and timers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "levelGenerator.h"
+#include "parallel.h"
+
+//Where packs go unless --out says otherwise
+const char DEFAULT_PACK_PATH[] = "39_tiling/generated.pack";
+
+//How many candidates each worker gets per round
+const int CANDIDATES_PER_WORKER = 8;
+
+//Rounds in a row without a single accepted level before the settings are given up on
+const int MAX_BARREN_ROUNDS = 64;
+
+int main( int argc, char* args[] )
+{
+	GeneratorSettings settings;
+	int count = 100;
+	unsigned int seed = 1;
+	const char* path = DEFAULT_PACK_PATH;
+
+	for( int i = 1; i + 1 < argc; i += 2 )
+	{
+		const char* value = args[ i + 1 ];
+		if( strcmp( args[ i ], "--count" ) == 0 )
+		{
+			count = atoi( value );
+		}
+		else if( strcmp( args[ i ], "--out" ) == 0 )
+		{
+			path = value;
+		}
+		else if( strcmp( args[ i ], "--seed" ) == 0 )
+		{
+			seed = (unsigned int)strtoul( value, NULL, 10 );
+		}
+		else if( strcmp( args[ i ], "--stars" ) == 0 )
+		{
+			settings.starCount = atoi( value );
+		}
+		else if( strcmp( args[ i ], "--walls" ) == 0 )
+		{
+			settings.wallCount = atoi( value );
+		}
+		else if( strcmp( args[ i ], "--rows" ) == 0 )
+		{
+			settings.rows = atoi( value );
+		}
+		else if( strcmp( args[ i ], "--min-moves" ) == 0 )
+		{
+			settings.minMoves = atoi( value );
+		}
+		else
+		{
+			printf( "Unknown option %s!\n", args[ i ] );
+			return 1;
+		}
+	}
+
+	if( count <= 0 || settings.starCount < 1 || settings.starCount > MAX_STARS || settings.rows < 3 )
+	{
+		printf( "Nothing sensible to generate!\n" );
+		return 1;
+	}
+
+	std::vector<PackLevel> levels;
+	int tried = 0;
+	int rejected[ REJECTED_TOO_EASY + 1 ] = { 0 };
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	//Candidate i always uses seed + i, so a pack depends on the seed and not the core count
+	int round = workerCount() * CANDIDATES_PER_WORKER;
+	std::vector<PackLevel> candidates( round );
+	std::vector<int> results( round );
+	double lastReport = 0.0;
+	int barrenRounds = 0;
+	while( (int)levels.size() < count )
+	{
+		size_t accepted = levels.size();
+		parallelFor( round, [ & ]( int i )
+		{
+			results[ i ] = generateLevel( settings, seed + tried + i, candidates[ i ] );
+		} );
+
+		for( int i = 0; i < round && (int)levels.size() < count; ++i )
+		{
+			if( results[ i ] == GENERATED )
+			{
+				levels.push_back( candidates[ i ] );
+			}
+			else
+			{
+				++rejected[ results[ i ] ];
+			}
+		}
+
+		tried += round;
+
+		//Settings no candidate can meet would otherwise spin forever
+		barrenRounds = levels.size() > accepted ? 0 : barrenRounds + 1;
+		if( barrenRounds >= MAX_BARREN_ROUNDS )
+		{
+			printf( "Gave up after %d candidates in a row made no level, %d/%d levels made\n", barrenRounds * round, (int)levels.size(), count );
+			printf( "Rejected %d bad layouts, %d unsolved, %d too easy\n", rejected[ REJECTED_LAYOUT ], rejected[ REJECTED_UNSOLVED ], rejected[ REJECTED_TOO_EASY ] );
+			return 1;
+		}
+
+		//Report progress about once a second
+		double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+		if( seconds >= lastReport + 1.0 )
+		{
+			printf( "%d/%d levels from %d candidates, %.1f levels per minute\n", (int)levels.size(), count, tried, levels.size() * 60.0 / seconds );
+			lastReport = seconds;
+		}
+	}
+
+	double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	//Report the difficulty spread
+	int fewest = levels[ 0 ].solutionMoves, most = 0;
+	double totalMoves = 0.0, totalPushes = 0.0;
+	for( size_t i = 0; i < levels.size(); ++i )
+	{
+		fewest = levels[ i ].solutionMoves < fewest ? levels[ i ].solutionMoves : fewest;
+		most = levels[ i ].solutionMoves > most ? levels[ i ].solutionMoves : most;
+		totalMoves += levels[ i ].solutionMoves;
+		totalPushes += levels[ i ].solutionPushes;
+	}
+
+	printf( "Generated %d levels in %.2f s on %d workers, %.1f verified levels per minute\n", count, seconds, workerCount(), count * 60.0 / seconds );
+	printf( "Rejected %d bad layouts, %d unsolved, %d too easy\n", rejected[ REJECTED_LAYOUT ], rejected[ REJECTED_UNSOLVED ], rejected[ REJECTED_TOO_EASY ] );
+	printf( "Solutions take %d to %d moves, %.1f moves and %.1f pushes on average\n", fewest, most, totalMoves / count, totalPushes / count );
+
+	if( !saveLevelPack( path, levels ) )
+	{
+		return 1;
+	}
+
+	printf( "Wrote %s\n", path );
+	return 0;
+}
@@ -0,0 +1,374 @@
+#include "parallel.h"
+
+//Using threads, atomics, condition variables, deques and timers
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <chrono>
+
+//The deque a thread pushes to and pops from, pool workers have their own and every other thread shares 0
+static thread_local int tWorker = 0;
+
+//The cap setWorkerLimit puts on parallelFor, 0 for none
+static std::atomic<int> gWorkerLimit( 0 );
+
+struct Job
+{
+	//What to run
+	std::function<void()> work;
+
+	//Dependencies not finished yet, plus one while the job is being submitted
+	std::atomic<int> waiting;
+
+	//Set once work has returned, under mutex so continuations can't be missed
+	std::atomic<bool> done;
+	std::mutex mutex;
+	std::vector<JobHandle> continuations;
+};
+
+//Gets nanoseconds elapsed since a start time
+static long long nanosecondsSince( std::chrono::steady_clock::time_point start )
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+}
+
+//The threads every job shares, they sleep while there's nothing queued
+class JobPool
+{
+	public:
+		//Starts the workers, each with its own deque after the shared one
+		JobPool( int threadCount ) : mQueues( threadCount + 1 ), mCounters( threadCount + 1 ), mQueued( 0 ), mSleepers( 0 ), mWaiters( 0 )
+		{
+			mQuit = false;
+			resetStats();
+
+			for( int i = 0; i < threadCount; ++i )
+			{
+				mThreads.push_back( std::thread( &JobPool::run, this, i + 1 ) );
+			}
+		}
+
+		//Stops the workers once the queues are empty
+		~JobPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock( mMutex );
+				mQuit = true;
+			}
+			mWake.notify_all();
+
+			for( size_t i = 0; i < mThreads.size(); ++i )
+			{
+				mThreads[ i ].join();
+			}
+		}
+
+		//Queues a job whose dependencies have all finished on the calling thread's deque
+		void enqueue( const JobHandle& job )
+		{
+			Queue& queue = mQueues[ tWorker ];
+			{
+				std::lock_guard<std::mutex> lock( queue.mutex );
+				queue.jobs.push_back( job );
+			}
+			++mQueued;
+
+			//Sleepers and waiters recheck under mMutex, so taking it here means none can miss the job
+			if( mSleepers > 0 || mWaiters > 0 )
+			{
+				std::lock_guard<std::mutex> lock( mMutex );
+				mWake.notify_one();
+				mFinished.notify_all();
+			}
+		}
+
+		//Runs one queued job, the newest of this thread's own or else the oldest stolen from another
+		//Returns false if every deque was empty
+		bool runOne()
+		{
+			JobHandle job;
+			bool stolen = false;
+			int count = (int)mQueues.size();
+			for( int i = 0; i < count && !job; ++i )
+			{
+				Queue& queue = mQueues[ ( tWorker + i ) % count ];
+				std::lock_guard<std::mutex> lock( queue.mutex );
+				if( !queue.jobs.empty() )
+				{
+					if( i == 0 )
+					{
+						job = queue.jobs.back();
+						queue.jobs.pop_back();
+					}
+					else
+					{
+						job = queue.jobs.front();
+						queue.jobs.pop_front();
+						stolen = true;
+					}
+				}
+			}
+
+			if( !job )
+			{
+				return false;
+			}
+			--mQueued;
+
+			Counters& counters = mCounters[ tWorker ];
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			job->work();
+			counters.busyNanoseconds += nanosecondsSince( start );
+			++counters.jobs;
+			counters.steals += stolen;
+
+			finish( job );
+			return true;
+		}
+
+		//Runs jobs until one has finished, sleeping if there's nothing to run
+		void wait( const JobHandle& job )
+		{
+			while( !job->done )
+			{
+				if( runOne() )
+				{
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock( mMutex );
+				++mWaiters;
+				mFinished.wait( lock, [ & ]()
+				{
+					return job->done || mQueued > 0;
+				} );
+				--mWaiters;
+			}
+		}
+
+		//Copies out the counters
+		void getStats( std::vector<WorkerStats>& stats )
+		{
+			stats.resize( mCounters.size() );
+			for( size_t i = 0; i < mCounters.size(); ++i )
+			{
+				stats[ i ].jobs = mCounters[ i ].jobs;
+				stats[ i ].steals = mCounters[ i ].steals;
+				stats[ i ].busySeconds = mCounters[ i ].busyNanoseconds * 1e-9;
+				stats[ i ].idleSeconds = mCounters[ i ].idleNanoseconds * 1e-9;
+			}
+		}
+
+		//Zeroes the counters
+		void resetStats()
+		{
+			for( size_t i = 0; i < mCounters.size(); ++i )
+			{
+				mCounters[ i ].jobs = 0;
+				mCounters[ i ].steals = 0;
+				mCounters[ i ].busyNanoseconds = 0;
+				mCounters[ i ].idleNanoseconds = 0;
+			}
+		}
+
+	private:
+		//Marks a job done and queues whatever was only waiting on it
+		void finish( const JobHandle& job )
+		{
+			std::vector<JobHandle> continuations;
+			{
+				std::lock_guard<std::mutex> lock( job->mutex );
+				job->done = true;
+				continuations.swap( job->continuations );
+			}
+
+			for( size_t i = 0; i < continuations.size(); ++i )
+			{
+				if( --continuations[ i ]->waiting == 0 )
+				{
+					enqueue( continuations[ i ] );
+				}
+			}
+
+			if( mWaiters > 0 )
+			{
+				std::lock_guard<std::mutex> lock( mMutex );
+				mFinished.notify_all();
+			}
+		}
+
+		//The worker thread body
+		void run( int index )
+		{
+			tWorker = index;
+			Counters& counters = mCounters[ index ];
+			while( true )
+			{
+				if( runOne() )
+				{
+					continue;
+				}
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				std::unique_lock<std::mutex> lock( mMutex );
+				++mSleepers;
+				mWake.wait( lock, [ this ]()
+				{
+					return mQuit || mQueued > 0;
+				} );
+				--mSleepers;
+				counters.idleNanoseconds += nanosecondsSince( start );
+
+				if( mQuit && mQueued == 0 )
+				{
+					return;
+				}
+			}
+		}
+
+		//A thread's jobs, kept apart so threads don't share cache lines
+		struct alignas( 64 ) Queue
+		{
+			std::mutex mutex;
+			std::deque<JobHandle> jobs;
+		};
+
+		//A thread's utilization, shared threads add to slot 0 together
+		struct alignas( 64 ) Counters
+		{
+			std::atomic<long long> jobs;
+			std::atomic<long long> steals;
+			std::atomic<long long> busyNanoseconds;
+			std::atomic<long long> idleNanoseconds;
+		};
+
+		std::vector<Queue> mQueues;
+		std::vector<Counters> mCounters;
+
+		//Jobs sitting in any deque, and who's asleep until that changes
+		std::atomic<int> mQueued;
+		std::atomic<int> mSleepers;
+		std::atomic<int> mWaiters;
+
+		//Sleeping and waking
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::condition_variable mFinished;
+		bool mQuit;
+
+		std::vector<std::thread> mThreads;
+};
+
+//Gets the shared pool, started on first use
+//There's always at least one worker so jobs nobody waits on still run
+static JobPool& jobPool()
+{
+	static JobPool pool( workerCount() > 1 ? workerCount() - 1 : 1 );
+	return pool;
+}
+
+int workerCount()
+{
+	int count = (int)std::thread::hardware_concurrency();
+	return count > 0 ? count : 1;
+}
+
+void setWorkerLimit( int limit )
+{
+	gWorkerLimit = limit > 0 ? limit : 0;
+}
+
+JobHandle submitJob( const std::function<void()>& work, const std::vector<JobHandle>& dependencies )
+{
+	JobHandle job = std::make_shared<Job>();
+	job->work = work;
+	job->waiting = 1;
+	job->done = false;
+
+	//Sign up with every dependency that hasn't finished yet
+	for( size_t i = 0; i < dependencies.size(); ++i )
+	{
+		std::lock_guard<std::mutex> lock( dependencies[ i ]->mutex );
+		if( !dependencies[ i ]->done )
+		{
+			++job->waiting;
+			dependencies[ i ]->continuations.push_back( job );
+		}
+	}
+
+	if( --job->waiting == 0 )
+	{
+		jobPool().enqueue( job );
+	}
+
+	return job;
+}
+
+JobHandle continueWith( const JobHandle& job, const std::function<void()>& work )
+{
+	return submitJob( work, std::vector<JobHandle>( 1, job ) );
+}
+
+bool isJobDone( const JobHandle& job )
+{
+	return job->done;
+}
+
+void waitForJob( const JobHandle& job )
+{
+	jobPool().wait( job );
+}
+
+void parallelFor( int count, const std::function<void( int )>& body )
+{
+	if( count <= 0 )
+	{
+		return;
+	}
+
+	int limit = gWorkerLimit;
+	int threads = limit > 0 && limit < workerCount() ? limit : workerCount();
+	threads = count < threads ? count : threads;
+	if( threads == 1 )
+	{
+		for( int i = 0; i < count; ++i )
+		{
+			body( i );
+		}
+		return;
+	}
+
+	//One job per thread, each claiming indices until none are left, so uneven bodies balance out
+	std::atomic<int> next( 0 );
+	std::function<void()> claim = [ & ]()
+	{
+		for( int i = next++; i < count; i = next++ )
+		{
+			body( i );
+		}
+	};
+
+	std::vector<JobHandle> jobs;
+	for( int i = 1; i < threads; ++i )
+	{
+		jobs.push_back( submitJob( claim ) );
+	}
+
+	claim();
+	for( size_t i = 0; i < jobs.size(); ++i )
+	{
+		waitForJob( jobs[ i ] );
+	}
+}
+
+void getWorkerStats( std::vector<WorkerStats>& stats )
+{
+	jobPool().getStats( stats );
+}
+
+void resetWorkerStats()
+{
+	jobPool().resetStats();
+}
@@ -0,0 +1,55 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+//Using function objects, shared pointers and vectors
+#include <functional>
+#include <memory>
+#include <vector>
+
+//A submitted job, kept alive by whatever waits on it or runs after it
+struct Job;
+typedef std::shared_ptr<Job> JobHandle;
+
+//How one thread spent its time since the counters were last reset
+struct WorkerStats
+{
+	//Jobs it ran, and how many of those it stole from another thread's deque
+	long long jobs;
+	long long steals;
+
+	//Time spent running jobs, and for pool workers, asleep with nothing to do
+	double busySeconds;
+	double idleSeconds;
+};
+
+//Gets the number of worker threads batch work should use
+int workerCount();
+
+//Caps how many threads parallelFor spreads over, 0 lifts the cap
+void setWorkerLimit( int limit );
+
+//Queues work to run on the pool once every dependency has finished
+//Each worker keeps its own deque, newest job first, and idle workers steal the oldest from others
+//The workers are started on first use and kept for the rest of the run
+JobHandle submitJob( const std::function<void()>& work, const std::vector<JobHandle>& dependencies = std::vector<JobHandle>() );
+
+//Queues work to run once job has finished
+JobHandle continueWith( const JobHandle& job, const std::function<void()>& work );
+
+//Checks whether a job has finished
+bool isJobDone( const JobHandle& job );
+
+//Waits for a job, running queued jobs on this thread in the meantime
+void waitForJob( const JobHandle& job );
+
+//Runs body( i ) for every i in [0, count) across the worker threads and waits
+//Calls from inside a job are fine, the waiting thread keeps running other jobs
+void parallelFor( int count, const std::function<void( int )>& body );
+
+//Gets every thread's counters, the first covers threads outside the pool such as the main thread
+void getWorkerStats( std::vector<WorkerStats>& stats );
+
+//Zeroes the counters
+void resetWorkerStats();
+
+#endif
@@ -0,0 +1,229 @@
+#include "pathFinder.h"
+
+//How many map cells the cache may hold, so large maps keep fewer maps
+const size_t PATH_CACHE_CELLS = 1 << 22;
+
+//Kept to this file, levelMetrics.cpp has a PushNode of its own
+namespace
+{
+
+//A step of the push search, with the star on cell pushed there in direction
+struct PushNode
+{
+	int cell;
+	int direction;
+	int parent;
+};
+
+}
+
+//Checks whether two states have the same stars
+static bool sameStars( const BoardState& a, const BoardState& b )
+{
+	if( a.starCount != b.starCount )
+	{
+		return false;
+	}
+
+	for( int i = 0; i < a.starCount; ++i )
+	{
+		if( findStar( b, a.stars[ i ] ) < 0 )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+PathFinder::PathFinder( const Board& board )
+{
+	//Initialize
+	mBoard = &board;
+	mMapStars.player = -1;
+	mMapStars.starCount = 0;
+	mMapBuilds = 0;
+}
+
+void PathFinder::invalidate()
+{
+	mMaps.clear();
+}
+
+bool PathFinder::findWalk( const BoardState& state, int target, std::vector<int>& moves )
+{
+	moves.clear();
+	if( mBoard->isWall( target ) || findStar( state, target ) >= 0 )
+	{
+		return false;
+	}
+
+	const std::vector<unsigned short>& distances = walkMap( state, target );
+	if( distances[ state.player ] == WALK_UNREACHABLE )
+	{
+		return false;
+	}
+
+	followMap( distances, state.player, moves );
+	return true;
+}
+
+bool PathFinder::findPush( const BoardState& state, int cell, int target, std::vector<int>& moves )
+{
+	moves.clear();
+	int star = findStar( state, cell );
+	if( star < 0 || mBoard->isWall( target ) )
+	{
+		return false;
+	}
+
+	if( cell == target )
+	{
+		return true;
+	}
+
+	//Search over where the star is and which way it was last pushed, the dot stands just behind it
+	std::vector<PushNode> nodes;
+	std::vector<char> seen( mBoard->getCellCount() * 4, 0 );
+	std::vector<unsigned short> reach;
+	BoardState moving = state;
+
+	PushNode root = { cell, MOVE_NONE, -1 };
+	nodes.push_back( root );
+
+	int found = -1;
+	for( size_t head = 0; head < nodes.size() && found < 0; ++head )
+	{
+		PushNode node = nodes[ head ];
+		moving.stars[ star ] = node.cell;
+		moving.player = node.parent < 0 ? state.player : mBoard->step( node.cell, oppositeMove( node.direction ) );
+
+		//Everywhere the dot can get to without touching a star
+		buildMap( moving, moving.player, reach );
+
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int behind = mBoard->step( node.cell, oppositeMove( direction ) );
+			int next = mBoard->step( node.cell, direction );
+			if( behind < 0 || reach[ behind ] == WALK_UNREACHABLE || mBoard->isWall( next ) || findStar( moving, next ) >= 0 )
+			{
+				continue;
+			}
+
+			if( seen[ next * 4 + direction - MOVE_UP ] )
+			{
+				continue;
+			}
+			seen[ next * 4 + direction - MOVE_UP ] = 1;
+
+			PushNode child = { next, direction, (int)head };
+			nodes.push_back( child );
+			if( next == target )
+			{
+				found = (int)nodes.size() - 1;
+				break;
+			}
+		}
+	}
+
+	if( found < 0 )
+	{
+		return false;
+	}
+
+	//Collect the pushes from the start, then walk to each one's far side and push
+	std::vector<int> chain;
+	for( int i = found; nodes[ i ].parent >= 0; i = nodes[ i ].parent )
+	{
+		chain.insert( chain.begin(), i );
+	}
+
+	moving = state;
+	for( size_t i = 0; i < chain.size(); ++i )
+	{
+		const PushNode& push = nodes[ chain[ i ] ];
+		int from = nodes[ push.parent ].cell;
+		moving.stars[ star ] = from;
+
+		buildMap( moving, mBoard->step( from, oppositeMove( push.direction ) ), reach );
+		followMap( reach, moving.player, moves );
+
+		moves.push_back( push.direction );
+		moving.player = from;
+	}
+
+	return true;
+}
+
+int PathFinder::getCachedMaps() const
+{
+	return (int)mMaps.size();
+}
+
+int PathFinder::getMapBuilds() const
+{
+	return mMapBuilds;
+}
+
+const std::vector<unsigned short>& PathFinder::walkMap( const BoardState& state, int target )
+{
+	//Only moving stars makes the maps stale, the dot walking around doesn't
+	if( !sameStars( state, mMapStars ) || ( mMaps.size() + 1 ) * mBoard->getCellCount() > PATH_CACHE_CELLS )
+	{
+		mMaps.clear();
+		mMapStars = state;
+	}
+
+	std::unordered_map<int, std::vector<unsigned short> >::iterator cached = mMaps.find( target );
+	if( cached != mMaps.end() )
+	{
+		return cached->second;
+	}
+
+	std::vector<unsigned short>& distances = mMaps[ target ];
+	buildMap( state, target, distances );
+	++mMapBuilds;
+	return distances;
+}
+
+void PathFinder::buildMap( const BoardState& state, int target, std::vector<unsigned short>& distances ) const
+{
+	distances.assign( mBoard->getCellCount(), WALK_UNREACHABLE );
+	mQueue.clear();
+
+	distances[ target ] = 0;
+	mQueue.push_back( target );
+
+	for( size_t head = 0; head < mQueue.size(); ++head )
+	{
+		int cell = mQueue[ head ];
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int next = mBoard->step( cell, direction );
+			if( mBoard->isWall( next ) || distances[ next ] != WALK_UNREACHABLE || findStar( state, next ) >= 0 )
+			{
+				continue;
+			}
+
+			distances[ next ] = distances[ cell ] + 1;
+			mQueue.push_back( next );
+		}
+	}
+}
+
+void PathFinder::followMap( const std::vector<unsigned short>& distances, int start, std::vector<int>& moves ) const
+{
+	for( int cell = start; distances[ cell ] > 0 && distances[ cell ] != WALK_UNREACHABLE; )
+	{
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int next = mBoard->step( cell, direction );
+			if( next >= 0 && distances[ next ] == distances[ cell ] - 1 )
+			{
+				moves.push_back( direction );
+				cell = next;
+				break;
+			}
+		}
+	}
+}
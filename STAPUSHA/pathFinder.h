@@ -0,0 +1,55 @@
+#ifndef PATH_FINDER_H
+#define PATH_FINDER_H
+
+#include "board.h"
+
+//Using hash maps
+#include <unordered_map>
+
+//Distance of a cell the dot can't walk to the target from
+const unsigned short WALK_UNREACHABLE = 0xFFFF;
+
+//Plans click-to-move walks and star pushes over a level's wall grid
+class PathFinder
+{
+	public:
+		//Initializes the finder for a board
+		PathFinder( const Board& board );
+
+		//Forgets every cached distance map, for when the walls change
+		void invalidate();
+
+		//Finds the shortest walk to target around the stars, returns false if there is none
+		bool findWalk( const BoardState& state, int target, std::vector<int>& moves );
+
+		//Finds the moves that push the star on cell onto target in the fewest pushes
+		//Returns false if the star can't be pushed there
+		bool findPush( const BoardState& state, int cell, int target, std::vector<int>& moves );
+
+		//Gets how many distance maps are cached and how many were built in total
+		int getCachedMaps() const;
+		int getMapBuilds() const;
+
+	private:
+		//Gets the cached distance map to target, building it if the stars moved since
+		const std::vector<unsigned short>& walkMap( const BoardState& state, int target );
+
+		//Runs a BFS out from target treating walls and stars as blocked
+		void buildMap( const BoardState& state, int target, std::vector<unsigned short>& distances ) const;
+
+		//Appends the moves that follow a distance map downhill from start
+		void followMap( const std::vector<unsigned short>& distances, int start, std::vector<int>& moves ) const;
+
+		//The wall grid
+		const Board* mBoard;
+
+		//Walk distance maps by target cell, all built for the stars in mMapStars
+		std::unordered_map<int, std::vector<unsigned short> > mMaps;
+		BoardState mMapStars;
+		int mMapBuilds;
+
+		//Flood fill scratch space
+		mutable std::vector<int> mQueue;
+};
+
+#endif
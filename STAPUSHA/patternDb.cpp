@@ -0,0 +1,531 @@
+#include "patternDb.h"
+#include "heuristic.h"
+#include "parallel.h"
+
+//Using standard IO, string functions and hash sets
+#include <stdio.h>
+#include <string.h>
+#include <unordered_set>
+
+//The file format version
+const unsigned int PATTERN_DB_VERSION = 1;
+
+//The file layout and search types, kept to this file
+namespace
+{
+
+//The file starts with a header and one directory entry per level
+struct PatternDbHeader
+{
+	char magic[ 4 ];
+	unsigned int version;
+	unsigned int boardHash;
+	unsigned int cellCount;
+	unsigned int levelCount;
+};
+
+struct PatternDbLevel
+{
+	//The number of floor cells the level's dot can reach
+	unsigned int floorCount;
+
+	//Byte offsets of the cell to floor index map and the cost tables
+	unsigned int indexOffset;
+	unsigned int singleOffset;
+	unsigned int pairOffset;
+};
+
+//A node of the reverse search, the dot stands anywhere in the pocket of cell player
+struct PatternNode
+{
+	int stars[ 2 ];
+	int player;
+	int cost;
+};
+
+//The state shared by one reverse search
+struct PatternSearch
+{
+	const Board* board;
+	const std::vector<short>* cellIndex;
+	int floorCount;
+	int starCount;
+
+	//Flood fill scratch space, the pocket being expanded keeps its own stamps
+	std::vector<int> stamp;
+	std::vector<int> pocket;
+	std::vector<int> queue;
+	int mark;
+};
+
+}
+
+//Hashes everything the tables depend on
+static unsigned int patternHash( const Board& board, const LevelInfo levels[], int levelCount )
+{
+	unsigned int hash = 2166136261u;
+	std::vector<int> values;
+	values.push_back( board.getColumns() );
+	values.push_back( board.getRows() );
+
+	for( int i = 0; i < board.getCellCount(); ++i )
+	{
+		values.push_back( board.isWall( i ) ? 1 : 0 );
+	}
+
+	for( int level = 0; level < levelCount; ++level )
+	{
+		int goals[ MAX_STARS ];
+		int goalCount = levelGoalCells( board, levels[ level ], goals );
+		values.push_back( board.cellFromEntity( levels[ level ].dot.x, levels[ level ].dot.y ) );
+		values.insert( values.end(), goals, goals + goalCount );
+	}
+
+	//FNV-1a over the values
+	for( size_t i = 0; i < values.size(); ++i )
+	{
+		hash = ( hash ^ (unsigned int)values[ i ] ) * 16777619u;
+	}
+
+	return hash;
+}
+
+//Gets the table slot of a star set given as floor indices
+static int patternSlot( int starCount, int first, int second )
+{
+	if( starCount == 1 )
+	{
+		return first;
+	}
+
+	if( first > second )
+	{
+		int swap = first;
+		first = second;
+		second = swap;
+	}
+
+	return second * ( second - 1 ) / 2 + first;
+}
+
+//Floods the cells the dot reaches around the stars, returns the lowest one
+static int floodPocket( PatternSearch& search, std::vector<int>& stamp, int start, const int stars[] )
+{
+	const Board& board = *search.board;
+	int mark = ++search.mark;
+	int lowest = start;
+	int head = 0, tail = 0;
+
+	stamp[ start ] = mark;
+	search.queue[ tail++ ] = start;
+
+	while( head < tail )
+	{
+		int cell = search.queue[ head++ ];
+
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int next = board.step( cell, direction );
+			if( next < 0 || board.isWall( next ) || stamp[ next ] == mark )
+			{
+				continue;
+			}
+
+			if( next == stars[ 0 ] || ( search.starCount == 2 && next == stars[ 1 ] ) )
+			{
+				continue;
+			}
+
+			stamp[ next ] = mark;
+			search.queue[ tail++ ] = next;
+			if( next < lowest )
+			{
+				lowest = next;
+			}
+		}
+	}
+
+	return lowest;
+}
+
+//Queues a node unless its star set and pocket were seen already
+static void visitPattern( PatternSearch& search, std::unordered_set<long long>& seen, std::vector<PatternNode>& nodes, std::vector<unsigned char>& costs, const PatternNode& node )
+{
+	const std::vector<short>& index = *search.cellIndex;
+	int first = index[ node.stars[ 0 ] ];
+	int second = search.starCount == 2 ? index[ node.stars[ 1 ] ] : 0;
+	long long key = ( (long long)first * search.floorCount + second ) * search.floorCount + index[ node.player ];
+
+	if( !seen.insert( key ).second )
+	{
+		return;
+	}
+
+	nodes.push_back( node );
+
+	//Breadth first, so the first cost seen for a star set is the lowest
+	unsigned char& cost = costs[ patternSlot( search.starCount, first, second ) ];
+	if( cost == PATTERN_DEAD )
+	{
+		cost = (unsigned char)( node.cost < PATTERN_DEAD - 1 ? node.cost : PATTERN_DEAD - 1 );
+	}
+}
+
+//Pulls stars away from every goal placement to get exact costs
+static void searchPatterns( const Board& board, const LevelInfo& level, const std::vector<short>& cellIndex, const std::vector<int>& floor, int starCount, std::vector<unsigned char>& costs )
+{
+	int floorCount = (int)floor.size();
+	costs.assign( starCount == 1 ? floorCount : floorCount * ( floorCount - 1 ) / 2, PATTERN_DEAD );
+
+	PatternSearch search;
+	search.board = &board;
+	search.cellIndex = &cellIndex;
+	search.floorCount = floorCount;
+	search.starCount = starCount;
+	search.stamp.assign( board.getCellCount(), 0 );
+	search.pocket.assign( board.getCellCount(), 0 );
+	search.queue.resize( board.getCellCount() );
+	search.mark = 0;
+
+	std::unordered_set<long long> seen;
+	std::vector<PatternNode> nodes;
+
+	int goals[ MAX_STARS ];
+	int goalCount = levelGoalCells( board, level, goals );
+
+	//Seed every placement of the stars on goals, with the dot in each pocket
+	for( int a = 0; a < goalCount; ++a )
+	{
+		for( int b = a + 1; b <= goalCount; ++b )
+		{
+			//A single star only needs one goal
+			if( ( starCount == 1 ) != ( b == goalCount ) )
+			{
+				continue;
+			}
+
+			PatternNode node;
+			node.stars[ 0 ] = goals[ a ];
+			node.stars[ 1 ] = starCount == 2 ? goals[ b ] : -1;
+			node.cost = 0;
+
+			int firstMark = search.mark + 1;
+			for( int i = 0; i < floorCount; ++i )
+			{
+				int cell = floor[ i ];
+				if( cell == node.stars[ 0 ] || cell == node.stars[ 1 ] || search.stamp[ cell ] >= firstMark )
+				{
+					continue;
+				}
+
+				node.player = floodPocket( search, search.stamp, cell, node.stars );
+				visitPattern( search, seen, nodes, costs, node );
+			}
+		}
+	}
+
+	for( size_t head = 0; head < nodes.size(); ++head )
+	{
+		PatternNode node = nodes[ head ];
+		floodPocket( search, search.pocket, node.player, node.stars );
+		int pocket = search.mark;
+
+		for( int star = 0; star < starCount; ++star )
+		{
+			for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+			{
+				//The dot walks up to the star and pulls it toward itself
+				int to = board.step( node.stars[ star ], oppositeMove( direction ) );
+				if( to < 0 || search.pocket[ to ] != pocket )
+				{
+					continue;
+				}
+
+				int player = board.step( to, oppositeMove( direction ) );
+				if( player < 0 || board.isWall( player ) || player == node.stars[ 0 ] || player == node.stars[ 1 ] )
+				{
+					continue;
+				}
+
+				PatternNode next = node;
+				next.stars[ star ] = to;
+				next.cost = node.cost + 1;
+				next.player = floodPocket( search, search.stamp, player, next.stars );
+				visitPattern( search, seen, nodes, costs, next );
+			}
+		}
+	}
+}
+
+bool buildPatternDatabase( const Board& board, const LevelInfo levels[], int levelCount, const std::string& path )
+{
+	int cellCount = board.getCellCount();
+	std::vector< std::vector<short> > cellIndex( levelCount );
+	std::vector< std::vector<int> > floor( levelCount );
+
+	//Number the floor cells each level's dot can reach
+	for( int level = 0; level < levelCount; ++level )
+	{
+		int start = board.cellFromEntity( levels[ level ].dot.x, levels[ level ].dot.y );
+		cellIndex[ level ].assign( cellCount, -1 );
+		cellIndex[ level ][ start ] = 0;
+		floor[ level ].push_back( start );
+
+		for( size_t i = 0; i < floor[ level ].size(); ++i )
+		{
+			for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+			{
+				int next = board.step( floor[ level ][ i ], direction );
+				if( next >= 0 && !board.isWall( next ) && cellIndex[ level ][ next ] < 0 )
+				{
+					cellIndex[ level ][ next ] = (short)floor[ level ].size();
+					floor[ level ].push_back( next );
+				}
+			}
+		}
+	}
+
+	//Every level's single and pair tables are independent jobs
+	std::vector< std::vector<unsigned char> > tables( levelCount * 2 );
+	parallelFor( levelCount * 2, [ & ]( int job )
+	{
+		int level = job / 2;
+		searchPatterns( board, levels[ level ], cellIndex[ level ], floor[ level ], job % 2 + 1, tables[ job ] );
+	} );
+
+	//Lay the tables out after the header and directory
+	PatternDbHeader header;
+	memcpy( header.magic, "SPDB", 4 );
+	header.version = PATTERN_DB_VERSION;
+	header.boardHash = patternHash( board, levels, levelCount );
+	header.cellCount = cellCount;
+	header.levelCount = levelCount;
+
+	std::vector<PatternDbLevel> directory( levelCount );
+	unsigned int offset = sizeof( header ) + sizeof( PatternDbLevel ) * levelCount;
+	for( int level = 0; level < levelCount; ++level )
+	{
+		//Keep the index map two byte aligned
+		offset = ( offset + 1 ) & ~1u;
+		directory[ level ].floorCount = (unsigned int)floor[ level ].size();
+		directory[ level ].indexOffset = offset;
+		offset += cellCount * sizeof( short );
+		directory[ level ].singleOffset = offset;
+		offset += (unsigned int)tables[ level * 2 ].size();
+		directory[ level ].pairOffset = offset;
+		offset += (unsigned int)tables[ level * 2 + 1 ].size();
+	}
+
+	//Write beside the old database and swap it in, a game with the old one mapped keeps reading whole tables
+	std::string temporary = path + ".tmp";
+	FILE* file = fopen( temporary.c_str(), "wb" );
+	if( file == NULL )
+	{
+		printf( "Unable to write pattern database %s!\n", temporary.c_str() );
+		return false;
+	}
+
+	bool success = fwrite( &header, sizeof( header ), 1, file ) == 1;
+	success = success && fwrite( &directory[ 0 ], sizeof( PatternDbLevel ), levelCount, file ) == (size_t)levelCount;
+	for( int level = 0; level < levelCount && success; ++level )
+	{
+		//Pad up to the aligned offset
+		while( success && ftell( file ) < (long)directory[ level ].indexOffset )
+		{
+			success = fputc( 0, file ) != EOF;
+		}
+
+		success = success && fwrite( &cellIndex[ level ][ 0 ], sizeof( short ), cellCount, file ) == (size_t)cellCount;
+		if( !tables[ level * 2 ].empty() )
+		{
+			success = success && fwrite( &tables[ level * 2 ][ 0 ], 1, tables[ level * 2 ].size(), file ) == tables[ level * 2 ].size();
+		}
+		if( !tables[ level * 2 + 1 ].empty() )
+		{
+			success = success && fwrite( &tables[ level * 2 + 1 ][ 0 ], 1, tables[ level * 2 + 1 ].size(), file ) == tables[ level * 2 + 1 ].size();
+		}
+	}
+
+	success = success && ferror( file ) == 0;
+	if( fclose( file ) != 0 || !success )
+	{
+		printf( "Unable to write pattern database %s!\n", temporary.c_str() );
+		remove( temporary.c_str() );
+		return false;
+	}
+
+	#ifdef _WIN32
+	remove( path.c_str() );
+	#endif
+	if( rename( temporary.c_str(), path.c_str() ) != 0 )
+	{
+		printf( "Unable to replace pattern database %s!\n", path.c_str() );
+		remove( temporary.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+PatternDatabase::PatternDatabase()
+{
+	//Initialize
+	mLevelCount = 0;
+}
+
+bool PatternDatabase::open( const std::string& path, const Board& board, const LevelInfo levels[], int levelCount )
+{
+	close();
+
+	if( !mFile.open( path ) )
+	{
+		return false;
+	}
+
+	//Reject files built for a different layout
+	const PatternDbHeader* header = (const PatternDbHeader*)mFile.getData();
+	if( mFile.getSize() < sizeof( PatternDbHeader ) + sizeof( PatternDbLevel ) * levelCount
+		|| memcmp( header->magic, "SPDB", 4 ) != 0
+		|| header->version != PATTERN_DB_VERSION
+		|| header->boardHash != patternHash( board, levels, levelCount )
+		|| header->cellCount != (unsigned int)board.getCellCount()
+		|| header->levelCount != (unsigned int)levelCount )
+	{
+		printf( "Pattern database %s does not match the level set!\n", path.c_str() );
+		close();
+		return false;
+	}
+
+	//Make sure every table lies inside the file
+	const PatternDbLevel* directory = (const PatternDbLevel*)( header + 1 );
+	for( int level = 0; level < levelCount; ++level )
+	{
+		size_t floorCount = directory[ level ].floorCount;
+		if( directory[ level ].pairOffset + floorCount * ( floorCount - 1 ) / 2 > mFile.getSize() )
+		{
+			printf( "Pattern database %s is truncated!\n", path.c_str() );
+			close();
+			return false;
+		}
+	}
+
+	mLevelCount = levelCount;
+	return true;
+}
+
+void PatternDatabase::close()
+{
+	mFile.close();
+	mLevelCount = 0;
+}
+
+bool PatternDatabase::isOpen() const
+{
+	return mLevelCount > 0;
+}
+
+int PatternDatabase::singleCost( int level, int cell ) const
+{
+	const unsigned char* data = mFile.getData();
+	const PatternDbLevel& entry = ( (const PatternDbLevel*)( data + sizeof( PatternDbHeader ) ) )[ level ];
+	int index = ( (const short*)( data + entry.indexOffset ) )[ cell ];
+
+	return index < 0 ? PATTERN_DEAD : data[ entry.singleOffset + index ];
+}
+
+int PatternDatabase::pairCost( int level, int cellA, int cellB ) const
+{
+	const unsigned char* data = mFile.getData();
+	const PatternDbLevel& entry = ( (const PatternDbLevel*)( data + sizeof( PatternDbHeader ) ) )[ level ];
+	const short* index = (const short*)( data + entry.indexOffset );
+	int first = index[ cellA ], second = index[ cellB ];
+
+	//Stars the dot can't reach, or two stars on one cell, tell us nothing
+	if( first < 0 || second < 0 || first == second )
+	{
+		return 0;
+	}
+
+	return data[ entry.pairOffset + patternSlot( 2, first, second ) ];
+}
+
+int PatternDatabase::lowerBound( int level, const int stars[], int starCount ) const
+{
+	int bound = starCount <= 8 ? bestPairing( level, stars, starCount, 0 ) : 0;
+
+	//Too many stars to try every pairing, so pair neighbours in the list
+	if( starCount > 8 )
+	{
+		for( int i = 0; i < starCount && bound < HEURISTIC_DEADLOCK; i += 2 )
+		{
+			int cost = i + 1 < starCount ? pairCost( level, stars[ i ], stars[ i + 1 ] ) : singleCost( level, stars[ i ] );
+			bound = cost == PATTERN_DEAD ? HEURISTIC_DEADLOCK : bound + cost;
+		}
+	}
+
+	return bound;
+}
+
+int PatternDatabase::bestPairing( int level, const int stars[], int starCount, unsigned int used ) const
+{
+	//Find the first star not paired yet
+	int first = 0;
+	int unpaired = 0;
+	for( int i = starCount - 1; i >= 0; --i )
+	{
+		if( !( used & ( 1u << i ) ) )
+		{
+			first = i;
+			++unpaired;
+		}
+	}
+
+	if( unpaired == 0 )
+	{
+		return 0;
+	}
+
+	used |= 1u << first;
+	int best = -1;
+
+	//With an odd count one star is costed alone, and it may be this one
+	if( unpaired % 2 == 1 )
+	{
+		int cost = singleCost( level, stars[ first ] );
+		int rest = bestPairing( level, stars, starCount, used );
+		if( cost == PATTERN_DEAD || rest == HEURISTIC_DEADLOCK )
+		{
+			return HEURISTIC_DEADLOCK;
+		}
+
+		best = cost + rest;
+	}
+
+	for( int second = first + 1; second < starCount; ++second )
+	{
+		if( used & ( 1u << second ) )
+		{
+			continue;
+		}
+
+		//Two stars that can't be solved even alone can't be solved at all
+		int cost = pairCost( level, stars[ first ], stars[ second ] );
+		if( cost == PATTERN_DEAD )
+		{
+			return HEURISTIC_DEADLOCK;
+		}
+
+		int rest = bestPairing( level, stars, starCount, used | ( 1u << second ) );
+		if( rest == HEURISTIC_DEADLOCK )
+		{
+			return HEURISTIC_DEADLOCK;
+		}
+
+		if( cost + rest > best )
+		{
+			best = cost + rest;
+		}
+	}
+
+	return best;
+}
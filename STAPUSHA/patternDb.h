@@ -0,0 +1,53 @@
+#ifndef PATTERN_DB_H
+#define PATTERN_DB_H
+
+#include "board.h"
+#include "levels.h"
+#include "mappedFile.h"
+
+//The pattern database that goes with the shipped tile map
+const char PATTERN_DB_PATH[] = "39_tiling/levelOne.pdb";
+
+//Stored cost of star placements no push sequence solves
+const int PATTERN_DEAD = 255;
+
+//Builds exact one and two star costs for every level and writes them to path
+bool buildPatternDatabase( const Board& board, const LevelInfo levels[], int levelCount, const std::string& path );
+
+//Exact push costs for small star subsets, mapped from a file built offline
+class PatternDatabase
+{
+	public:
+		//Initializes variables
+		PatternDatabase();
+
+		//Maps the database, fails if it was built for another board or level set
+		bool open( const std::string& path, const Board& board, const LevelInfo levels[], int levelCount );
+
+		//Unmaps the database
+		void close();
+
+		//Checks whether a database is mapped
+		bool isOpen() const;
+
+		//Gets the pushes one star needs to reach any goal, ignoring other stars
+		int singleCost( int level, int cell ) const;
+
+		//Gets the pushes two stars need to fill two goals, ignoring other stars
+		int pairCost( int level, int cellA, int cellB ) const;
+
+		//Gets the best sum of costs over disjoint pairs of the stars
+		int lowerBound( int level, const int stars[], int starCount ) const;
+
+	private:
+		//Gets the best pairing sum of the stars not yet in used
+		int bestPairing( int level, const int stars[], int starCount, unsigned int used ) const;
+
+		//The mapped file
+		MappedFile mFile;
+
+		//The number of levels in the file
+		int mLevelCount;
+};
+
+#endif
@@ -0,0 +1,33 @@
+/*Builds the pattern database for the shipped levels.
+Run from the STAPUSHA directory after every change to levelOne.map.*/
+
+//Using standard IO and timers
+#include <stdio.h>
+#include <chrono>
+
+#include "board.h"
+#include "levels.h"
+#include "patternDb.h"
+
+int main( int argc, char* args[] )
+{
+	//Build from the same wall grid setTiles loads
+	Board board;
+	if( !board.loadFromFile( LEVEL_MAP_PATH ) )
+	{
+		printf( "Failed to load board!\n" );
+		return 1;
+	}
+
+	const char* path = argc > 1 ? args[ 1 ] : PATTERN_DB_PATH;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if( !buildPatternDatabase( board, gLevels, TOTAL_LEVELS, path ) )
+	{
+		printf( "Failed to build pattern database!\n" );
+		return 1;
+	}
+
+	printf( "Wrote %s in %.1f ms\n", path, std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count() );
+	return 0;
+}
@@ -0,0 +1,255 @@
+#include "solutionOptimizer.h"
+
+//Reordering passes unless setReorderPasses says otherwise
+const int DEFAULT_REORDER_PASSES = 4;
+
+//Checks whether two states have their stars on the same cells
+static bool sameStars( const BoardState& a, const BoardState& b )
+{
+	for( int i = 0; i < a.starCount; ++i )
+	{
+		if( a.stars[ i ] != b.stars[ i ] )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+SolutionOptimizer::SolutionOptimizer( const Board& board, const BoardState& start, const int goals[], int goalCount ) : mFinder( board )
+{
+	//Initialize
+	mBoard = &board;
+	mStart = start;
+	mGoalCount = goalCount;
+	for( int i = 0; i < goalCount; ++i )
+	{
+		mGoals[ i ] = goals[ i ];
+	}
+	mReorderPasses = DEFAULT_REORDER_PASSES;
+}
+
+void SolutionOptimizer::setReorderPasses( int passes )
+{
+	mReorderPasses = passes;
+}
+
+bool SolutionOptimizer::optimize( const std::vector<int>& moves, std::vector<int>& optimized, OptimizeResult* result )
+{
+	optimized.clear();
+
+	//The pushes are all that matters, the walks between them get replanned
+	std::vector<SolutionPush> pushes;
+	if( !collectPushes( moves, pushes ) )
+	{
+		return false;
+	}
+
+	int pushesBefore = 0;
+	verify( moves, &pushesBefore );
+
+	//Replanning walks alone can't fail, every push was made from a cell the dot reached
+	if( !buildMoves( pushes, optimized ) )
+	{
+		optimized.clear();
+		return false;
+	}
+
+	removeLoops( pushes, optimized );
+	reorderRuns( pushes, optimized );
+
+	//Never hand back something worse or broken
+	if( optimized.size() > moves.size() || !verify( optimized ) )
+	{
+		optimized = moves;
+	}
+
+	if( result != NULL )
+	{
+		result->movesBefore = (int)moves.size();
+		result->movesAfter = (int)optimized.size();
+		result->pushesBefore = pushesBefore;
+		verify( optimized, &result->pushesAfter );
+	}
+
+	return true;
+}
+
+bool SolutionOptimizer::verify( const std::vector<int>& moves, int* pushes ) const
+{
+	BoardState state = mStart;
+	int pushCount = 0;
+	for( size_t i = 0; i < moves.size(); ++i )
+	{
+		if( moves[ i ] == MOVE_RESET )
+		{
+			state = mStart;
+			continue;
+		}
+
+		//Blocked moves leave the dot where it is, just like in the game
+		bool pushed = false;
+		if( mBoard->applyMove( state, moves[ i ], &pushed ) && pushed )
+		{
+			++pushCount;
+		}
+	}
+
+	if( pushes != NULL )
+	{
+		*pushes = pushCount;
+	}
+
+	return isSolved( state, mGoals, mGoalCount );
+}
+
+bool SolutionOptimizer::collectPushes( const std::vector<int>& moves, std::vector<SolutionPush>& pushes ) const
+{
+	pushes.clear();
+	BoardState state = mStart;
+	for( size_t i = 0; i < moves.size(); ++i )
+	{
+		//Everything before a reset was thrown away
+		if( moves[ i ] == MOVE_RESET )
+		{
+			state = mStart;
+			pushes.clear();
+			continue;
+		}
+
+		bool pushed = false;
+		int from = state.player;
+		if( mBoard->applyMove( state, moves[ i ], &pushed ) && pushed )
+		{
+			SolutionPush push = { mBoard->step( from, moves[ i ] ), moves[ i ] };
+			pushes.push_back( push );
+
+			//Anything after the first solved state is wandering
+			if( isSolved( state, mGoals, mGoalCount ) )
+			{
+				return true;
+			}
+		}
+	}
+
+	return isSolved( state, mGoals, mGoalCount );
+}
+
+bool SolutionOptimizer::buildMoves( const std::vector<SolutionPush>& pushes, std::vector<int>& moves )
+{
+	moves.clear();
+	BoardState state = mStart;
+	for( size_t i = 0; i < pushes.size(); ++i )
+	{
+		//Walk to the cell behind the star, then push
+		int behind = mBoard->step( pushes[ i ].cell, oppositeMove( pushes[ i ].direction ) );
+		if( behind < 0 || findStar( state, pushes[ i ].cell ) < 0 )
+		{
+			return false;
+		}
+
+		if( behind != state.player )
+		{
+			if( !mFinder.findWalk( state, behind, mWalk ) )
+			{
+				return false;
+			}
+
+			moves.insert( moves.end(), mWalk.begin(), mWalk.end() );
+			state.player = behind;
+		}
+
+		bool pushed = false;
+		if( !mBoard->applyMove( state, pushes[ i ].direction, &pushed ) || !pushed )
+		{
+			return false;
+		}
+		moves.push_back( pushes[ i ].direction );
+	}
+
+	return isSolved( state, mGoals, mGoalCount );
+}
+
+void SolutionOptimizer::removeLoops( std::vector<SolutionPush>& pushes, std::vector<int>& best )
+{
+	std::vector<BoardState> states;
+	std::vector<SolutionPush> trial;
+	bool cut = true;
+	while( cut )
+	{
+		cut = false;
+
+		//The stars after each push, index 0 being the start
+		states.assign( 1, mStart );
+		BoardState state = mStart;
+		for( size_t i = 0; i < pushes.size(); ++i )
+		{
+			state.player = mBoard->step( pushes[ i ].cell, oppositeMove( pushes[ i ].direction ) );
+			mBoard->applyMove( state, pushes[ i ].direction );
+			states.push_back( state );
+		}
+
+		//Drop the pushes between two states with the same stars, longest stretch first
+		for( size_t i = 0; i < states.size() && !cut; ++i )
+		{
+			for( size_t j = states.size() - 1; j > i + 1 && !cut; --j )
+			{
+				if( !sameStars( states[ i ], states[ j ] ) )
+				{
+					continue;
+				}
+
+				//The dot has to be able to walk on from where the earlier push left it
+				trial.assign( pushes.begin(), pushes.begin() + i );
+				trial.insert( trial.end(), pushes.begin() + j, pushes.end() );
+				if( buildMoves( trial, mCandidate ) && mCandidate.size() < best.size() )
+				{
+					best.swap( mCandidate );
+					pushes.swap( trial );
+					cut = true;
+				}
+			}
+		}
+	}
+}
+
+void SolutionOptimizer::reorderRuns( std::vector<SolutionPush>& pushes, std::vector<int>& best )
+{
+	for( int pass = 0; pass < mReorderPasses; ++pass )
+	{
+		//Split the pushes into runs on one star
+		std::vector<int> runStarts( 1, 0 );
+		for( size_t i = 1; i < pushes.size(); ++i )
+		{
+			if( pushes[ i ].cell != mBoard->step( pushes[ i - 1 ].cell, pushes[ i - 1 ].direction ) )
+			{
+				runStarts.push_back( (int)i );
+			}
+		}
+		runStarts.push_back( (int)pushes.size() );
+
+		//Swap each pair of neighbouring runs and keep the first swap that helps
+		bool improved = false;
+		std::vector<SolutionPush> trial;
+		for( size_t r = 0; r + 2 < runStarts.size() && !improved; ++r )
+		{
+			trial.assign( pushes.begin(), pushes.begin() + runStarts[ r ] );
+			trial.insert( trial.end(), pushes.begin() + runStarts[ r + 1 ], pushes.begin() + runStarts[ r + 2 ] );
+			trial.insert( trial.end(), pushes.begin() + runStarts[ r ], pushes.begin() + runStarts[ r + 1 ] );
+			trial.insert( trial.end(), pushes.begin() + runStarts[ r + 2 ], pushes.end() );
+
+			if( buildMoves( trial, mCandidate ) && mCandidate.size() < best.size() )
+			{
+				best.swap( mCandidate );
+				pushes.swap( trial );
+				improved = true;
+			}
+		}
+
+		if( !improved )
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#ifndef SOLUTION_OPTIMIZER_H
+#define SOLUTION_OPTIMIZER_H
+
+#include "board.h"
+#include "pathFinder.h"
+
+//Using vectors
+#include <vector>
+
+//One star push, by the cell the star stood on and the direction it went
+struct SolutionPush
+{
+	int cell;
+	int direction;
+};
+
+//How much a solution shrank
+struct OptimizeResult
+{
+	int movesBefore;
+	int movesAfter;
+	int pushesBefore;
+	int pushesAfter;
+};
+
+//Shortens recorded solutions for one level, keeping the same end result
+class SolutionOptimizer
+{
+	public:
+		//Initializes the optimizer for a level's start and goals
+		SolutionOptimizer( const Board& board, const BoardState& start, const int goals[], int goalCount );
+
+		//Sets how many passes the push reordering search may make
+		void setReorderPasses( int passes );
+
+		//Shortens a move sequence of the codes Dot::handleEvent produces, resets included
+		//Returns false, leaving optimized empty, if the moves don't solve the level
+		bool optimize( const std::vector<int>& moves, std::vector<int>& optimized, OptimizeResult* result = NULL );
+
+		//Checks a move sequence against the game rules, returns true if it ends solved
+		bool verify( const std::vector<int>& moves, int* pushes = NULL ) const;
+
+	private:
+		//Plays moves and collects the pushes up to the first solved state, returns false if it's never solved
+		bool collectPushes( const std::vector<int>& moves, std::vector<SolutionPush>& pushes ) const;
+
+		//Rebuilds moves from pushes with the shortest walk before each one, returns false if a push can't be made
+		bool buildMoves( const std::vector<SolutionPush>& pushes, std::vector<int>& moves );
+
+		//Cuts out push runs that end with the stars where they started
+		void removeLoops( std::vector<SolutionPush>& pushes, std::vector<int>& best );
+
+		//Tries swapping neighbouring runs of pushes on the same star, keeping swaps that shorten the solution
+		void reorderRuns( std::vector<SolutionPush>& pushes, std::vector<int>& best );
+
+		//The level
+		const Board* mBoard;
+		BoardState mStart;
+		int mGoals[ MAX_STARS ];
+		int mGoalCount;
+
+		//The search limit
+		int mReorderPasses;
+
+		//Walk planning and scratch space
+		PathFinder mFinder;
+		std::vector<int> mWalk;
+		std::vector<int> mCandidate;
+};
+
+#endif
@@ -0,0 +1,538 @@
+#include "solver.h"
+
+//Using priority queues, hash maps and limits
+#include <queue>
+#include <unordered_map>
+#include <limits.h>
+
+//How often the search polls its cancel check
+const int SOLVER_CANCEL_INTERVAL = 256;
+
+//The search's own types, kept to this file
+namespace
+{
+
+//A searched state with the move that reached it
+struct SolverNode
+{
+	BoardState state;
+	int cost;
+	int estimate;
+	int parent;
+	int move;
+
+	//Moves a macro made after move, -1 for a single move
+	int macro;
+};
+
+//An open list entry, ordered by lowest total and then deepest
+struct SolverEntry
+{
+	int total;
+	int cost;
+	int node;
+
+	bool operator<( const SolverEntry& other ) const
+	{
+		if( total != other.total )
+		{
+			return total > other.total;
+		}
+
+		return cost < other.cost;
+	}
+};
+
+//The two directions of a bidirectional search
+const int SEARCH_FORWARD = 0;
+const int SEARCH_BACKWARD = 1;
+
+//The node each direction reached a state with, -1 where it hasn't yet
+struct SolverMeeting
+{
+	int node[ 2 ];
+};
+
+}
+
+//Moves one star and slides it back into sorted order
+static void moveStarCell( BoardState& state, int star, int cell )
+{
+	while( star > 0 && state.stars[ star - 1 ] > cell )
+	{
+		state.stars[ star ] = state.stars[ star - 1 ];
+		--star;
+	}
+	while( star + 1 < state.starCount && state.stars[ star + 1 ] < cell )
+	{
+		state.stars[ star ] = state.stars[ star + 1 ];
+		++star;
+	}
+	state.stars[ star ] = cell;
+}
+
+size_t BoardStateHash::operator()( const BoardState& state ) const
+{
+	//FNV-1a over the cells
+	size_t hash = 2166136261u;
+	hash = ( hash ^ (size_t)state.player ) * 16777619u;
+	for( int i = 0; i < state.starCount; ++i )
+	{
+		hash = ( hash ^ (size_t)state.stars[ i ] ) * 16777619u;
+	}
+
+	return hash;
+}
+
+bool BoardStateEqual::operator()( const BoardState& a, const BoardState& b ) const
+{
+	if( a.player != b.player || a.starCount != b.starCount )
+	{
+		return false;
+	}
+
+	for( int i = 0; i < a.starCount; ++i )
+	{
+		if( a.stars[ i ] != b.stars[ i ] )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Solver::Solver( const Board& board, const int goals[], int goalCount ) : mHeuristic( mDistances ), mStartHeuristic( mStartDistances )
+{
+	//Initialize
+	mBoard = &board;
+	mGoalCount = goalCount;
+	for( int i = 0; i < goalCount; ++i )
+	{
+		mGoals[ i ] = goals[ i ];
+	}
+
+	mDistances.build( board, goals, goalCount );
+	mDatabase = NULL;
+	mDatabaseLevel = 0;
+	mBidirectional = false;
+	mMacroMoves = false;
+	mNodeLimit = 2000000;
+	mExpandedNodes = 0;
+	mStopped = false;
+}
+
+void Solver::setPatternDatabase( const PatternDatabase* database, int level )
+{
+	mDatabase = database != NULL && database->isOpen() ? database : NULL;
+	mDatabaseLevel = level;
+}
+
+void Solver::setNodeLimit( int limit )
+{
+	mNodeLimit = limit;
+}
+
+void Solver::setBidirectional( bool enabled )
+{
+	mBidirectional = enabled;
+}
+
+void Solver::setMacroMoves( bool enabled )
+{
+	mMacroMoves = enabled;
+}
+
+void Solver::setCancelCheck( const std::function<bool()>& cancelled )
+{
+	mCancelled = cancelled;
+}
+
+int Solver::estimate( const BoardState& state )
+{
+	int value = mHeuristic.reset( state.stars, state.starCount );
+
+	if( mDatabase != NULL && value != HEURISTIC_DEADLOCK )
+	{
+		int bound = mDatabase->lowerBound( mDatabaseLevel, state.stars, state.starCount );
+		value = bound > value ? bound : value;
+	}
+
+	return value;
+}
+
+bool Solver::solve( const BoardState& start, std::vector<int>& moves )
+{
+	moves.clear();
+	mExpandedNodes = 0;
+	mStopped = false;
+
+	//Searching backward needs exactly one solved star layout to start from
+	if( mBidirectional && start.starCount == mGoalCount )
+	{
+		return solveBidirectional( start, moves );
+	}
+
+	return solveForward( start, moves );
+}
+
+bool Solver::solveForward( const BoardState& start, std::vector<int>& moves )
+{
+	std::vector<SolverNode> nodes;
+	std::priority_queue<SolverEntry> open;
+	std::unordered_map<BoardState, int, BoardStateHash, BoardStateEqual> best;
+
+	//The moves each macro made after its first push
+	std::vector<std::vector<int> > macros;
+	if( mMacroMoves )
+	{
+		mMacros.build( *mBoard, start, mGoals, mGoalCount );
+	}
+
+	SolverNode root;
+	root.state = start;
+	root.cost = 0;
+	root.estimate = estimate( start );
+	root.parent = -1;
+	root.move = MOVE_NONE;
+	root.macro = -1;
+	if( root.estimate == HEURISTIC_DEADLOCK )
+	{
+		return false;
+	}
+
+	nodes.push_back( root );
+	best[ start ] = 0;
+
+	SolverEntry entry = { root.estimate, 0, 0 };
+	open.push( entry );
+
+	while( !open.empty() )
+	{
+		SolverEntry current = open.top();
+		open.pop();
+
+		//Skip entries a cheaper path replaced
+		SolverNode node = nodes[ current.node ];
+		if( best[ node.state ] < node.cost )
+		{
+			continue;
+		}
+
+		if( isSolved( node.state, mGoals, mGoalCount ) )
+		{
+			//Walk the parents back to the start
+			for( int i = current.node; nodes[ i ].parent >= 0; i = nodes[ i ].parent )
+			{
+				if( nodes[ i ].macro >= 0 )
+				{
+					moves.insert( moves.begin(), macros[ nodes[ i ].macro ].begin(), macros[ nodes[ i ].macro ].end() );
+				}
+				moves.insert( moves.begin(), nodes[ i ].move );
+			}
+
+			return true;
+		}
+
+		if( ++mExpandedNodes > mNodeLimit || ( mExpandedNodes % SOLVER_CANCEL_INTERVAL == 0 && mCancelled && mCancelled() ) )
+		{
+			mStopped = true;
+			return false;
+		}
+
+		//Prime the matching once so each push only repairs it
+		bool primed = false;
+
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			SolverNode child = node;
+			bool pushed = false;
+			if( !mBoard->applyMove( child.state, direction, &pushed ) )
+			{
+				continue;
+			}
+
+			child.cost = node.cost + 1;
+			child.parent = current.node;
+			child.move = direction;
+			child.macro = -1;
+			std::vector<int> extra;
+
+			//Only pushes change the estimate
+			if( pushed )
+			{
+				if( !primed )
+				{
+					mHeuristic.reset( node.state.stars, node.state.starCount );
+					primed = true;
+				}
+
+				int origin = child.state.player;
+				int from = findStar( node.state, origin );
+				int to = mBoard->step( origin, direction );
+
+				//Carry the push on through a tunnel or into a goal room as part of the same step
+				if( mMacroMoves && mMacros.extend( child.state, direction, extra, to ) )
+				{
+					child.cost += (int)extra.size();
+				}
+
+				child.estimate = mHeuristic.moveStar( from, to );
+				mHeuristic.moveStar( from, origin );
+
+				if( mDatabase != NULL && child.estimate != HEURISTIC_DEADLOCK )
+				{
+					int bound = mDatabase->lowerBound( mDatabaseLevel, child.state.stars, child.state.starCount );
+					child.estimate = bound > child.estimate ? bound : child.estimate;
+				}
+
+				if( child.estimate == HEURISTIC_DEADLOCK )
+				{
+					continue;
+				}
+			}
+
+			std::unordered_map<BoardState, int, BoardStateHash, BoardStateEqual>::iterator seen = best.find( child.state );
+			if( seen != best.end() && seen->second <= child.cost )
+			{
+				continue;
+			}
+
+			best[ child.state ] = child.cost;
+			if( !extra.empty() )
+			{
+				child.macro = (int)macros.size();
+				macros.push_back( extra );
+			}
+			nodes.push_back( child );
+
+			SolverEntry next = { child.cost + child.estimate, child.cost, (int)nodes.size() - 1 };
+			open.push( next );
+		}
+	}
+
+	return false;
+}
+
+bool Solver::solveBidirectional( const BoardState& start, std::vector<int>& moves )
+{
+	if( isSolved( start, mGoals, mGoalCount ) )
+	{
+		return true;
+	}
+
+	//Backward states are estimated by the pushes needed to get their stars out of the start
+	mStartDistances.buildFrom( *mBoard, start.stars, start.starCount );
+
+	std::vector<SolverNode> nodes[ 2 ];
+	std::priority_queue<SolverEntry> open[ 2 ];
+	std::unordered_map<BoardState, SolverMeeting, BoardStateHash, BoardStateEqual> seen;
+
+	//The cheapest full path found so far, through the node pair where the searches met
+	int bestCost = INT_MAX;
+	int meetForward = -1, meetBackward = -1;
+
+	//Adds a node to one direction unless it has the state more cheaply, and checks for a meeting
+	auto offer = [ & ]( int side, const SolverNode& child )
+	{
+		SolverMeeting unseen = { { -1, -1 } };
+		SolverMeeting& meeting = seen.insert( std::make_pair( child.state, unseen ) ).first->second;
+		if( meeting.node[ side ] >= 0 && nodes[ side ][ meeting.node[ side ] ].cost <= child.cost )
+		{
+			return;
+		}
+
+		nodes[ side ].push_back( child );
+		meeting.node[ side ] = (int)nodes[ side ].size() - 1;
+
+		SolverEntry next = { child.cost + child.estimate, child.cost, meeting.node[ side ] };
+		open[ side ].push( next );
+
+		int other = meeting.node[ 1 - side ];
+		if( other >= 0 && child.cost + nodes[ 1 - side ][ other ].cost < bestCost )
+		{
+			bestCost = child.cost + nodes[ 1 - side ][ other ].cost;
+			meetForward = side == SEARCH_FORWARD ? meeting.node[ side ] : other;
+			meetBackward = side == SEARCH_BACKWARD ? meeting.node[ side ] : other;
+		}
+	};
+
+	SolverNode root;
+	root.state = start;
+	root.cost = 0;
+	root.estimate = estimate( start );
+	root.parent = -1;
+	root.move = MOVE_NONE;
+	root.macro = -1;
+	if( root.estimate == HEURISTIC_DEADLOCK )
+	{
+		return false;
+	}
+	offer( SEARCH_FORWARD, root );
+
+	//Every star on a goal, with the dot where the last push left it, behind one of them
+	BoardState solved;
+	solved.starCount = mGoalCount;
+	for( int i = 0; i < mGoalCount; ++i )
+	{
+		solved.stars[ i ] = mGoals[ i ];
+	}
+	sortStars( solved );
+
+	root.state = solved;
+	root.estimate = mStartHeuristic.reset( solved.stars, solved.starCount );
+	if( root.estimate == HEURISTIC_DEADLOCK )
+	{
+		return false;
+	}
+
+	for( int i = 0; i < solved.starCount; ++i )
+	{
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			int behind = mBoard->step( solved.stars[ i ], direction );
+			if( behind >= 0 && !mBoard->isWall( behind ) && findStar( solved, behind ) < 0 )
+			{
+				root.state.player = behind;
+				offer( SEARCH_BACKWARD, root );
+			}
+		}
+	}
+
+	while( !open[ SEARCH_FORWARD ].empty() && !open[ SEARCH_BACKWARD ].empty() )
+	{
+		//Done once neither frontier can lead to anything cheaper than the best meeting
+		if( bestCost <= open[ SEARCH_FORWARD ].top().total || bestCost <= open[ SEARCH_BACKWARD ].top().total )
+		{
+			break;
+		}
+
+		//Grow the smaller frontier
+		int side = open[ SEARCH_FORWARD ].size() <= open[ SEARCH_BACKWARD ].size() ? SEARCH_FORWARD : SEARCH_BACKWARD;
+		SolverEntry current = open[ side ].top();
+		open[ side ].pop();
+
+		//Skip entries a cheaper path replaced
+		SolverNode node = nodes[ side ][ current.node ];
+		if( seen[ node.state ].node[ side ] != current.node )
+		{
+			continue;
+		}
+
+		if( ++mExpandedNodes > mNodeLimit || ( mExpandedNodes % SOLVER_CANCEL_INTERVAL == 0 && mCancelled && mCancelled() ) )
+		{
+			mStopped = true;
+			return false;
+		}
+
+		//Prime the matching once so each push or pull only repairs it
+		bool primed = false;
+
+		for( int direction = MOVE_UP; direction <= MOVE_RIGHT; ++direction )
+		{
+			SolverNode child = node;
+			child.cost = node.cost + 1;
+			child.parent = current.node;
+			child.move = direction;
+
+			if( side == SEARCH_FORWARD )
+			{
+				bool pushed = false;
+				if( !mBoard->applyMove( child.state, direction, &pushed ) )
+				{
+					continue;
+				}
+
+				//Only pushes change the estimate
+				if( pushed )
+				{
+					if( !primed )
+					{
+						mHeuristic.reset( node.state.stars, node.state.starCount );
+						primed = true;
+					}
+
+					int from = findStar( node.state, child.state.player );
+					int to = mBoard->step( child.state.player, direction );
+					child.estimate = mHeuristic.moveStar( from, to );
+					mHeuristic.moveStar( from, child.state.player );
+
+					if( mDatabase != NULL && child.estimate != HEURISTIC_DEADLOCK )
+					{
+						int bound = mDatabase->lowerBound( mDatabaseLevel, child.state.stars, child.state.starCount );
+						child.estimate = bound > child.estimate ? bound : child.estimate;
+					}
+
+					if( child.estimate == HEURISTIC_DEADLOCK )
+					{
+						continue;
+					}
+				}
+
+				offer( SEARCH_FORWARD, child );
+				continue;
+			}
+
+			//Undo a move that ended here, the dot steps back off its cell
+			int back = mBoard->step( node.state.player, oppositeMove( direction ) );
+			if( back < 0 || mBoard->isWall( back ) || findStar( node.state, back ) >= 0 )
+			{
+				continue;
+			}
+
+			child.state.player = back;
+			offer( SEARCH_BACKWARD, child );
+
+			//Had the move been a push, the star ahead of the dot gets pulled along
+			int ahead = mBoard->step( node.state.player, direction );
+			int star = ahead >= 0 ? findStar( node.state, ahead ) : -1;
+			if( star < 0 )
+			{
+				continue;
+			}
+
+			if( !primed )
+			{
+				mStartHeuristic.reset( node.state.stars, node.state.starCount );
+				primed = true;
+			}
+
+			moveStarCell( child.state, star, node.state.player );
+			child.estimate = mStartHeuristic.moveStar( star, node.state.player );
+			mStartHeuristic.moveStar( star, ahead );
+
+			if( child.estimate != HEURISTIC_DEADLOCK )
+			{
+				offer( SEARCH_BACKWARD, child );
+			}
+		}
+	}
+
+	if( meetForward < 0 )
+	{
+		return false;
+	}
+
+	//Walk the forward parents back to the start, then the backward ones on to the goals
+	for( int i = meetForward; nodes[ SEARCH_FORWARD ][ i ].parent >= 0; i = nodes[ SEARCH_FORWARD ][ i ].parent )
+	{
+		moves.insert( moves.begin(), nodes[ SEARCH_FORWARD ][ i ].move );
+	}
+
+	for( int i = meetBackward; nodes[ SEARCH_BACKWARD ][ i ].parent >= 0; i = nodes[ SEARCH_BACKWARD ][ i ].parent )
+	{
+		moves.push_back( nodes[ SEARCH_BACKWARD ][ i ].move );
+	}
+
+	return true;
+}
+
+int Solver::getExpandedNodes() const
+{
+	return mExpandedNodes;
+}
+
+bool Solver::wasStopped() const
+{
+	return mStopped;
+}
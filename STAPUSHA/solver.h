@@ -0,0 +1,95 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "board.h"
+#include "heuristic.h"
+#include "patternDb.h"
+#include "macroMoves.h"
+
+//Using function objects
+#include <functional>
+
+//Hashes a board state
+struct BoardStateHash
+{
+	size_t operator()( const BoardState& state ) const;
+};
+
+//Compares board states
+struct BoardStateEqual
+{
+	bool operator()( const BoardState& a, const BoardState& b ) const;
+};
+
+//Searches for the shortest sequence of dot moves that solves a level
+class Solver
+{
+	public:
+		//Initializes the solver for one level's goals
+		Solver( const Board& board, const int goals[], int goalCount );
+
+		//Tightens the heuristic with a pattern database for the given level
+		void setPatternDatabase( const PatternDatabase* database, int level );
+
+		//Sets how many nodes a search may expand before giving up
+		void setNodeLimit( int limit );
+
+		//Also searches backward from the solved layouts with pulls, meeting the forward search in the middle
+		void setBidirectional( bool enabled );
+
+		//Lets the forward search push stars through tunnels and into goal rooms as single steps
+		//Fewer nodes, but the solution is no longer guaranteed to be the shortest
+		void setMacroMoves( bool enabled );
+
+		//Sets a check polled during the search, returning true abandons it
+		void setCancelCheck( const std::function<bool()>& cancelled );
+
+		//Finds a move-optimal solution, returns false if there is none or the search stopped
+		bool solve( const BoardState& start, std::vector<int>& moves );
+
+		//Gets the lower bound on pushes left for a state
+		int estimate( const BoardState& state );
+
+		//Gets the number of nodes the last search expanded, both directions counted
+		int getExpandedNodes() const;
+
+		//Checks whether the last search ran out of nodes or was cancelled
+		bool wasStopped() const;
+
+	private:
+		//Searches forward from the start alone
+		bool solveForward( const BoardState& start, std::vector<int>& moves );
+
+		//Searches forward from the start and backward from the solved layouts at once
+		bool solveBidirectional( const BoardState& start, std::vector<int>& moves );
+
+		//The level
+		const Board* mBoard;
+		int mGoals[ MAX_STARS ];
+		int mGoalCount;
+
+		//The heuristics
+		PushDistances mDistances;
+		AssignmentHeuristic mHeuristic;
+		const PatternDatabase* mDatabase;
+		int mDatabaseLevel;
+
+		//Pushes out of the last search's start, the backward search's heuristic
+		PushDistances mStartDistances;
+		AssignmentHeuristic mStartHeuristic;
+		bool mBidirectional;
+
+		//The level's tunnels and goal rooms, found when a search starts
+		MacroMoves mMacros;
+		bool mMacroMoves;
+
+		//The search limits
+		int mNodeLimit;
+		std::function<bool()> mCancelled;
+
+		//The last search statistics
+		int mExpandedNodes;
+		bool mStopped;
+};
+
+#endif
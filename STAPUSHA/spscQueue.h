@@ -0,0 +1,63 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+//Using atomics
+#include <atomic>
+
+//A lock-free ring buffer for exactly one producer thread and one consumer thread
+template <typename T, unsigned int CAPACITY>
+class SpscQueue
+{
+	//The counters wrap, so the capacity has to divide 2^32
+	static_assert( CAPACITY > 0 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "SpscQueue capacity must be a power of two" );
+
+	public:
+		//Initializes an empty queue
+		SpscQueue() : mHead( 0 ), mTail( 0 )
+		{
+		}
+
+		//Adds an item, returns false without waiting if the queue is full
+		bool push( const T& item )
+		{
+			unsigned int tail = mTail.load( std::memory_order_relaxed );
+			if( tail - mHead.load( std::memory_order_acquire ) == CAPACITY )
+			{
+				return false;
+			}
+
+			mItems[ tail % CAPACITY ] = item;
+			mTail.store( tail + 1, std::memory_order_release );
+			return true;
+		}
+
+		//Takes the oldest item, returns false without waiting if the queue is empty
+		bool pop( T& item )
+		{
+			unsigned int head = mHead.load( std::memory_order_relaxed );
+			if( head == mTail.load( std::memory_order_acquire ) )
+			{
+				return false;
+			}
+
+			item = mItems[ head % CAPACITY ];
+			mHead.store( head + 1, std::memory_order_release );
+			return true;
+		}
+
+		//Checks whether the queue is empty, exact only on the consumer thread
+		bool empty() const
+		{
+			return mHead.load( std::memory_order_acquire ) == mTail.load( std::memory_order_acquire );
+		}
+
+	private:
+		//Free-running read and write counters on separate cache lines
+		alignas( 64 ) std::atomic<unsigned int> mHead;
+		alignas( 64 ) std::atomic<unsigned int> mTail;
+
+		//The items
+		T mItems[ CAPACITY ];
+};
+
+#endif
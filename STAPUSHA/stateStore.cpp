@@ -0,0 +1,496 @@
+#include "stateStore.h"
+
+//Using memory functions, sorting and limits
+#include <string.h>
+#include <algorithm>
+#include <limits.h>
+
+//How many bytes readers fetch at a time
+const size_t STATE_READ_AHEAD = 1 << 16;
+
+//Writes an unsigned varint, seven bits a byte, returns the bytes written
+static int putVarint( unsigned char* bytes, unsigned int value )
+{
+	int length = 0;
+	while( value >= 0x80 )
+	{
+		bytes[ length++ ] = (unsigned char)( value | 0x80 );
+		value >>= 7;
+	}
+	bytes[ length++ ] = (unsigned char)value;
+	return length;
+}
+
+//Reads an unsigned varint, returns the bytes read
+static int getVarint( const unsigned char* bytes, unsigned int& value )
+{
+	int length = 0;
+	value = 0;
+	for( int shift = 0; ; shift += 7 )
+	{
+		unsigned char byte = bytes[ length++ ];
+		value |= (unsigned int)( byte & 0x7F ) << shift;
+		if( byte < 0x80 )
+		{
+			return length;
+		}
+	}
+}
+
+int packState( const BoardState& state, unsigned char* bytes )
+{
+	int length = putVarint( bytes, (unsigned int)state.player );
+	length += putVarint( bytes + length, (unsigned int)state.starCount );
+
+	//Stars are sorted, so each gap to the previous set bit is small and never negative
+	int previous = -1;
+	for( int i = 0; i < state.starCount; ++i )
+	{
+		length += putVarint( bytes + length, (unsigned int)( state.stars[ i ] - previous - 1 ) );
+		previous = state.stars[ i ];
+	}
+
+	return length;
+}
+
+int unpackState( const unsigned char* bytes, BoardState& state )
+{
+	unsigned int value = 0;
+	int length = getVarint( bytes, value );
+	state.player = (int)value;
+	length += getVarint( bytes + length, value );
+	state.starCount = (int)value;
+
+	int previous = -1;
+	for( int i = 0; i < state.starCount; ++i )
+	{
+		length += getVarint( bytes + length, value );
+		previous += (int)value + 1;
+		state.stars[ i ] = previous;
+	}
+
+	return length;
+}
+
+int packedLength( const unsigned char* bytes )
+{
+	unsigned int value = 0;
+	int length = getVarint( bytes, value );
+	length += getVarint( bytes + length, value );
+
+	//Every varint ends on the first byte without the high bit
+	for( unsigned int i = 0; i < value; ++i )
+	{
+		while( bytes[ length ] >= 0x80 )
+		{
+			++length;
+		}
+		++length;
+	}
+
+	return length;
+}
+
+int comparePacked( const unsigned char* a, int lengthA, const unsigned char* b, int lengthB )
+{
+	int order = memcmp( a, b, lengthA < lengthB ? lengthA : lengthB );
+	return order != 0 ? order : lengthA - lengthB;
+}
+
+StateReader::StateReader()
+{
+	//Initialize
+	mFile = NULL;
+	mStart = 0;
+	mEnd = 0;
+	mLength = 0;
+}
+
+StateReader::~StateReader()
+{
+	close();
+}
+
+bool StateReader::open( const std::string& path )
+{
+	close();
+
+	mFile = fopen( path.c_str(), "rb" );
+	if( mFile == NULL )
+	{
+		printf( "Unable to open state file %s!\n", path.c_str() );
+		return false;
+	}
+
+	mBuffer.resize( STATE_READ_AHEAD );
+	return true;
+}
+
+void StateReader::close()
+{
+	if( mFile != NULL )
+	{
+		fclose( mFile );
+		mFile = NULL;
+	}
+
+	mStart = 0;
+	mEnd = 0;
+	mLength = 0;
+}
+
+bool StateReader::next()
+{
+	if( mFile == NULL )
+	{
+		return false;
+	}
+
+	mStart += mLength;
+	mLength = 0;
+
+	//Keep at least one whole state ahead
+	if( mEnd - mStart < (size_t)MAX_PACKED_STATE )
+	{
+		memmove( &mBuffer[ 0 ], &mBuffer[ mStart ], mEnd - mStart );
+		mEnd -= mStart;
+		mStart = 0;
+		mEnd += fread( &mBuffer[ mEnd ], 1, mBuffer.size() - mEnd, mFile );
+	}
+
+	if( mStart == mEnd )
+	{
+		return false;
+	}
+
+	mLength = packedLength( &mBuffer[ mStart ] );
+	if( mStart + mLength > mEnd )
+	{
+		printf( "State file ends in the middle of a state!\n" );
+		mLength = 0;
+		return false;
+	}
+
+	return true;
+}
+
+const unsigned char* StateReader::getPacked() const
+{
+	return &mBuffer[ mStart ];
+}
+
+int StateReader::getLength() const
+{
+	return mLength;
+}
+
+void StateReader::getState( BoardState& state ) const
+{
+	unpackState( &mBuffer[ mStart ], state );
+}
+
+StateWriter::StateWriter()
+{
+	//Initialize
+	mFile = NULL;
+	mCount = 0;
+	mFailed = false;
+}
+
+StateWriter::~StateWriter()
+{
+	close();
+}
+
+bool StateWriter::open( const std::string& path )
+{
+	close();
+
+	mCount = 0;
+	mFailed = false;
+	mFile = fopen( path.c_str(), "wb" );
+	if( mFile == NULL )
+	{
+		printf( "Unable to create state file %s!\n", path.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+void StateWriter::write( const unsigned char* packed, int length )
+{
+	if( mFile != NULL && fwrite( packed, 1, length, mFile ) != (size_t)length )
+	{
+		mFailed = true;
+	}
+
+	++mCount;
+}
+
+void StateWriter::write( const BoardState& state )
+{
+	unsigned char packed[ MAX_PACKED_STATE ];
+	write( packed, packState( state, packed ) );
+}
+
+bool StateWriter::close()
+{
+	if( mFile == NULL )
+	{
+		return !mFailed;
+	}
+
+	if( fclose( mFile ) != 0 )
+	{
+		mFailed = true;
+	}
+	mFile = NULL;
+
+	return !mFailed;
+}
+
+long long StateWriter::getCount() const
+{
+	return mCount;
+}
+
+StateStore::StateStore( const std::string& path, size_t memoryBudget )
+{
+	//Initialize
+	mPath = path;
+	mBudget = memoryBudget;
+	mAdded = 0;
+	mPackedBytes = 0;
+	mSpilledRuns = 0;
+	mSpilledBytes = 0;
+}
+
+StateStore::~StateStore()
+{
+	removeRuns();
+}
+
+bool StateStore::add( const BoardState& state )
+{
+	unsigned char packed[ MAX_PACKED_STATE ];
+	int length = packState( state, packed );
+
+	mOffsets.push_back( (unsigned int)mBytes.size() );
+	mBytes.insert( mBytes.end(), packed, packed + length );
+	++mAdded;
+	mPackedBytes += length;
+
+	//Offsets are 32 bit, so a huge budget still spills every 4 GB of states
+	if( mBytes.size() + mOffsets.size() * sizeof( unsigned int ) >= mBudget || mBytes.size() >= UINT_MAX - MAX_PACKED_STATE )
+	{
+		return spill( true );
+	}
+
+	return true;
+}
+
+bool StateStore::spill( bool budgetFull )
+{
+	if( mOffsets.empty() )
+	{
+		return true;
+	}
+
+	const unsigned char* bytes = &mBytes[ 0 ];
+	std::sort( mOffsets.begin(), mOffsets.end(), [ bytes ]( unsigned int a, unsigned int b )
+	{
+		return comparePacked( bytes + a, packedLength( bytes + a ), bytes + b, packedLength( bytes + b ) ) < 0;
+	} );
+
+	char suffix[ 32 ];
+	snprintf( suffix, sizeof( suffix ), ".run%d", (int)mRuns.size() );
+	std::string path = mPath + suffix;
+
+	StateWriter writer;
+	if( !writer.open( path ) )
+	{
+		return false;
+	}
+	mRuns.push_back( path );
+
+	//Equal states sort next to each other, so only the first of each is written
+	const unsigned char* previous = NULL;
+	int previousLength = 0;
+	long long written = 0;
+	for( size_t i = 0; i < mOffsets.size(); ++i )
+	{
+		const unsigned char* packed = bytes + mOffsets[ i ];
+		int length = packedLength( packed );
+		if( previous == NULL || comparePacked( previous, previousLength, packed, length ) != 0 )
+		{
+			writer.write( packed, length );
+			written += length;
+			previous = packed;
+			previousLength = length;
+		}
+	}
+
+	if( budgetFull )
+	{
+		++mSpilledRuns;
+		mSpilledBytes += written;
+	}
+	mBytes.clear();
+	mOffsets.clear();
+
+	if( !writer.close() )
+	{
+		printf( "Unable to write state run %s!\n", path.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+long long StateStore::collapse( const std::string& out, const std::string& exclude, const std::string& merged )
+{
+	//Whatever is still buffered becomes the last run
+	if( !spill( false ) )
+	{
+		removeRuns();
+		return -1;
+	}
+
+	bool success = true;
+	std::vector<StateReader*> runs;
+	std::vector<StateReader*> heads;
+	for( size_t i = 0; i < mRuns.size(); ++i )
+	{
+		runs.push_back( new StateReader() );
+		if( !runs.back()->open( mRuns[ i ] ) )
+		{
+			success = false;
+		}
+		else if( runs.back()->next() )
+		{
+			heads.push_back( runs.back() );
+		}
+	}
+
+	StateReader excluded;
+	bool excludeLeft = false;
+	if( success && !exclude.empty() )
+	{
+		success = excluded.open( exclude );
+		excludeLeft = success && excluded.next();
+	}
+
+	StateWriter outWriter, mergedWriter;
+	success = success && outWriter.open( out ) && ( merged.empty() || mergedWriter.open( merged ) );
+
+	while( success && !heads.empty() )
+	{
+		//Find the smallest state at the head of any run
+		StateReader* smallest = heads[ 0 ];
+		for( size_t i = 1; i < heads.size(); ++i )
+		{
+			if( comparePacked( heads[ i ]->getPacked(), heads[ i ]->getLength(), smallest->getPacked(), smallest->getLength() ) < 0 )
+			{
+				smallest = heads[ i ];
+			}
+		}
+
+		unsigned char packed[ MAX_PACKED_STATE ];
+		int length = smallest->getLength();
+		memcpy( packed, smallest->getPacked(), length );
+
+		//Each run holds a state once at most, so its copies sit at the heads of other runs
+		for( size_t i = 0; i < heads.size(); )
+		{
+			if( comparePacked( heads[ i ]->getPacked(), heads[ i ]->getLength(), packed, length ) == 0 && !heads[ i ]->next() )
+			{
+				heads.erase( heads.begin() + i );
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		//Walk the excluded file up to the state, copying it over to the merged one
+		int order = -1;
+		while( excludeLeft && ( order = comparePacked( excluded.getPacked(), excluded.getLength(), packed, length ) ) < 0 )
+		{
+			if( !merged.empty() )
+			{
+				mergedWriter.write( excluded.getPacked(), excluded.getLength() );
+			}
+			excludeLeft = excluded.next();
+		}
+
+		if( excludeLeft && order == 0 )
+		{
+			continue;
+		}
+
+		outWriter.write( packed, length );
+		if( !merged.empty() )
+		{
+			mergedWriter.write( packed, length );
+		}
+	}
+
+	//The rest of the excluded file comes after every new state
+	while( success && excludeLeft )
+	{
+		if( !merged.empty() )
+		{
+			mergedWriter.write( excluded.getPacked(), excluded.getLength() );
+		}
+		excludeLeft = excluded.next();
+	}
+
+	for( size_t i = 0; i < runs.size(); ++i )
+	{
+		delete runs[ i ];
+	}
+	removeRuns();
+
+	success = outWriter.close() && success;
+	success = mergedWriter.close() && success;
+	if( !success )
+	{
+		printf( "Unable to merge state runs into %s!\n", out.c_str() );
+		return -1;
+	}
+
+	return outWriter.getCount();
+}
+
+long long StateStore::getAdded() const
+{
+	return mAdded;
+}
+
+long long StateStore::getPackedBytes() const
+{
+	return mPackedBytes;
+}
+
+int StateStore::getSpilledRuns() const
+{
+	return mSpilledRuns;
+}
+
+long long StateStore::getSpilledBytes() const
+{
+	return mSpilledBytes;
+}
+
+void StateStore::removeRuns()
+{
+	for( size_t i = 0; i < mRuns.size(); ++i )
+	{
+		remove( mRuns[ i ].c_str() );
+	}
+
+	mRuns.clear();
+	mBytes.clear();
+	mOffsets.clear();
+}
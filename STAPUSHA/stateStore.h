@@ -0,0 +1,153 @@
+#ifndef STATE_STORE_H
+#define STATE_STORE_H
+
+#include "board.h"
+
+//Using standard IO, strings and vectors
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+//The most bytes a packed state can take, one varint per star plus the player cell and star count
+const int MAX_PACKED_STATE = 5 * ( MAX_STARS + 2 );
+
+//How much memory a store buffers before spilling unless told otherwise
+const size_t DEFAULT_STORE_BUDGET = (size_t)256 * 1024 * 1024;
+
+//Packs a state as varints: the player cell, the star count, then the gaps between the set bits of the star cell bitset
+//Equal states always pack to equal bytes, returns the packed length
+int packState( const BoardState& state, unsigned char* bytes );
+
+//Unpacks a state, returns the packed length
+int unpackState( const unsigned char* bytes, BoardState& state );
+
+//Gets the length of a packed state without unpacking it
+int packedLength( const unsigned char* bytes );
+
+//Orders packed states bytewise, every run and merge sorts by this
+int comparePacked( const unsigned char* a, int lengthA, const unsigned char* b, int lengthB );
+
+//Reads a file of packed states front to back
+class StateReader
+{
+	public:
+		//Initializes variables
+		StateReader();
+
+		//Closes the file
+		~StateReader();
+
+		//Opens a state file
+		bool open( const std::string& path );
+
+		//Closes the file
+		void close();
+
+		//Moves on to the next state, returns false at the end of the file
+		bool next();
+
+		//Gets the current state, packed or unpacked
+		const unsigned char* getPacked() const;
+		int getLength() const;
+		void getState( BoardState& state ) const;
+
+	private:
+		//Copying would close the file twice
+		StateReader( const StateReader& );
+		StateReader& operator=( const StateReader& );
+
+		//The file and the bytes read ahead of the current state
+		FILE* mFile;
+		std::vector<unsigned char> mBuffer;
+		size_t mStart;
+		size_t mEnd;
+		int mLength;
+};
+
+//Writes a file of packed states
+class StateWriter
+{
+	public:
+		//Initializes variables
+		StateWriter();
+
+		//Closes the file
+		~StateWriter();
+
+		//Creates a state file
+		bool open( const std::string& path );
+
+		//Appends a state
+		void write( const unsigned char* packed, int length );
+		void write( const BoardState& state );
+
+		//Closes the file, returns false if any write failed
+		bool close();
+
+		//Gets the number of states written
+		long long getCount() const;
+
+	private:
+		//Copying would close the file twice
+		StateWriter( const StateWriter& );
+		StateWriter& operator=( const StateWriter& );
+
+		//The file and how the writes went
+		FILE* mFile;
+		long long mCount;
+		bool mFailed;
+};
+
+//A set of states bigger than memory, buffered packed and spilled to sorted runs on disk past a budget
+class StateStore
+{
+	public:
+		//Initializes an empty store, its runs go next to path
+		StateStore( const std::string& path, size_t memoryBudget = DEFAULT_STORE_BUDGET );
+
+		//Deletes any runs left on disk
+		~StateStore();
+
+		//Buffers a state, spilling a sorted run once the budget is used, returns false if the run couldn't be written
+		bool add( const BoardState& state );
+
+		//Merges every state added into the sorted file out without duplicates, leaving the store empty
+		//States in the sorted file exclude are left out, and if merged is named exclude plus the new states go there
+		//Returns the number of states written to out, or -1 on a file error
+		long long collapse( const std::string& out, const std::string& exclude = "", const std::string& merged = "" );
+
+		//Gets how many states were added and how many bytes they packed to
+		long long getAdded() const;
+		long long getPackedBytes() const;
+
+		//Gets how many runs the budget forced to disk and their total size
+		//The buffer collapse writes out last isn't counted, it goes to disk whatever the budget
+		int getSpilledRuns() const;
+		long long getSpilledBytes() const;
+
+	private:
+		//Sorts the buffer and writes it out as a run without duplicates, counted as spilled if the budget forced it
+		bool spill( bool budgetFull );
+
+		//Deletes the run files
+		void removeRuns();
+
+		//Where runs go and the memory they may use
+		std::string mPath;
+		size_t mBudget;
+
+		//The packed states not spilled yet and where each starts
+		std::vector<unsigned char> mBytes;
+		std::vector<unsigned int> mOffsets;
+
+		//The spilled run files
+		std::vector<std::string> mRuns;
+
+		//The totals
+		long long mAdded;
+		long long mPackedBytes;
+		int mSpilledRuns;
+		long long mSpilledBytes;
+};
+
+#endif
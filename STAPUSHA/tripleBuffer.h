@@ -0,0 +1,68 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+//Using atomics
+#include <atomic>
+
+//Hands the latest value from one writer thread to one reader thread without locks or waiting
+//The writer fills a back slot and swaps it into the middle, the reader swaps the middle out to read it
+template <typename T>
+class TripleBuffer
+{
+	public:
+		//Initializes with nothing published
+		TripleBuffer() : mMiddle( 1 )
+		{
+			mBack = 0;
+			mFront = 2;
+		}
+
+		//Gets the slot to fill before publishing, writer thread only
+		T& back()
+		{
+			return mSlots[ mBack ].value;
+		}
+
+		//Makes the back slot the latest value, writer thread only
+		void publish()
+		{
+			mBack = mMiddle.exchange( mBack | FRESH, std::memory_order_acq_rel ) & INDEX;
+		}
+
+		//Takes the latest value if one was published since the last call, reader thread only
+		bool update()
+		{
+			if( ( mMiddle.load( std::memory_order_relaxed ) & FRESH ) == 0 )
+			{
+				return false;
+			}
+
+			mFront = mMiddle.exchange( mFront, std::memory_order_acq_rel ) & INDEX;
+			return true;
+		}
+
+		//Gets the value last taken by update(), reader thread only
+		const T& front() const
+		{
+			return mSlots[ mFront ].value;
+		}
+
+	private:
+		//The middle index carries a flag for a value the reader hasn't taken
+		static const int INDEX = 3;
+		static const int FRESH = 4;
+
+		//The slots, apart so the threads don't share cache lines
+		struct alignas( 64 ) Slot
+		{
+			T value;
+		};
+
+		//Each thread owns one index, the middle one is swapped between them
+		Slot mSlots[ 3 ];
+		int mBack;
+		alignas( 64 ) std::atomic<int> mMiddle;
+		alignas( 64 ) int mFront;
+};
+
+#endif
@@ -1,14 +1,33 @@
 /*This source code copyrighted by Lazy Foo' Productions (2004-2014)
 and may not be redistributed without written permission.*/
 
-//Using SDL, SDL_image, standard IO, strings, and file streams
+//Using SDL, SDL_image, standard IO, standard library, strings, and file streams
 #include <SDL.h>
 #include <SDL_image.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string>
 #include <fstream>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "board.h"
+#include "levels.h"
+#include "hintEngine.h"
+#include "spscQueue.h"
+#include "fileWatcher.h"
+#include "pathFinder.h"
+#include "assetCache.h"
+#include "gameState.h"
+#include "moveLog.h"
+#include "tripleBuffer.h"
+#include "allocTracker.h"
+#include "parallel.h"
+#include "ghostReplay.h"
+#include "autoTile.h"
 
 
 using namespace std;
@@ -17,29 +36,114 @@ using namespace std;
 const int SCREEN_WIDTH = 675;
 const int SCREEN_HEIGHT = 616;
 
-//The dimensions of the level
-const int LEVEL_WIDTH = 675;
-const int LEVEL_HEIGHT = 4950;
-
-//Tile constants
-const int TILE_WIDTH = 80;
-const int TILE_HEIGHT = 80;
-const int TOTAL_TILES = 693;
-const int TOTAL_TILE_SPRITES = 12;
-
-//The different tile sprites
-const int TILE_RED = 0;
-const int TILE_GREEN = 1;
-const int TILE_BLUE = 2;
-const int TILE_CENTER = 3;
-const int TILE_TOP = 4;
-const int TILE_TOPRIGHT = 5;
-const int TILE_RIGHT = 6;
-const int TILE_BOTTOMRIGHT = 7;
-const int TILE_BOTTOM = 8;
-const int TILE_BOTTOMLEFT = 9;
-const int TILE_LEFT = 10;
-const int TILE_TOPLEFT = 11;
+//The codes Dot::handleEvent produces besides moves
+const int ACTION_RESET = MOVE_RESET;
+const int ACTION_QUIT = 6;
+const int ACTION_HINT = 7;
+
+//Save and load codes, plus the slot index
+const int ACTION_SAVE_SLOT = 10;
+const int ACTION_LOAD_SLOT = 20;
+
+//A click on a cell, and the go-ahead to leave a level once its solved screen has been shown
+const int ACTION_CLICK = 30;
+const int ACTION_CONTINUE = 31;
+
+//Editor mode and the map edits made in it, clicks paint the cell under the pointer
+const int ACTION_EDIT = 32;
+const int ACTION_WRITE_MAP = 33;
+const int ACTION_PAINT_WALL = 34;
+const int ACTION_PAINT_FLOOR = 35;
+
+//The simulation runs at a fixed rate however fast frames are drawn
+const int SIM_TICKS_PER_SECOND = 20;
+
+//The most simulation time one frame may catch up on, so a stall doesn't replay a burst of moves
+const double SIM_MAX_CATCHUP = 0.25;
+
+//How frames are paced
+enum FramePacing
+{
+	PACING_VSYNC,
+	PACING_UNCAPPED,
+	PACING_TARGET_FPS
+};
+
+//The pacing mode and the frame rate PACING_TARGET_FPS holds
+FramePacing gPacing = PACING_VSYNC;
+int gTargetFps = 60;
+
+//Whether input is read as late as possible before each present
+bool gLowLatency = false;
+
+//Whether to pick up the autosave instead of starting over
+bool gResume = false;
+
+//Whether the simulation ticks on its own thread, off for headless runs so frames stay deterministic
+bool gSimThread = true;
+
+//The longest the autosave may lag behind play
+const Uint32 AUTOSAVE_INTERVAL_MS = 1000;
+
+//Whether frames are drawn offscreen by the software renderer, with no window or vsync
+bool gHeadless = false;
+
+//Headless runs draw this many frames, 0 for the move log plus HEADLESS_SETTLE_FRAMES
+int gHeadlessFrames = 0;
+const int HEADLESS_SETTLE_FRAMES = 120;
+
+//The moves a headless run plays, where frames are dumped as bitmaps and where frame hashes are written
+std::string gMoveLogPath;
+std::string gFrameDumpDirectory;
+std::string gFrameHashPath;
+
+//Recorded runs raced as ghosts, one level number and move log per line like the solutions file
+std::string gGhostPath;
+
+//How faded ghosts are drawn and how fast they play their moves, logs don't keep timing
+const Uint8 GHOST_ALPHA = 0x60;
+const int GHOST_MOVES_PER_SECOND = 6;
+
+//The offscreen surface headless frames are drawn on
+SDL_Surface* gFrameSurface = NULL;
+
+//Frames allowed to allocate while the renderer and queues settle, after them gameplay should never touch the heap
+const int ALLOC_WARMUP_FRAMES = 2;
+
+//The most allocating frames reported one by one
+const int ALLOC_FRAME_REPORTS = 10;
+
+//Presses kept for the latency report, kept in memory reserved up front
+const int LATENCY_SAMPLE_LIMIT = 1 << 16;
+
+#ifdef TRACK_ALLOCATIONS
+//SDL's own allocator, wrapped so its allocations are counted too
+SDL_malloc_func gSdlMalloc = NULL;
+SDL_calloc_func gSdlCalloc = NULL;
+SDL_realloc_func gSdlRealloc = NULL;
+SDL_free_func gSdlFree = NULL;
+
+void* SDLCALL countedSdlMalloc( size_t size )
+{
+	recordAllocation( size );
+	return gSdlMalloc( size );
+}
+
+void* SDLCALL countedSdlCalloc( size_t count, size_t size )
+{
+	recordAllocation( count * size );
+	return gSdlCalloc( count, size );
+}
+
+void* SDLCALL countedSdlRealloc( void* memory, size_t size )
+{
+	recordAllocation( size );
+	return gSdlRealloc( memory, size );
+}
+#endif
+
+//How long before the expected vblank low latency mode wakes up to read input
+const double LOW_LATENCY_MARGIN_MS = 2.0;
 
 //Texture wrapper class
 class LTexture
@@ -52,7 +156,7 @@ class LTexture
 		~LTexture();
 
 		//Loads image at specified path
-		bool loadFromFile( std::string path );
+		bool loadFromFile( const std::string& path );
 
 		#ifdef _SDL_TTF_H
 		//Creates image from font string
@@ -74,17 +178,29 @@ class LTexture
 		//Renders texture at given point
 		void render( int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE );
 
+		//Reserves room to batch count copies, so renderBatch never allocates
+		void reserveBatch( int count );
+
+		//Renders a whole copy of the texture at every point in one go, faded to alpha
+		void renderBatch( const SDL_Point points[], int count, Uint8 alpha );
+
 		//Gets image dimensions
 		int getWidth();
 		int getHeight();
 
 	private:
-		//The actual hardware texture
-		SDL_Texture* mTexture;
+		//The actual hardware texture, shared with every other LTexture of the same image
+		TextureHandle mTexture;
 
 		//Image dimensions
 		int mWidth;
 		int mHeight;
+
+		#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+		//Two triangles per batched copy
+		std::vector<SDL_Vertex> mVertices;
+		std::vector<int> mIndices;
+		#endif
 };
 
 //The tile
@@ -100,6 +216,9 @@ class Tile
 		//Get the tile type
 		int getType();
 
+		//Change the tile type in place
+		void setType( int tileType );
+
 		//Get the collision box
 		SDL_Rect getBox();
 
@@ -125,17 +244,17 @@ class Dot
 		//Initializes the variables
 		Dot();
 
-		//Takes key presses and adjusts the dot's velocity
-		int handleEvent( SDL_Event& e , Tile *tileSet[]);
+		//Takes key presses and turns them into move codes
+		int handleEvent( SDL_Event& e );
 
 		//Moves the dot and check collision against tiles
 		void move( Tile *tiles[], int direction );
 
-		//Centers the camera over the dot
-		void setCamera( SDL_Rect& camera );
+		//Centers the camera over the dot, alpha of the way from its last tick position
+		void setCamera( SDL_Rect& camera, double alpha = 1.0 );
 
-		//Shows the dot on the screen
-		void render( SDL_Rect& camera );
+		//Shows the dot on the screen, alpha of the way from its last tick position
+		void render( SDL_Rect& camera, double alpha = 1.0 );
 
 		int getX ();
 
@@ -143,10 +262,21 @@ class Dot
 
 		void setPosition(int, int);
 
+		//Remembers the position at the start of a simulation tick
+		void savePosition();
+
+		//Gets or sets the position at the start of the tick, for drawing in between
+		int getPrevX();
+		int getPrevY();
+		void setPrevious( int X, int Y );
+
     private:
 		//Collision box of the dot
 		SDL_Rect mBox;
 
+		//Position at the start of the tick
+		int mPrevX, mPrevY;
+
 		//The velocity of the dot
 		int mVelX, mVelY;
 };
@@ -165,8 +295,8 @@ class Star
 		//Moves the star and check collision against tiles
 		int move( Tile *tiles[], int direction );
 
-		//Shows the star on the screen
-		void render( SDL_Rect& camera );
+		//Shows the star on the screen, alpha of the way from its last tick position
+		void render( SDL_Rect& camera, double alpha = 1.0 );
 
 		int getX();
 
@@ -174,10 +304,21 @@ class Star
 
 		void setPosition(int, int);
 
+		//Remembers the position at the start of a simulation tick
+		void savePosition();
+
+		//Gets or sets the position at the start of the tick, for drawing in between
+		int getPrevX();
+		int getPrevY();
+		void setPrevious( int X, int Y );
+
     private:
 		//Collision box of the star
 		SDL_Rect mBox;
 
+		//Position at the start of the tick
+		int mPrevX, mPrevY;
+
 		//The velocity of the star
 		int mVelX, mVelY;
 };
@@ -209,6 +350,11 @@ class Goal
 
 		bool getActive();
 
+		//Lights or clears the goal directly, for restoring a saved game
+		void setLit( bool lit );
+
+		void setPosition(int, int);
+
     private:
 		//Collision box of the goal
 		SDL_Rect mBox;
@@ -218,8 +364,11 @@ class Goal
 
 SDL_Window* gWindow = NULL;
 SDL_Surface* gScreenSurface = NULL;
-SDL_Surface* gHelloWorld = NULL;
-SDL_Surface* gSolved  = NULL;
+SurfaceHandle gHelloWorld;
+SurfaceHandle gSolved;
+
+//Every image is decoded once and shared from here
+AssetCache gAssets;
 
 //Starts up SDL and creates window
 bool init();
@@ -263,14 +412,14 @@ bool loadMediaMenu()
 	bool success = true;
 
 	//Load splash image
-	gHelloWorld = SDL_LoadBMP( "hello_world.bmp" );
-	if( gHelloWorld == NULL )
+	gHelloWorld = gAssets.loadSurface( "hello_world.bmp" );
+	if( !gHelloWorld )
 	{
 		printf( "Unable to load image %s! SDL Error: %s\n", "hello_world.bmp", SDL_GetError() );
 		success = false;
 	}
-	gSolved = SDL_LoadBMP( "solvedscreen.bmp" );
-	if( gSolved == NULL )
+	gSolved = gAssets.loadSurface( "solvedscreen.bmp" );
+	if( !gSolved )
 	{
 		printf( "Unable to load image %s! SDL Error: %s\n", "hello_world.bmp", SDL_GetError() );
 		success = false;
@@ -285,9 +434,9 @@ void close( Tile* tiles[] );
 
 void close()
 {
-	//Deallocate surface
-	SDL_FreeSurface( gHelloWorld );
-	gHelloWorld = NULL;
+	//Let go of the surfaces, the cache keeps them decoded for the next solved screen
+	gHelloWorld.reset();
+	gSolved.reset();
 
 	//Destroy window
 	SDL_DestroyWindow( gWindow );
@@ -300,6 +449,38 @@ bool checkCollision( SDL_Rect a, SDL_Rect b );
 //Checks collision box against set of tiles
 bool touchesWall( SDL_Rect box, Tile* tiles[] );
 
+//Moves a box one step towards DIRECTION, putting it back if it left the level or touched a wall
+//Returns false if it was put back
+template<int DIRECTION>
+bool slideBox( SDL_Rect& box, int velX, int velY, Tile* tiles[] )
+{
+	//Only the moving axis can have left the level
+	const int dx = DIRECTION == MOVE_LEFT ? -velX : DIRECTION == MOVE_RIGHT ? velX : 0;
+	const int dy = DIRECTION == MOVE_UP ? -velY : DIRECTION == MOVE_DOWN ? velY : 0;
+	box.x += dx;
+	box.y += dy;
+
+	bool outside = dx != 0 ? ( box.x < 0 ) || ( box.x + box.w > LEVEL_WIDTH ) : ( box.y < 0 ) || ( box.y + box.h > LEVEL_HEIGHT );
+	if( outside || touchesWall( box, tiles ) )
+	{
+		//move back
+		box.x -= dx;
+		box.y -= dy;
+		return false;
+	}
+
+	return true;
+}
+
+//Picks the slideBox for a move code, anything else stays put
+bool slideBox( SDL_Rect& box, int velX, int velY, Tile* tiles[], int direction );
+
+//Gets the point alpha of the way from one position to the next
+int interpolate( int from, int to, double alpha );
+
+//Gets a 64 bit FNV-1a hash of a surface's visible pixels
+unsigned long long hashSurface( SDL_Surface* surface );
+
 //Sets tiles from tile map
 bool setTiles( Tile *tiles[] );
 
@@ -327,7 +508,6 @@ SDL_Surface* loadSurface( std::string path );
 LTexture::LTexture()
 {
 	//Initialize
-	mTexture = NULL;
 	mWidth = 0;
 	mHeight = 0;
 }
@@ -338,55 +518,25 @@ LTexture::~LTexture()
 	free();
 }
 
-bool LTexture::loadFromFile( std::string path )
+bool LTexture::loadFromFile( const std::string& path )
 {
 	//Get rid of preexisting texture
 	free();
 
-	//The final texture
-	SDL_Texture* newTexture = NULL;
-
-	//Load image at specified path
-	SDL_Surface* loadedSurface = IMG_Load( path.c_str() );
-	if( loadedSurface == NULL )
-	{
-		printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
-	}
-	else
-	{
-		//Color key image
-		SDL_SetColorKey( loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 0, 255, 255 ) );
-
-		//Create texture from surface pixels
-        newTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface );
-		if( newTexture == NULL )
-		{
-			printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
-		}
-		else
-		{
-			//Get image dimensions
-			mWidth = loadedSurface->w;
-			mHeight = loadedSurface->h;
-		}
-
-		//Get rid of old loaded surface
-		SDL_FreeSurface( loadedSurface );
-	}
+	//Share the texture if the image is already loaded
+	mTexture = gAssets.loadTexture( gRenderer, path, &mWidth, &mHeight );
 
 	//Return success
-	mTexture = newTexture;
 	return mTexture != NULL;
 }
 
 
 void LTexture::free()
 {
-	//Free texture if it exists
-	if( mTexture != NULL )
+	//Let go of the texture, the cache frees it once nothing holds it
+	if( mTexture )
 	{
-		SDL_DestroyTexture( mTexture );
-		mTexture = NULL;
+		mTexture.reset();
 		mWidth = 0;
 		mHeight = 0;
 	}
@@ -395,19 +545,19 @@ void LTexture::free()
 void LTexture::setColor( Uint8 red, Uint8 green, Uint8 blue )
 {
 	//Modulate texture rgb
-	SDL_SetTextureColorMod( mTexture, red, green, blue );
+	SDL_SetTextureColorMod( mTexture.get(), red, green, blue );
 }
 
 void LTexture::setBlendMode( SDL_BlendMode blending )
 {
 	//Set blending function
-	SDL_SetTextureBlendMode( mTexture, blending );
+	SDL_SetTextureBlendMode( mTexture.get(), blending );
 }
 
 void LTexture::setAlpha( Uint8 alpha )
 {
 	//Modulate texture alpha
-	SDL_SetTextureAlphaMod( mTexture, alpha );
+	SDL_SetTextureAlphaMod( mTexture.get(), alpha );
 }
 
 void LTexture::render( int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip )
@@ -423,7 +573,62 @@ void LTexture::render( int x, int y, SDL_Rect* clip, double angle, SDL_Point* ce
 	}
 
 	//Render to screen
-	SDL_RenderCopyEx( gRenderer, mTexture, clip, &renderQuad, angle, center, flip );
+	SDL_RenderCopyEx( gRenderer, mTexture.get(), clip, &renderQuad, angle, center, flip );
+}
+
+void LTexture::reserveBatch( int count )
+{
+	#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+	mVertices.reserve( count * 4 );
+	mIndices.reserve( count * 6 );
+	#endif
+}
+
+void LTexture::renderBatch( const SDL_Point points[], int count, Uint8 alpha )
+{
+	if( count <= 0 )
+	{
+		return;
+	}
+
+	SDL_SetTextureBlendMode( mTexture.get(), SDL_BLENDMODE_BLEND );
+
+	#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+	//Every copy as a quad of the whole texture, the vertex color carrying the fade
+	mVertices.clear();
+	mIndices.clear();
+	SDL_Color color = { 0xFF, 0xFF, 0xFF, alpha };
+	for( int i = 0; i < count; ++i )
+	{
+		float left = (float)points[ i ].x;
+		float top = (float)points[ i ].y;
+		float right = left + mWidth;
+		float bottom = top + mHeight;
+		int first = (int)mVertices.size();
+
+		SDL_Vertex corners[ 4 ] =
+		{
+			{ { left, top }, color, { 0.0f, 0.0f } },
+			{ { right, top }, color, { 1.0f, 0.0f } },
+			{ { right, bottom }, color, { 1.0f, 1.0f } },
+			{ { left, bottom }, color, { 0.0f, 1.0f } }
+		};
+		mVertices.insert( mVertices.end(), corners, corners + 4 );
+
+		int triangles[ 6 ] = { first, first + 1, first + 2, first, first + 2, first + 3 };
+		mIndices.insert( mIndices.end(), triangles, triangles + 6 );
+	}
+
+	SDL_RenderGeometry( gRenderer, mTexture.get(), &mVertices[ 0 ], (int)mVertices.size(), &mIndices[ 0 ], (int)mIndices.size() );
+	#else
+	//Older SDL has no geometry, so copy one by one under a shared alpha
+	setAlpha( alpha );
+	for( int i = 0; i < count; ++i )
+	{
+		render( points[ i ].x, points[ i ].y );
+	}
+	setAlpha( 0xFF );
+	#endif
 }
 
 SDL_Surface* loadSurface( std::string path )
@@ -477,6 +682,11 @@ int Tile::getType()
     return mType;
 }
 
+void Tile::setType( int tileType )
+{
+    mType = tileType;
+}
+
 SDL_Rect Tile::getBox()
 {
     return mBox;
@@ -489,6 +699,7 @@ Goal::Goal()
     mBox.y = 67;
 	mBox.w = DOT_WIDTH;
 	mBox.h = DOT_HEIGHT;
+	isActive = false;
 
 }
 
@@ -499,6 +710,7 @@ Goal::Goal(int X, int Y)
     mBox.y = Y;
     mBox.w = DOT_WIDTH;
 	mBox.h = DOT_HEIGHT;
+	isActive = false;
 
 }
 
@@ -548,6 +760,17 @@ bool Goal::getActive()
     return isActive;
 }
 
+void Goal::setLit( bool lit )
+{
+    isActive = lit;
+}
+
+void Goal::setPosition(int X, int Y)
+{
+    mBox.x = X;
+    mBox.y = Y;
+}
+
 Dot::Dot()
 {
     //Initialize the collision box
@@ -559,6 +782,8 @@ Dot::Dot()
     //Initialize the velocity
     mVelX = 75;
     mVelY = 56;
+
+    savePosition();
 }
 
 Star::Star()
@@ -574,6 +799,7 @@ Star::Star()
     mVelX = 75;
     mVelY = 56;
 
+    savePosition();
 }
 
 Star::Star(int X, int Y)
@@ -585,152 +811,55 @@ Star::Star(int X, int Y)
 	mBox.h = DOT_HEIGHT;
 	mVelX = 75;
 	mVelY = 56;
+	savePosition();
 
 }
 
-int Dot::handleEvent( SDL_Event& e , Tile *tileSet[])
+int Dot::handleEvent( SDL_Event& e )
 {
     //If a key was pressed
 	if( e.type == SDL_KEYDOWN && e.key.repeat == 0 )
     {
-        //Adjust the velocity
+        //The move itself happens on the next simulation tick
         switch( e.key.keysym.sym )
         {
-            case SDLK_UP: move(tileSet, 1); return 1;break;
-            case SDLK_DOWN: move(tileSet, 2); return 2; break;
-            case SDLK_LEFT: move(tileSet, 3); return 3; break;
-            case SDLK_RIGHT: move(tileSet, 4); return 4; break;
-            case SDLK_r: return 5; break;
-            case SDLK_q: return 6; break;
+            case SDLK_UP: return MOVE_UP; break;
+            case SDLK_DOWN: return MOVE_DOWN; break;
+            case SDLK_LEFT: return MOVE_LEFT; break;
+            case SDLK_RIGHT: return MOVE_RIGHT; break;
+            case SDLK_r: return ACTION_RESET; break;
+            case SDLK_q: return ACTION_QUIT; break;
+            case SDLK_h: return ACTION_HINT; break;
+            case SDLK_e: return ACTION_EDIT; break;
+            case SDLK_w: return ACTION_WRITE_MAP; break;
+
+            //F1 to F4 save to a slot, F5 to F8 load it back
+            case SDLK_F1: case SDLK_F2: case SDLK_F3: case SDLK_F4:
+                return ACTION_SAVE_SLOT + ( e.key.keysym.sym - SDLK_F1 ); break;
+            case SDLK_F5: case SDLK_F6: case SDLK_F7: case SDLK_F8:
+                return ACTION_LOAD_SLOT + ( e.key.keysym.sym - SDLK_F5 ); break;
         }
     }
+
+    return MOVE_NONE;
 }
 
 void Dot::move( Tile *tiles[], int direction )
 {
-    switch(direction)
-    {
-    case 1:
-
-            mBox.y -= mVelY;
-
-            //If the dot went too far up or down or touched a wall
-            if( ( mBox.y < 0 ) || ( mBox.y + DOT_HEIGHT > LEVEL_HEIGHT ) || touchesWall( mBox, tiles ) )
-            {
-                //move back
-                mBox.y += mVelY;
-            }
-        break;
-
-    case 2:
-        {
-            mBox.y += mVelY;
-
-            //If the dot went too far up or down or touched a wall
-            if( ( mBox.y < 0 ) || ( mBox.y + DOT_HEIGHT > LEVEL_HEIGHT ) || touchesWall( mBox, tiles ) )
-            {
-                //move back
-                mBox.y -= mVelY;
-            }
-        }break;
-
-    case 3:
-        {
-            mBox.x -= mVelX;
-
-            //If the dot went too far to the left or right or touched a wall
-            if( ( mBox.x < 0 ) || ( mBox.x + DOT_WIDTH > LEVEL_WIDTH ) || touchesWall( mBox, tiles ) )
-            {
-                //move back
-                mBox.x += mVelX;
-            }
-        }break;
-
-    case 4:
-        {
-            mBox.x += mVelX;
-
-            //If the dot went too far to the left or right or touched a wall
-            if( ( mBox.x < 0 ) || ( mBox.x + DOT_WIDTH > LEVEL_WIDTH ) || touchesWall( mBox, tiles ) )
-            {
-                //move back
-                mBox.x -= mVelX;
-            }
-        }break;
-
-    }
-
+    slideBox( mBox, mVelX, mVelY, tiles, direction );
 }
 
 int Star::move( Tile *tiles[], int direction )
 {
-    switch(direction)
-    {
-    case 1:
-
-            mBox.y -= mVelY;
-
-            //If the dot went too far up or down or touched a wall
-            if( ( mBox.y < 0 ) || ( mBox.y + DOT_HEIGHT > LEVEL_HEIGHT ) || touchesWall( mBox, tiles ) )
-            {
-                //move back
-                mBox.y += mVelY;
-                return 1;
-            }
-            return 0;
-        break;
-
-    case 2:
-        {
-            mBox.y += mVelY;
-
-            //If the dot went too far up or down or touched a wall
-            if( ( mBox.y < 0 ) || ( mBox.y + DOT_HEIGHT > LEVEL_HEIGHT ) || touchesWall( mBox, tiles ) )
-            {
-                //move back
-                mBox.y -= mVelY;
-                return 1;
-            }
-            return 0;
-        }break;
-
-    case 3:
-        {
-            mBox.x -= mVelX;
-
-            //If the dot went too far to the left or right or touched a wall
-            if( ( mBox.x < 0 ) || ( mBox.x + DOT_WIDTH > LEVEL_WIDTH ) || touchesWall( mBox, tiles ) )
-            {
-                //move back
-                mBox.x += mVelX;
-                return 1;
-            }
-            return 0;
-        }break;
-
-    case 4:
-        {
-            mBox.x += mVelX;
-
-            //If the dot went too far to the left or right or touched a wall
-            if( ( mBox.x < 0 ) || ( mBox.x + DOT_WIDTH > LEVEL_WIDTH ) || touchesWall( mBox, tiles ) )
-            {
-                //move back
-                mBox.x -= mVelX;
-                return 1;
-            }
-            return 0;
-        }break;
-
-    }
-
+    //1 if the star was blocked
+    return slideBox( mBox, mVelX, mVelY, tiles, direction ) ? 0 : 1;
 }
 
-void Dot::setCamera( SDL_Rect& camera )
+void Dot::setCamera( SDL_Rect& camera, double alpha )
 {
 	//Center the camera over the dot
-	camera.x = ( mBox.x + DOT_WIDTH / 2 ) - SCREEN_WIDTH / 2;
-	camera.y = ( mBox.y + DOT_HEIGHT / 2 ) - SCREEN_HEIGHT / 2;
+	camera.x = ( interpolate( mPrevX, mBox.x, alpha ) + DOT_WIDTH / 2 ) - SCREEN_WIDTH / 2;
+	camera.y = ( interpolate( mPrevY, mBox.y, alpha ) + DOT_HEIGHT / 2 ) - SCREEN_HEIGHT / 2;
 
 	//Keep the camera in bounds
 	if( camera.x < 0 )
@@ -751,17 +880,17 @@ void Dot::setCamera( SDL_Rect& camera )
 	}
 }
 
-void Dot::render( SDL_Rect& camera )
+void Dot::render( SDL_Rect& camera, double alpha )
 {
     //Show the dot
-	gDotTexture.render( mBox.x - camera.x, mBox.y - camera.y );
+	gDotTexture.render( interpolate( mPrevX, mBox.x, alpha ) - camera.x, interpolate( mPrevY, mBox.y, alpha ) - camera.y );
 
 }
 
-void Star::render( SDL_Rect& camera )
+void Star::render( SDL_Rect& camera, double alpha )
 {
     //Show the dot
-	gStarTexture.render( mBox.x - camera.x, mBox.y - camera.y );
+	gStarTexture.render( interpolate( mPrevX, mBox.x, alpha ) - camera.x, interpolate( mPrevY, mBox.y, alpha ) - camera.y );
 
 }
 
@@ -787,14 +916,61 @@ int Star::getY()
 
 void Dot::setPosition(int X, int Y)
 {
+    //Placing jumps straight there instead of sliding
     mBox.x = X;
     mBox.y = Y;
+    savePosition();
 }
 
 void Star::setPosition(int X, int Y)
 {
     mBox.x = X;
     mBox.y = Y;
+    savePosition();
+}
+
+void Dot::savePosition()
+{
+    mPrevX = mBox.x;
+    mPrevY = mBox.y;
+}
+
+void Star::savePosition()
+{
+    mPrevX = mBox.x;
+    mPrevY = mBox.y;
+}
+
+int Dot::getPrevX()
+{
+    return mPrevX;
+}
+
+int Dot::getPrevY()
+{
+    return mPrevY;
+}
+
+void Dot::setPrevious( int X, int Y )
+{
+    mPrevX = X;
+    mPrevY = Y;
+}
+
+int Star::getPrevX()
+{
+    return mPrevX;
+}
+
+int Star::getPrevY()
+{
+    return mPrevY;
+}
+
+void Star::setPrevious( int X, int Y )
+{
+    mPrevX = X;
+    mPrevY = Y;
 }
 
 
@@ -804,12 +980,44 @@ bool init()
 	//Initialization flag
 	bool success = true;
 
-	//Initialize SDL
-	if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+	//Initialize SDL, headless runs need no video driver
+	if( SDL_Init( gHeadless ? 0 : SDL_INIT_VIDEO ) < 0 )
 	{
 		printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
 		success = false;
 	}
+	else if( gHeadless )
+	{
+		//Draw into a plain surface with the software renderer
+		gFrameSurface = SDL_CreateRGBSurfaceWithFormat( 0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888 );
+		if( gFrameSurface == NULL )
+		{
+			printf( "Frame surface could not be created! SDL Error: %s\n", SDL_GetError() );
+			success = false;
+		}
+		else
+		{
+			gRenderer = SDL_CreateSoftwareRenderer( gFrameSurface );
+			if( gRenderer == NULL )
+			{
+				printf( "Software renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+				success = false;
+			}
+			else
+			{
+				//Initialize renderer color
+				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+
+				//Initialize PNG loading
+				int imgFlags = IMG_INIT_PNG;
+				if( !( IMG_Init( imgFlags ) & imgFlags ) )
+				{
+					printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError() );
+					success = false;
+				}
+			}
+		}
+	}
 	else
 	{
 		//Set texture filtering to linear
@@ -827,8 +1035,14 @@ bool init()
 		}
 		else
 		{
-			//Create renderer for window
-			gRenderer = SDL_CreateRenderer( gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+			//Create renderer for window, only waiting on the display in vsync mode
+			Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+			if( gPacing == PACING_VSYNC )
+			{
+				rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+			}
+
+			gRenderer = SDL_CreateRenderer( gWindow, -1, rendererFlags );
 			if( gRenderer == NULL )
 			{
 				printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
@@ -865,6 +1079,24 @@ bool loadMedia( Tile* tiles[] )
 		success = false;
 	}*/
 
+	//Decoded images are kept between runs
+	gAssets.setImageCacheDirectory( IMAGE_CACHE_PATH );
+
+	//Read the tile map on a worker while the images decode
+	bool tilesLoaded = false;
+	JobHandle tileJob = submitJob( [ & ]()
+	{
+		tilesLoaded = setTiles( tiles );
+	} );
+
+	std::vector<std::string> images;
+	images.push_back( "39_tiling/dot.bmp" );
+	images.push_back( "39_tiling/star.png" );
+	images.push_back( "39_tiling/goaloff.png" );
+	images.push_back( "39_tiling/goalon.png" );
+	images.push_back( "39_tiling/tiles.png" );
+	gAssets.prepareTextures( gRenderer, images );
+
 	//Load dot texture
 	if( !gDotTexture.loadFromFile( "39_tiling/dot.bmp" ) )
 	{
@@ -900,7 +1132,8 @@ bool loadMedia( Tile* tiles[] )
 	}
 
 	//Load tile map
-	if( !setTiles( tiles ) )
+	waitForJob( tileJob );
+	if( !tilesLoaded )
 	{
 		printf( "Failed to load tile set!\n" );
 		success = false;
@@ -928,11 +1161,19 @@ void close( Tile* tiles[] )
 	gGoalOffTexture.free();
 	gGoalOnTexture.free();
 
+	//Free the cached images while the renderer they belong to still exists
+	gAssets.printStats();
+	gAssets.clear();
+	gHelloWorld.reset();
+	gSolved.reset();
+
 	//Destroy window
 	SDL_DestroyRenderer( gRenderer );
 	SDL_DestroyWindow( gWindow );
+	SDL_FreeSurface( gFrameSurface );
 	gWindow = NULL;
 	gRenderer = NULL;
+	gFrameSurface = NULL;
 
 	//Quit SDL subsystems
 	IMG_Quit();
@@ -993,10 +1234,10 @@ bool setTiles( Tile* tiles[] )
     int x = 0, y = 0;
 
     //Open the map
-    std::ifstream map( "39_tiling/levelOne.map" );
+    std::ifstream map( LEVEL_MAP_PATH );
 
     //If the map couldn't be loaded
-    if( map == NULL )
+    if( map.fail() )
     {
 		printf( "Unable to load map file!\n" );
 		tilesLoaded = false;
@@ -1054,65 +1295,13 @@ bool setTiles( Tile* tiles[] )
 		//Clip the sprite sheet
 		if( tilesLoaded )
 		{
-			gTileClips[ TILE_RED ].x = 0;
-			gTileClips[ TILE_RED ].y = 0;
-			gTileClips[ TILE_RED ].w = TILE_WIDTH;
-			gTileClips[ TILE_RED ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_GREEN ].x = 0;
-			gTileClips[ TILE_GREEN ].y = 80;
-			gTileClips[ TILE_GREEN ].w = TILE_WIDTH;
-			gTileClips[ TILE_GREEN ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_BLUE ].x = 0;
-			gTileClips[ TILE_BLUE ].y = 160;
-			gTileClips[ TILE_BLUE ].w = TILE_WIDTH;
-			gTileClips[ TILE_BLUE ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_TOPLEFT ].x = 80;
-			gTileClips[ TILE_TOPLEFT ].y = 0;
-			gTileClips[ TILE_TOPLEFT ].w = TILE_WIDTH;
-			gTileClips[ TILE_TOPLEFT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_LEFT ].x = 80;
-			gTileClips[ TILE_LEFT ].y = 80;
-			gTileClips[ TILE_LEFT ].w = TILE_WIDTH;
-			gTileClips[ TILE_LEFT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_BOTTOMLEFT ].x = 80;
-			gTileClips[ TILE_BOTTOMLEFT ].y = 160;
-			gTileClips[ TILE_BOTTOMLEFT ].w = TILE_WIDTH;
-			gTileClips[ TILE_BOTTOMLEFT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_TOP ].x = 160;
-			gTileClips[ TILE_TOP ].y = 0;
-			gTileClips[ TILE_TOP ].w = TILE_WIDTH;
-			gTileClips[ TILE_TOP ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_CENTER ].x = 160;
-			gTileClips[ TILE_CENTER ].y = 80;
-			gTileClips[ TILE_CENTER ].w = TILE_WIDTH;
-			gTileClips[ TILE_CENTER ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_BOTTOM ].x = 160;
-			gTileClips[ TILE_BOTTOM ].y = 160;
-			gTileClips[ TILE_BOTTOM ].w = TILE_WIDTH;
-			gTileClips[ TILE_BOTTOM ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_TOPRIGHT ].x = 240;
-			gTileClips[ TILE_TOPRIGHT ].y = 0;
-			gTileClips[ TILE_TOPRIGHT ].w = TILE_WIDTH;
-			gTileClips[ TILE_TOPRIGHT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_RIGHT ].x = 240;
-			gTileClips[ TILE_RIGHT ].y = 80;
-			gTileClips[ TILE_RIGHT ].w = TILE_WIDTH;
-			gTileClips[ TILE_RIGHT ].h = TILE_HEIGHT;
-
-			gTileClips[ TILE_BOTTOMRIGHT ].x = 240;
-			gTileClips[ TILE_BOTTOMRIGHT ].y = 160;
-			gTileClips[ TILE_BOTTOMRIGHT ].w = TILE_WIDTH;
-			gTileClips[ TILE_BOTTOMRIGHT ].h = TILE_HEIGHT;
+			for( int i = 0; i < TOTAL_TILE_SPRITES; ++i )
+			{
+				gTileClips[ i ].x = TILE_INFO[ i ].clipX;
+				gTileClips[ i ].y = TILE_INFO[ i ].clipY;
+				gTileClips[ i ].w = TILE_WIDTH;
+				gTileClips[ i ].h = TILE_HEIGHT;
+			}
 		}
 	}
 
@@ -1125,14 +1314,22 @@ bool setTiles( Tile* tiles[] )
 
 bool touchesWall( SDL_Rect box, Tile* tiles[] )
 {
+    //Tiles sit on a fixed grid, so only the few around the box can touch it
+    //The window is a cell wider than needed on every side, checkCollision decides the rest
+    int firstColumn = std::max( ( box.x - TILE_WIDTH ) / CELL_STEP_X - 1, 0 );
+    int lastColumn = std::min( ( box.x + box.w ) / CELL_STEP_X + 1, BOARD_COLUMNS - 1 );
+    int firstRow = std::max( ( box.y - TILE_HEIGHT ) / CELL_STEP_Y - 1, 0 );
+    int lastRow = std::min( ( box.y + box.h ) / CELL_STEP_Y + 1, TOTAL_TILES / BOARD_COLUMNS - 1 );
+
     //Go through the tiles
-    for( int i = 0; i < TOTAL_TILES; ++i )
+    for( int row = firstRow; row <= lastRow; ++row )
     {
-        //If the tile is a wall type tile
-        if( ( tiles[ i ]->getType() >= TILE_CENTER ) && ( tiles[ i ]->getType() <= TILE_TOPLEFT ) || ( tiles[ i ]->getType() == TILE_RED ) || ( tiles[ i ]->getType() == TILE_BLUE ) )
+        for( int column = firstColumn; column <= lastColumn; ++column )
         {
-            //If the collision box touches the wall tile
-            if( checkCollision( box, tiles[ i ]->getBox() ) )
+            Tile* tile = tiles[ row * BOARD_COLUMNS + column ];
+
+            //If the tile is a wall type tile and the collision box touches it
+            if( isWallTile( tile->getType() ) && checkCollision( box, tile->getBox() ) )
             {
                 return true;
             }
@@ -1143,48 +1340,277 @@ bool touchesWall( SDL_Rect box, Tile* tiles[] )
     return false;
 }
 
+bool slideBox( SDL_Rect& box, int velX, int velY, Tile* tiles[], int direction )
+{
+    switch( direction )
+    {
+        case MOVE_UP: return slideBox<MOVE_UP>( box, velX, velY, tiles );
+        case MOVE_DOWN: return slideBox<MOVE_DOWN>( box, velX, velY, tiles );
+        case MOVE_LEFT: return slideBox<MOVE_LEFT>( box, velX, velY, tiles );
+        case MOVE_RIGHT: return slideBox<MOVE_RIGHT>( box, velX, velY, tiles );
+    }
+
+    return true;
+}
+
 void DotOnStar(Dot *dot, Star *star, Tile *tileSet[], int movement );
 void starOnStar(Dot *dot, Star *star, Star *star2, Tile *tileSet[], int movement );
 void solve();
 
-int main( int argc, char* args[] )
-{
+//Copies the tile types into a wall grid
+void buildBoard( Board& board, Tile* tiles[] );
 
-    goto LOLBOWEBEMAD;
+//Gets the board state of a level's dot and stars
+BoardState levelState( const Board& board, Dot& dot, Star stars[], int starCount );
 
+//Checks whether every goal of a level is lit
+bool levelSolved( Goal goals[], int goalCount );
 
+//Copies the level, dot, stars and lit goals into a snapshot
+GameState captureGame( int level, Dot& dot, Star stars[][ MAX_STARS ], Goal goals[][ MAX_STARS ] );
 
+//Puts the level, dot, stars and lit goals back from a snapshot
+void restoreGame( const GameState& state, int& level, Dot& dot, Star stars[][ MAX_STARS ], Goal goals[][ MAX_STARS ] );
 
+//Rereads the tile map and changes only the tiles that differ, returns how many or -1 if the map is bad
+//Walls aren't put under the dot or the stars in occupied, those cells keep their floor
+int reloadMap( Board& board, Tile* tiles[], const BoardState& occupied );
 
-    LOLBOWEBEMAD:
-	//Start up SDL and create window
-	if( !initMenu() )
+//A key press or click waiting for its simulation tick
+struct QueuedAction
+{
+	int action;
+	Uint64 pressedAt;
+
+	//The clicked cell, -1 for keys
+	int cell;
+};
+
+//A press the simulation applied, shown once the snapshot with that sequence number is presented
+struct AppliedPress
+{
+	int sequence;
+	Uint64 pressedAt;
+};
+
+//Everything a frame draws, copied out of the simulation whenever it changes
+struct RenderSnapshot
+{
+	//Counts snapshots, and when the tick it shows ran
+	int sequence;
+	Uint64 tickedAt;
+
+	//The level, whether its last goal just lit and how many times a level has been finished
+	int level;
+	bool levelDone;
+	int completions;
+
+	//The dot and every star, where they are and where the tick started them
+	int dotX, dotY, dotPrevX, dotPrevY;
+	int starX[ TOTAL_LEVELS ][ MAX_STARS ];
+	int starY[ TOTAL_LEVELS ][ MAX_STARS ];
+	int starPrevX[ TOTAL_LEVELS ][ MAX_STARS ];
+	int starPrevY[ TOTAL_LEVELS ][ MAX_STARS ];
+	bool goalLit[ TOTAL_LEVELS ][ MAX_STARS ];
+
+	//The picked star and hinted cell, -1 if none, and whether a hint search is running
+	int selectedStar;
+	int hintCell;
+	bool searching;
+
+	//The tile types, only copied into the drawn tiles when the version changes
+	int mapVersion;
+	unsigned char tileTypes[ TOTAL_TILES ];
+};
+
+//Key press to present latencies
+struct LatencyStats
+{
+	std::vector<double> samples;
+
+	//Reserves the samples so recording never allocates
+	LatencyStats()
 	{
-		printf( "Failed to initialize!\n" );
+		samples.reserve( LATENCY_SAMPLE_LIMIT );
 	}
-	else
+
+	void add( double ms )
 	{
-		//Load media
-		if( !loadMediaMenu() )
+		if( samples.size() < samples.capacity() )
 		{
-			printf( "Failed to load media!\n" );
+			samples.push_back( ms );
 		}
-		else
-		{
-			//Apply the image
-			SDL_BlitSurface( gHelloWorld, NULL, gScreenSurface, NULL );
-
-			//Update the surface
-			SDL_UpdateWindowSurface( gWindow );
-
-			SDL_Delay( 5000) ;
-			close();
+	}
 
+	void print( const char* label )
+	{
+		if( !samples.empty() )
+		{
+			std::sort( samples.begin(), samples.end() );
+			printf( "%s: %d presses, %.2f ms p50, %.2f ms p90, %.2f ms p99, %.2f ms worst\n", label, (int)samples.size(),
+				percentile( 0.50 ), percentile( 0.90 ), percentile( 0.99 ), samples.back() );
 		}
 	}
-    if( !init() )
+
+	//Gets a percentile of the sorted samples
+	double percentile( double fraction ) const
 	{
-		printf( "Failed to initialize!\n" );
+		int index = (int)( fraction * ( samples.size() - 1 ) + 0.5 );
+		return samples[ index ];
+	}
+};
+
+//Frame time totals for a run of frames
+struct FrameTimes
+{
+	int frames;
+	double totalMs;
+	double worstMs;
+
+	FrameTimes() : frames( 0 ), totalMs( 0.0 ), worstMs( 0.0 )
+	{
+	}
+
+	void add( double ms )
+	{
+		++frames;
+		totalMs += ms;
+		worstMs = ms > worstMs ? ms : worstMs;
+	}
+
+	void print( const char* label ) const
+	{
+		if( frames > 0 )
+		{
+			printf( "%s: %d frames, %.2f ms average, %.2f ms worst\n", label, frames, totalMs / frames, worstMs );
+		}
+	}
+};
+
+int main( int argc, char* args[] )
+{
+	//Nonzero when the allocation check fails
+	int exitCode = 0;
+
+	//Everything until the main loop counts as loading
+	AllocationScope loadingScope( ALLOC_LOADING );
+
+	#ifdef TRACK_ALLOCATIONS
+	//Count SDL's allocations too, before SDL makes any
+	SDL_GetMemoryFunctions( &gSdlMalloc, &gSdlCalloc, &gSdlRealloc, &gSdlFree );
+	SDL_SetMemoryFunctions( countedSdlMalloc, countedSdlCalloc, countedSdlRealloc, gSdlFree );
+	#endif
+
+	//Pick the frame pacing, --pacing=vsync, --pacing=uncapped or --pacing=<fps>
+	for( int i = 1; i < argc; ++i )
+	{
+		std::string arg = args[ i ];
+		if( arg.compare( 0, 9, "--pacing=" ) == 0 )
+		{
+			std::string mode = arg.substr( 9 );
+			if( mode == "vsync" )
+			{
+				gPacing = PACING_VSYNC;
+			}
+			else if( mode == "uncapped" )
+			{
+				gPacing = PACING_UNCAPPED;
+			}
+			else if( atoi( mode.c_str() ) > 0 )
+			{
+				gPacing = PACING_TARGET_FPS;
+				gTargetFps = atoi( mode.c_str() );
+			}
+			else
+			{
+				printf( "Unknown pacing mode %s!\n", mode.c_str() );
+			}
+		}
+		else if( arg == "--low-latency" )
+		{
+			gLowLatency = true;
+		}
+		else if( arg == "--resume" )
+		{
+			gResume = true;
+		}
+		else if( arg == "--headless" )
+		{
+			gHeadless = true;
+		}
+		else if( arg == "--single-thread" )
+		{
+			gSimThread = false;
+		}
+		else if( arg.compare( 0, 9, "--frames=" ) == 0 )
+		{
+			gHeadlessFrames = atoi( arg.c_str() + 9 );
+		}
+		else if( arg.compare( 0, 8, "--moves=" ) == 0 )
+		{
+			gMoveLogPath = arg.substr( 8 );
+		}
+		else if( arg.compare( 0, 9, "--ghosts=" ) == 0 )
+		{
+			gGhostPath = arg.substr( 9 );
+		}
+		else if( arg.compare( 0, 14, "--dump-frames=" ) == 0 )
+		{
+			gFrameDumpDirectory = arg.substr( 14 );
+		}
+		else if( arg.compare( 0, 15, "--frame-hashes=" ) == 0 )
+		{
+			gFrameHashPath = arg.substr( 15 );
+		}
+	}
+
+	//Headless frames run back to back
+	if( gHeadless )
+	{
+		gPacing = PACING_UNCAPPED;
+		gLowLatency = false;
+		gSimThread = false;
+	}
+
+    goto LOLBOWEBEMAD;
+
+
+
+
+
+    LOLBOWEBEMAD:
+	//Show the splash screen, headless runs have no window to show it in
+	if( !gHeadless )
+	{
+		//Start up SDL and create window
+		if( !initMenu() )
+		{
+			printf( "Failed to initialize!\n" );
+		}
+		else
+		{
+			//Load media
+			if( !loadMediaMenu() )
+			{
+				printf( "Failed to load media!\n" );
+			}
+			else
+			{
+				//Apply the image
+				SDL_BlitSurface( gHelloWorld.get(), NULL, gScreenSurface, NULL );
+
+				//Update the surface
+				SDL_UpdateWindowSurface( gWindow );
+
+				SDL_Delay( 5000) ;
+				close();
+
+			}
+		}
+	}
+    if( !init() )
+	{
+		printf( "Failed to initialize!\n" );
 	}
 	else
 	{
@@ -1193,6 +1619,7 @@ int main( int argc, char* args[] )
 		Tile* tileSet[ TOTAL_TILES ];
 
 		//Load media
+		Uint64 mediaStart = SDL_GetPerformanceCounter();
 		if( !loadMedia( tileSet ) )
 		{
 			printf( "Failed to load media!\n" );
@@ -1200,59 +1627,640 @@ int main( int argc, char* args[] )
 		}
 		else
 		{
+			printf( "Loaded media in %.2f ms\n", ( SDL_GetPerformanceCounter() - mediaStart ) * 1000.0 / SDL_GetPerformanceFrequency() );
+
 			//Main loop flag
 			bool quit = false;
 
-			int num = 0;
-
 			//Event handler
 			SDL_Event e;
 
+			//Everything from here to the snapshots belongs to the simulation, which may run on its own thread
 			int level = 1;
 
 			//The dot that will be moving around on the screen
 			Dot dot;
 
-			//Level 1 Code Block
-			Star level1Star1 (172, 235);
-			Star level1Star2 (172,123);
-            Goal level1Goal1 (150,168);
-			Goal level1Goal2 (150, 336);
+			//Every level's stars and goals, goals are placed from the level table
+			Star stars[ TOTAL_LEVELS ][ MAX_STARS ];
+			Goal goals[ TOTAL_LEVELS ][ MAX_STARS ];
+			for( int i = 0; i < TOTAL_LEVELS; ++i )
+			{
+				for( int j = 0; j < gLevels[ i ].goalCount; ++j )
+				{
+					goals[ i ][ j ].setPosition( gLevels[ i ].goals[ j ].x, gLevels[ i ].goals[ j ].y );
+				}
+			}
+
+			//Start over, or carry on from the autosave
+			GameState resumed = startGameState();
+			if( gResume )
+			{
+				if( loadGameState( AUTOSAVE_PATH, resumed ) )
+				{
+					printf( "Resumed level %d from %s\n", resumed.level, AUTOSAVE_PATH );
+				}
+				else
+				{
+					printf( "No autosave to resume, starting over\n" );
+					resumed = startGameState();
+				}
+			}
+			restoreGame( resumed, level, dot, stars, goals );
+
+			//Save slots, and whether play has moved on since the last autosave
+			GameState slots[ SAVE_SLOTS ];
+			bool slotUsed[ SAVE_SLOTS ] = { false };
+			bool autosaveDirty = false;
+			Uint32 lastAutosave = SDL_GetTicks();
+
+			//The wall grid hints are searched on
+			Board board;
+			buildBoard( board, tileSet );
+
+			//Hints are searched on a worker thread
+			HintEngine hints;
+			hints.start( board, gLevels, TOTAL_LEVELS );
+			HintResult hint;
+			bool showHint = false;
+
+			//Whether the hint worker is stopped while the map is painted, it starts again on the next move
+			bool hintsPaused = false;
+			Uint64 hintRequested = 0;
+
+			//Map edits show up while the game runs
+			FileWatcher mapWatcher;
+			mapWatcher.watch( LEVEL_MAP_PATH );
+			int mapVersion = 0;
+
+			//Clicked walks and pushes, fed to the simulation one move per tick
+			PathFinder pathFinder( board );
+			std::vector<int> path;
+			size_t pathStep = 0;
+			Uint64 pathClicked = 0;
+
+			//The cell of the star picked to push, -1 if none
+			int selectedStar = -1;
+
+			//Simulation time not yet run, and whether the last tick finished the level
+			Uint64 frequency = SDL_GetPerformanceFrequency();
+			double tickSeconds = 1.0 / SIM_TICKS_PER_SECOND;
+			double accumulator = 0.0;
+			Uint64 previousTime = SDL_GetPerformanceCounter();
+			Uint64 lastTickAt = previousTime;
+			bool levelDone = false;
+
+			//Counts finishes, a slot loaded back to a solved level finishes it again under the same level number
+			int completions = 0;
+
+			//Whether the last tick found no key to apply
+			bool simIdle = true;
+
+			//Keys wait here for the next simulation tick
+			SpscQueue<QueuedAction, 16> actions;
+
+			//Presses the simulation applied, waiting for the frame that shows them
+			SpscQueue<AppliedPress, 64> applied;
+
+			//Finished simulation steps, handed to drawing without either side waiting on the other
+			TripleBuffer<RenderSnapshot> snapshots;
+			int snapshotSequence = 0;
+
+			//Copies what a frame needs out of the simulation and hands it over
+			auto publishSnapshot = [ & ]()
+			{
+				RenderSnapshot& snapshot = snapshots.back();
+				snapshot.sequence = ++snapshotSequence;
+				snapshot.tickedAt = lastTickAt;
+				snapshot.level = level;
+				snapshot.levelDone = levelDone;
+				snapshot.completions = completions;
+				snapshot.dotX = dot.getX();
+				snapshot.dotY = dot.getY();
+				snapshot.dotPrevX = dot.getPrevX();
+				snapshot.dotPrevY = dot.getPrevY();
+				for( int i = 0; i < TOTAL_LEVELS; ++i )
+				{
+					for( int j = 0; j < gLevels[ i ].starCount; ++j )
+					{
+						snapshot.starX[ i ][ j ] = stars[ i ][ j ].getX();
+						snapshot.starY[ i ][ j ] = stars[ i ][ j ].getY();
+						snapshot.starPrevX[ i ][ j ] = stars[ i ][ j ].getPrevX();
+						snapshot.starPrevY[ i ][ j ] = stars[ i ][ j ].getPrevY();
+					}
+
+					for( int j = 0; j < gLevels[ i ].goalCount; ++j )
+					{
+						snapshot.goalLit[ i ][ j ] = goals[ i ][ j ].getActive();
+					}
+				}
 
-			//Level 2 Code Block
-			Star level2Star1 (322, 1019);
-			Star level2Star2 (322, 963);
-			Goal level2Goal1 (375, 1680);
-			Goal level2Goal2 (375, 1736);
+				snapshot.selectedStar = selectedStar;
+				snapshot.hintCell = showHint ? board.step( board.cellFromEntity( dot.getX(), dot.getY() ), hint.move ) : -1;
+				snapshot.searching = hints.isBusy();
+				snapshot.mapVersion = mapVersion;
+				for( int i = 0; i < TOTAL_TILES; ++i )
+				{
+					snapshot.tileTypes[ i ] = (unsigned char)tileSet[ i ]->getType();
+				}
+
+				snapshots.publish();
+			};
 
-			//Level 3 Code Block
-			Star level3Star1 (172, 2139);
-			Goal level3Goal1 (450, 2520);
+			//Runs one simulation tick, returns true if it moved on to the next level so tick timing starts over
+			auto runTick = [ & ]() -> bool
+			{
+				//Animate from where everything stood at the start of the tick
+				lastTickAt = SDL_GetPerformanceCounter();
+				dot.savePosition();
+				for( int i = 0; i < TOTAL_LEVELS; ++i )
+				{
+					for( int j = 0; j < gLevels[ i ].starCount; ++j )
+					{
+						stars[ i ][ j ].savePosition();
+					}
+				}
 
-			//Level 4 Code Block
-			Star level4Star1 (322, 2979);
-			Star level4Star2 (247, 2923);
-			Star level4Star3 (397, 2923);
-			Goal level4Goal1 (75, 2912);
-			Goal level4Goal2 (525, 2912);
-			Goal level4Goal3 (300, 3248);
+				//A finished level holds until the drawing side has shown the solved screen, keys pressed meanwhile are dropped
+				QueuedAction queued;
+				if( levelDone )
+				{
+					bool continued = false;
+					while( !continued && actions.pop( queued ) )
+					{
+						continued = queued.action == ACTION_CONTINUE;
+					}
 
-			//Level 5 Code Block
-			Star level5Star1 (322, 3539);
-			Star level5Star2 (547, 3707);
-			Goal level5Goal1 (300, 3472);
-			Goal level5Goal2 (525, 3976);
+					if( !continued )
+					{
+						return false;
+					}
+
+					level++;
+					hints.cancel();
+					showHint = false;
+					levelDone = false;
+
+					if( level <= TOTAL_LEVELS )
+					{
+						dot.setPosition( gLevels[ level - 1 ].dot.x, gLevels[ level - 1 ].dot.y );
+					}
+
+					path.clear();
+					pathStep = 0;
+					selectedStar = -1;
+
+					simIdle = true;
+					autosaveDirty = true;
+					return true;
+				}
+
+				//One queued key per tick, or the next step of a clicked path
+				simIdle = !actions.pop( queued );
+
+				//Anything but editing is play, so hints come back on the map as painted
+				if( !simIdle && hintsPaused && queued.action != ACTION_PAINT_WALL && queued.action != ACTION_PAINT_FLOOR && queued.action != ACTION_WRITE_MAP )
+				{
+					hints.start( board, gLevels, TOTAL_LEVELS );
+					hintsPaused = false;
+				}
+
+				if( !simIdle && queued.action == ACTION_CLICK )
+				{
+					//Clicking a star picks it, clicking floor walks there or pushes the picked star there
+					simIdle = true;
+					if( level <= TOTAL_LEVELS )
+					{
+						BoardState state = levelState( board, dot, stars[ level - 1 ], gLevels[ level - 1 ].starCount );
+
+						Uint64 planStart = SDL_GetPerformanceCounter();
+						bool planned = false;
+						if( findStar( state, queued.cell ) >= 0 )
+						{
+							selectedStar = queued.cell;
+						}
+						else if( selectedStar >= 0 )
+						{
+							planned = pathFinder.findPush( state, selectedStar, queued.cell, path );
+							selectedStar = -1;
+						}
+						else
+						{
+							planned = pathFinder.findWalk( state, queued.cell, path );
+						}
+
+						pathStep = 0;
+						pathClicked = queued.pressedAt;
+						if( planned )
+						{
+							printf( "Planned %d moves in %.1f us\n", (int)path.size(), ( SDL_GetPerformanceCounter() - planStart ) * 1000000.0 / frequency );
+						}
+						else
+						{
+							path.clear();
+						}
+					}
+				}
+				else if( !simIdle )
+				{
+					//Keys take over from a clicked path
+					path.clear();
+					pathStep = 0;
+					selectedStar = -1;
+				}
+
+				if( simIdle && pathStep < path.size() )
+				{
+					//Only the first step of a path counts toward click latency
+					queued.action = path[ pathStep++ ];
+					queued.pressedAt = pathStep == 1 ? pathClicked : 0;
+					simIdle = false;
+				}
+
+				if( simIdle )
+				{
+					return false;
+				}
+
+				//The press shows in the snapshot this tick publishes
+				int action = queued.action;
+				if( queued.pressedAt != 0 )
+				{
+					AppliedPress press = { snapshotSequence + 1, queued.pressedAt };
+					applied.push( press );
+				}
+
+				//Painting picks new sprites for the cell and the walls beside it, nothing else on the map is touched
+				if( action == ACTION_PAINT_WALL || action == ACTION_PAINT_FLOOR )
+				{
+					//The hint worker reads the board, so it waits out the edits
+					if( !hintsPaused )
+					{
+						hints.stop();
+						showHint = false;
+						hintsPaused = true;
+					}
+
+					//Walls can't go on the dot or a star
+					bool occupied = queued.cell == board.cellFromEntity( dot.getX(), dot.getY() );
+					if( level <= TOTAL_LEVELS )
+					{
+						BoardState state = levelState( board, dot, stars[ level - 1 ], gLevels[ level - 1 ].starCount );
+						occupied = occupied || findStar( state, queued.cell ) >= 0;
+					}
+
+					if( queued.cell >= 0 && queued.cell < TOTAL_TILES && !( action == ACTION_PAINT_WALL && occupied ) )
+					{
+						Uint64 paintStart = SDL_GetPerformanceCounter();
+						int changed[ MAX_PAINTED_CELLS ];
+						int changedCount = paintTile( board, queued.cell, action == ACTION_PAINT_WALL, changed );
+						for( int i = 0; i < changedCount; ++i )
+						{
+							tileSet[ changed[ i ] ]->setType( board.getTileType( changed[ i ] ) );
+						}
+
+						if( changedCount > 0 )
+						{
+							//Cached walk maps were flooded over the old walls
+							pathFinder.invalidate();
+							++mapVersion;
+							printf( "Painted %d tiles in %.2f us\n", changedCount, ( SDL_GetPerformanceCounter() - paintStart ) * 1000000.0 / frequency );
+						}
+					}
+					return false;
+				}
+
+				if( action == ACTION_WRITE_MAP )
+				{
+					if( board.saveToFile( LEVEL_MAP_PATH ) )
+					{
+						printf( "Wrote %s\n", LEVEL_MAP_PATH );
+					}
+					return false;
+				}
+
+				if( action == ACTION_HINT )
+				{
+					if( level <= TOTAL_LEVELS )
+					{
+						hints.request( level - 1, levelState( board, dot, stars[ level - 1 ], gLevels[ level - 1 ].starCount ) );
+						hintRequested = SDL_GetPerformanceCounter();
+						showHint = false;
+					}
+					return false;
+				}
+
+				//Saving changes nothing on screen
+				if( action >= ACTION_SAVE_SLOT && action < ACTION_SAVE_SLOT + SAVE_SLOTS )
+				{
+					Uint64 saveStart = SDL_GetPerformanceCounter();
+					slots[ action - ACTION_SAVE_SLOT ] = captureGame( level, dot, stars, goals );
+					slotUsed[ action - ACTION_SAVE_SLOT ] = true;
+					printf( "Saved slot %d in %.2f us\n", action - ACTION_SAVE_SLOT + 1, ( SDL_GetPerformanceCounter() - saveStart ) * 1000000.0 / frequency );
+					return false;
+				}
+
+				autosaveDirty = true;
+
+				//Moving makes any hint stale
+				hints.cancel();
+				showHint = false;
+
+				if( action >= ACTION_LOAD_SLOT && action < ACTION_LOAD_SLOT + SAVE_SLOTS )
+				{
+					//Jump straight back, even to another level
+					int slot = action - ACTION_LOAD_SLOT;
+					if( slotUsed[ slot ] )
+					{
+						Uint64 loadStart = SDL_GetPerformanceCounter();
+						restoreGame( slots[ slot ], level, dot, stars, goals );
+						path.clear();
+						pathStep = 0;
+						selectedStar = -1;
+						printf( "Loaded slot %d in %.2f us\n", slot + 1, ( SDL_GetPerformanceCounter() - loadStart ) * 1000000.0 / frequency );
+					}
+					else
+					{
+						printf( "Slot %d is empty\n", slot + 1 );
+					}
+				}
+				else if( action == ACTION_RESET )
+				{
+					//Put the level back the way it started
+					if( level <= TOTAL_LEVELS )
+					{
+						dot.setPosition( gLevels[ level - 1 ].dot.x, gLevels[ level - 1 ].dot.y );
+						for( int j = 0; j < gLevels[ level - 1 ].starCount; ++j )
+						{
+							stars[ level - 1 ][ j ].setPosition( gLevels[ level - 1 ].stars[ j ].x, gLevels[ level - 1 ].stars[ j ].y );
+						}
+					}
+				}
+				else
+				{
+					dot.move( tileSet, action );
+
+					//Push any star the dot walked into
+					for( int i = 0; i < TOTAL_LEVELS; ++i )
+					{
+						for( int j = 0; j < gLevels[ i ].starCount; ++j )
+						{
+							DotOnStar( &dot, &stars[ i ][ j ], tileSet, action );
+						}
+
+						for( int j = 0; j < gLevels[ i ].starCount; ++j )
+						{
+							for( int k = j + 1; k < gLevels[ i ].starCount; ++k )
+							{
+								starOnStar( &dot, &stars[ i ][ j ], &stars[ i ][ k ], tileSet, action );
+							}
+						}
+					}
+				}
+
+				//Light up goals with a star on them
+				for( int i = 0; i < TOTAL_LEVELS; ++i )
+				{
+					for( int j = 0; j < gLevels[ i ].goalCount; ++j )
+					{
+						goals[ i ][ j ].setOff();
+						for( int k = 0; k < gLevels[ i ].starCount; ++k )
+						{
+							goals[ i ][ j ].setActive( stars[ i ][ k ].getX(), stars[ i ][ k ].getY() );
+						}
+					}
+				}
+
+				levelDone = level <= TOTAL_LEVELS && levelSolved( goals[ level - 1 ], gLevels[ level - 1 ].goalCount );
+				completions += levelDone;
+				return false;
+			};
+
+			//Picks up map edits and finished hints, returns true if there's something new to draw
+			auto serviceSimulation = [ & ]() -> bool
+			{
+				bool changed = false;
+
+				//The hint worker reads the board so it stops while tiles change
+				if( mapWatcher.changed() )
+				{
+					Uint64 reloadStart = SDL_GetPerformanceCounter();
+					hints.stop();
+					showHint = false;
+
+					//The dot and the stars in play can't be walled in
+					BoardState occupied = { board.cellFromEntity( dot.getX(), dot.getY() ), 0 };
+					if( level <= TOTAL_LEVELS )
+					{
+						occupied = levelState( board, dot, stars[ level - 1 ], gLevels[ level - 1 ].starCount );
+					}
+
+					int changedTiles = reloadMap( board, tileSet, occupied );
+					hints.start( board, gLevels, TOTAL_LEVELS );
+					hintsPaused = false;
+					pathFinder.invalidate();
+					if( changedTiles >= 0 )
+					{
+						printf( "Reloaded %s: %d tiles changed in %.2f ms\n", LEVEL_MAP_PATH, changedTiles,
+							( SDL_GetPerformanceCounter() - reloadStart ) * 1000.0 / frequency );
+					}
+
+					++mapVersion;
+					changed = true;
+				}
+
+				//Pick up a finished hint without waiting for one
+				if( hints.poll( hint ) )
+				{
+					showHint = hint.move != MOVE_NONE;
+					printf( "Hint: move %d, %d moves left, searched %d nodes in %.1f ms, shown after %.1f ms\n",
+						hint.move, hint.movesLeft, hint.expandedNodes, hint.latencyMs,
+						( SDL_GetPerformanceCounter() - hintRequested ) * 1000.0 / frequency );
+					changed = true;
+				}
+
+				//Keep the autosave close behind, a crash loses at most the interval
+				if( !gHeadless && autosaveDirty && SDL_GetTicks() - lastAutosave >= AUTOSAVE_INTERVAL_MS )
+				{
+					saveGameState( AUTOSAVE_PATH, captureGame( level, dot, stars, goals ) );
+					autosaveDirty = false;
+					lastAutosave = SDL_GetTicks();
+				}
+
+				return changed;
+			};
+
+			//The first frame draws the starting positions
+			publishSnapshot();
+
+			//Everything from here on belongs to drawing, which keeps its own tiles, dot, stars and goals set from each snapshot
+			//They are copied from the simulation's before its thread starts, after that only snapshots are read
+			Tile* shownTiles[ TOTAL_TILES ];
+			for( int i = 0; i < TOTAL_TILES; ++i )
+			{
+				shownTiles[ i ] = new Tile( tileSet[ i ]->getBox().x, tileSet[ i ]->getBox().y, tileSet[ i ]->getType() );
+			}
+
+			Dot shownDot;
+			Star shownStars[ TOTAL_LEVELS ][ MAX_STARS ];
+			Goal shownGoals[ TOTAL_LEVELS ][ MAX_STARS ];
+			for( int i = 0; i < TOTAL_LEVELS; ++i )
+			{
+				for( int j = 0; j < gLevels[ i ].goalCount; ++j )
+				{
+					shownGoals[ i ][ j ].setPosition( gLevels[ i ].goals[ j ].x, gLevels[ i ].goals[ j ].y );
+				}
+			}
+			int shownMapVersion = 0;
+
+			//The finish the solved screen was last shown for
+			int continuedCompletions = 0;
+
+			//Whether clicks paint the map instead of walking
+			bool editing = false;
+
+			//Ghosts race the shown level on their own clock, drawn in one batch per texture from memory reserved here
+			GhostReplay ghosts;
+			ghosts.setLevels( board, gLevels, TOTAL_LEVELS );
+			if( !gGhostPath.empty() && ghosts.load( gGhostPath ) )
+			{
+				printf( "Racing %d ghosts from %s\n", ghosts.getGhostCount(), gGhostPath.c_str() );
+			}
+			std::vector<GhostSprite> ghostDots, ghostStars;
+			std::vector<SDL_Point> ghostPoints;
+			ghostDots.reserve( ghosts.getGhostCount() );
+			ghostStars.reserve( ghosts.getGhostCount() * MAX_STARS );
+			ghostPoints.reserve( ghosts.getGhostCount() * MAX_STARS );
+			gDotTexture.reserveBatch( ghosts.getGhostCount() );
+			gStarTexture.reserveBatch( ghosts.getGhostCount() * MAX_STARS );
+			int ghostLevel = -1;
+			double ghostClock = 0.0;
+			double ghostMoveSeconds = 1.0 / GHOST_MOVES_PER_SECOND;
+			Uint64 ghostFrameAt = SDL_GetPerformanceCounter();
+
+			//Headless runs play a move log, one move per frame, and hash every frame
+			std::vector<int> scripted;
+			size_t scriptStep = 0;
+			if( gHeadless && !gMoveLogPath.empty() && !loadMoveLog( gMoveLogPath, scripted ) )
+			{
+				quit = true;
+			}
+
+			FILE* hashFile = NULL;
+			if( gHeadless && !gFrameHashPath.empty() )
+			{
+				hashFile = fopen( gFrameHashPath.c_str(), "w" );
+				if( hashFile == NULL )
+				{
+					printf( "Unable to write frame hashes to %s!\n", gFrameHashPath.c_str() );
+					quit = true;
+				}
+			}
 
+			int headlessFrames = gHeadlessFrames > 0 ? gHeadlessFrames : (int)scripted.size() + HEADLESS_SETTLE_FRAMES;
+			int framesDrawn = 0;
+			double renderMs = 0.0;
+			unsigned long long runHash = 14695981039346656037ull;
 
+			//Frame times with and without a hint search running
+			FrameTimes idleFrames, searchFrames;
 
 			//Level camera
 			SDL_Rect camera = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
 
+			//Presses applied but not yet on screen, and how long they took to show
+			std::vector<AppliedPress> unshown;
+			unshown.reserve( 64 );
+			LatencyStats latency;
+
+			//Allocations per subsystem at the start of the frame, and since warm up
+			int frameNumber = 0;
+			int allocatingFrames = 0;
+			long long frameCounts[ ALLOC_SUBSYSTEMS ];
+			long long steadyCounts[ ALLOC_SUBSYSTEMS ] = { 0 };
+
+			//The display's refresh period and the last frame's work, for waking just before vblank
+			double refreshMs = 1000.0 / 60;
+			SDL_DisplayMode displayMode;
+			if( SDL_GetCurrentDisplayMode( SDL_GetWindowDisplayIndex( gWindow ), &displayMode ) == 0 && displayMode.refresh_rate > 0 )
+			{
+				refreshMs = 1000.0 / displayMode.refresh_rate;
+			}
+			double workMs = 0.0;
+
+			//The simulation's own thread ticks on its own clock and publishes each step
+			std::atomic<bool> simQuit( false );
+			std::thread simThread;
+			if( gSimThread )
+			{
+				simThread = std::thread( [ & ]()
+				{
+					AllocationScope simulationScope( ALLOC_SIMULATION );
+					Uint64 tickCounts = (Uint64)( tickSeconds * frequency );
+					Uint64 catchupCounts = (Uint64)( SIM_MAX_CATCHUP * frequency );
+					Uint64 nextTick = SDL_GetPerformanceCounter() + tickCounts;
+					while( !simQuit )
+					{
+						bool changed = serviceSimulation();
+
+						//An idle simulation takes a key at once in low latency mode instead of at the tick boundary
+						Uint64 now = SDL_GetPerformanceCounter();
+						bool early = gLowLatency && simIdle && !actions.empty();
+						if( now >= nextTick || early )
+						{
+							bool restarted = runTick();
+							changed = true;
+
+							//Don't replay a burst of ticks after a stall
+							if( restarted || early )
+							{
+								nextTick = now + tickCounts;
+							}
+							else
+							{
+								nextTick += tickCounts;
+								if( now > nextTick + catchupCounts )
+								{
+									nextTick = now;
+								}
+							}
+						}
+
+						if( changed )
+						{
+							publishSnapshot();
+						}
+						else
+						{
+							SDL_Delay( 1 );
+						}
+					}
+				} );
+			}
+
 			//While application is running
 			while( !quit )
 			{
+				//Sleep off most of the refresh so input is read just before the frame that shows it
+				if( gLowLatency && gPacing == PACING_VSYNC )
+				{
+					double sleepMs = refreshMs - workMs - LOW_LATENCY_MARGIN_MS;
+					if( sleepMs >= 1.0 )
+					{
+						SDL_Delay( (Uint32)sleepMs );
+					}
+				}
+
+				Uint64 frameStart = SDL_GetPerformanceCounter();
+				AllocationScope frameScope( ALLOC_FRAME );
+				for( int i = 0; i < ALLOC_SUBSYSTEMS; ++i )
+				{
+					frameCounts[ i ] = allocationCount( i );
+				}
+
 				//Handle events on queue
-				while( SDL_PollEvent( &e ) != 0 )
+				AllocationScope inputScope( ALLOC_INPUT );
+				while( !gHeadless && SDL_PollEvent( &e ) != 0 )
 				{
 					//User requests quit
 					if( e.type == SDL_QUIT )
@@ -1261,76 +2269,165 @@ int main( int argc, char* args[] )
 					}
 
 					//Handle input for the dot
-					int movement = dot.handleEvent( e, tileSet );
+					int action = shownDot.handleEvent( e );
 
-					if( movement == 5 )
+					//The editor is only a different meaning for clicks, and the map is only written from it
+					if( action == ACTION_EDIT )
 					{
-					    if (level == 1)
-                        {
-                            dot.setPosition(97,67);
-                            level1Star1.setPosition(172, 235);
-                            level1Star2.setPosition(172,123);
-                        }
-                        else if (level == 2)
-                        {
-                            dot.setPosition(172, 1019);
-                            level2Star1.setPosition(322, 1019);
-                            level2Star2.setPosition(322, 963);
-                        }
-                        else if (level == 3)
-                        {
-                            dot.setPosition(172, 2083);
-                            level3Star1.setPosition (172, 2139);
-                        }
-                        else if (level == 4)
-                        {
-                            dot.setPosition(322, 2867);
-                            level4Star1.setPosition (322, 2979);
-                            level4Star2.setPosition (247, 2923);
-                            level4Star3.setPosition (397, 2923);
-                        }
-                        else if (level == 5)
-                        {
-                           dot.setPosition(97, 3595);
-                           level5Star1.setPosition (322, 3539);
-                           level5Star2.setPosition (547, 3707);
-                        }
+						editing = !editing;
+						printf( editing ? "Editing the map, left click paints wall, right click floor, W writes it\n" : "Back to play\n" );
+						action = MOVE_NONE;
+					}
+					else if( action == ACTION_WRITE_MAP && !editing )
+					{
+						action = MOVE_NONE;
 					}
-					else if (movement == 6)
-                    {
-                        quit = true;
-                    }
 
-                    //Level 1
-                    DotOnStar(&dot, &level1Star1, tileSet, movement);
-					DotOnStar(&dot, &level1Star2, tileSet, movement);
-					starOnStar(&dot, &level1Star1, &level1Star2, tileSet, movement);
+					//Clicks go to the simulation as the cell under the pointer
+					int cell = -1;
+					if( e.type == SDL_MOUSEBUTTONDOWN && ( e.button.button == SDL_BUTTON_LEFT || ( editing && e.button.button == SDL_BUTTON_RIGHT ) ) )
+					{
+						action = ACTION_CLICK;
+						if( editing )
+						{
+							action = e.button.button == SDL_BUTTON_LEFT ? ACTION_PAINT_WALL : ACTION_PAINT_FLOOR;
+						}
+						cell = board.cellFromGoal( e.button.x + camera.x, e.button.y + camera.y );
+					}
 
-					//Level 2
-					DotOnStar(&dot, &level2Star1, tileSet, movement);
-					DotOnStar(&dot, &level2Star2, tileSet, movement);
-					starOnStar(&dot, &level2Star1, &level2Star2, tileSet, movement);
+					if( action == ACTION_QUIT )
+					{
+						quit = true;
+					}
+					else if( action != MOVE_NONE )
+					{
+						//Date the press by when SDL saw it, not when the loop got to it
+						Uint32 waitedMs = SDL_GetTicks() - ( e.type == SDL_MOUSEBUTTONDOWN ? e.button.timestamp : e.key.timestamp );
+						QueuedAction queued = { action, SDL_GetPerformanceCounter() - waitedMs * frequency / 1000, cell };
+
+						//A full queue drops the key rather than falling further behind
+						actions.push( queued );
+
+						//An idle simulation starts its tick now instead of at the next tick boundary
+						if( !gSimThread && gLowLatency && simIdle && accumulator < tickSeconds )
+						{
+							accumulator = tickSeconds;
+						}
+					}
+				}
 
-					//Level 3
-					DotOnStar(&dot, &level3Star1, tileSet, movement);
+				//Without a simulation thread the ticks run here, before drawing
+				if( !gSimThread )
+				{
+					AllocationScope simulationScope( ALLOC_SIMULATION );
+					//Feed the move log in, holding back while a finished level moves on so no move is dropped
+					if( gHeadless && !levelDone && scriptStep < scripted.size() )
+					{
+						QueuedAction queued = { scripted[ scriptStep ], 0, -1 };
+						if( actions.push( queued ) )
+						{
+							++scriptStep;
+						}
+					}
 
-					// Level 4
-					DotOnStar(&dot, &level4Star1, tileSet, movement);
-					DotOnStar(&dot, &level4Star2, tileSet, movement);
-					DotOnStar(&dot, &level4Star3, tileSet, movement);
-					starOnStar(&dot, &level4Star1, &level4Star2, tileSet, movement);
-					starOnStar(&dot, &level4Star1, &level4Star3, tileSet, movement);
-					starOnStar(&dot, &level4Star2, &level4Star3, tileSet, movement);
+					bool changed = serviceSimulation();
 
-					// level 5
-					DotOnStar(&dot, &level5Star1, tileSet, movement);
-					DotOnStar(&dot, &level5Star2, tileSet, movement);
-					starOnStar(&dot, &level5Star1, &level5Star2, tileSet, movement);
+					//Run the ticks the time since the last frame covers, headless frames are one tick apart
+					accumulator += gHeadless ? tickSeconds : ( frameStart - previousTime ) / (double)frequency;
+					previousTime = frameStart;
+					if( accumulator > SIM_MAX_CATCHUP )
+					{
+						accumulator = SIM_MAX_CATCHUP;
+					}
 
+					while( accumulator >= tickSeconds && !quit )
+					{
+						accumulator -= tickSeconds;
+						changed = true;
+
+						//Forget the time the solved screen took
+						if( runTick() )
+						{
+							accumulator = 0.0;
+							previousTime = SDL_GetPerformanceCounter();
+							break;
+						}
+					}
+
+					if( changed )
+					{
+						publishSnapshot();
+					}
 				}
 
+				//Take the newest snapshot, frames between ticks keep drawing the last one
+				AllocationScope renderScope( ALLOC_RENDER );
+				if( snapshots.update() )
+				{
+					const RenderSnapshot& snapshot = snapshots.front();
+					if( snapshot.mapVersion != shownMapVersion )
+					{
+						for( int i = 0; i < TOTAL_TILES; ++i )
+						{
+							shownTiles[ i ]->setType( snapshot.tileTypes[ i ] );
+							ghosts.setTileType( i, snapshot.tileTypes[ i ] );
+						}
+						shownMapVersion = snapshot.mapVersion;
+
+						//The shown level's ghosts start over so their runs play out against the new walls
+						ghostLevel = -1;
+					}
+
+					shownDot.setPosition( snapshot.dotX, snapshot.dotY );
+					shownDot.setPrevious( snapshot.dotPrevX, snapshot.dotPrevY );
+					for( int i = 0; i < TOTAL_LEVELS; ++i )
+					{
+						for( int j = 0; j < gLevels[ i ].starCount; ++j )
+						{
+							shownStars[ i ][ j ].setPosition( snapshot.starX[ i ][ j ], snapshot.starY[ i ][ j ] );
+							shownStars[ i ][ j ].setPrevious( snapshot.starPrevX[ i ][ j ], snapshot.starPrevY[ i ][ j ] );
+						}
+
+						for( int j = 0; j < gLevels[ i ].goalCount; ++j )
+						{
+							shownGoals[ i ][ j ].setLit( snapshot.goalLit[ i ][ j ] );
+						}
+					}
+				}
+
+				const RenderSnapshot& shown = snapshots.front();
+				bool searching = shown.searching;
+
+				//How far the next tick has got, for drawing between tick positions
+				double alpha = accumulator / tickSeconds;
+				if( gSimThread )
+				{
+					alpha = ( frameStart - shown.tickedAt ) / (double)frequency / tickSeconds;
+					alpha = alpha > 1.0 ? 1.0 : alpha;
+				}
+
+				//Ghosts start over with each level and play a move whenever their clock says so, headless at one tick per frame
+				int ghostIndex = shown.level - 1;
+				if( ghostIndex != ghostLevel )
+				{
+					ghostLevel = ghostIndex;
+					ghostClock = 0.0;
+					ghosts.restart( ghostLevel );
+				}
+				ghostClock += gHeadless ? tickSeconds : ( frameStart - ghostFrameAt ) / (double)frequency;
+				ghostFrameAt = frameStart;
+				ghostClock = ghostClock > SIM_MAX_CATCHUP ? SIM_MAX_CATCHUP : ghostClock;
+				while( ghostClock >= ghostMoveSeconds )
+				{
+					ghostClock -= ghostMoveSeconds;
+					ghosts.step( ghostLevel );
+				}
+				ghosts.collect( ghostLevel, ghostDots, ghostStars );
+				double ghostAlpha = ghostClock / ghostMoveSeconds;
+
 				//Move the dot
-				dot.setCamera( camera );
+				Uint64 renderStart = SDL_GetPerformanceCounter();
+				shownDot.setCamera( camera, alpha );
 
 				//Clear screen
 				SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
@@ -1339,112 +2436,221 @@ int main( int argc, char* args[] )
 				//Render level
 				for( int i = 0; i < TOTAL_TILES; ++i )
 				{
-					tileSet[ i ]->render( camera );
+					shownTiles[ i ]->render( camera );
 				}
 
-				//Level 1
-				level1Goal1.setOff();
-				level1Goal2.setOff();
-                level1Goal1.setActive(level1Star1.getX(), level1Star1.getY());
-                level1Goal1.setActive(level1Star2.getX(), level1Star2.getY());
-                level1Goal2.setActive(level1Star1.getX(), level1Star1.getY());
-                level1Goal2.setActive(level1Star2.getX(), level1Star2.getY());
-
-                //Level 2
-                level2Goal1.setOff();
-				level2Goal2.setOff();
-                level2Goal1.setActive(level2Star1.getX(), level2Star1.getY());
-                level2Goal1.setActive(level2Star2.getX(), level2Star2.getY());
-                level2Goal2.setActive(level2Star1.getX(), level2Star1.getY());
-                level2Goal2.setActive(level2Star2.getX(), level2Star2.getY());
-
-                //Level 3
-                level3Goal1.setOff();
-                level3Goal1.setActive(level3Star1.getX(), level3Star1.getY());
-
-                //Level 4
-                level4Goal1.setOff();
-				level4Goal2.setOff();
-				level4Goal3.setOff();
-                level4Goal1.setActive(level4Star1.getX(), level4Star1.getY());
-                level4Goal1.setActive(level4Star2.getX(), level4Star2.getY());
-                level4Goal1.setActive(level4Star3.getX(), level4Star3.getY());
-                level4Goal2.setActive(level4Star1.getX(), level4Star1.getY());
-                level4Goal2.setActive(level4Star2.getX(), level4Star2.getY());
-                level4Goal2.setActive(level4Star3.getX(), level4Star3.getY());
-                level4Goal3.setActive(level4Star1.getX(), level4Star1.getY());
-                level4Goal3.setActive(level4Star2.getX(), level4Star2.getY());
-                level4Goal3.setActive(level4Star3.getX(), level4Star3.getY());
-
-                //Level 5
-                level5Goal1.setOff();
-				level5Goal2.setOff();
-                level5Goal1.setActive(level5Star1.getX(), level5Star1.getY());
-                level5Goal1.setActive(level5Star2.getX(), level5Star2.getY());
-                level5Goal2.setActive(level5Star1.getX(), level5Star1.getY());
-                level5Goal2.setActive(level5Star2.getX(), level5Star2.getY());
-
-
-
-				//Render dot
-				level1Goal1.render( camera );
-				level1Goal2.render( camera );
-				level2Goal1.render( camera );
-				level2Goal2.render( camera );
-				level3Goal1.render( camera );
-				level4Goal1.render( camera );
-				level4Goal2.render( camera );
-				level4Goal3.render( camera );
-				level5Goal1.render( camera );
-				level5Goal2.render( camera );
-
-				dot.render( camera );
-				level1Star1.render( camera );
-				level1Star2.render( camera );
-				level2Star1.render( camera );
-				level2Star2.render( camera );
-				level3Star1.render( camera );
-				level4Star1.render( camera );
-				level4Star2.render( camera );
-				level4Star3.render( camera );
-				level5Star1.render( camera );
-				level5Star2.render( camera );
+				//Render goals
+				for( int i = 0; i < TOTAL_LEVELS; ++i )
+				{
+					for( int j = 0; j < gLevels[ i ].goalCount; ++j )
+					{
+						shownGoals[ i ][ j ].render( camera );
+					}
+				}
 
+				//Mark the cell the hint says to step to
+				if( shown.hintCell >= 0 )
+				{
+					SDL_Rect marker = { board.entityX( shown.hintCell ) - 8 - camera.x, board.entityY( shown.hintCell ) - 6 - camera.y, Dot::DOT_WIDTH + 16, Dot::DOT_HEIGHT + 12 };
+					SDL_SetRenderDrawBlendMode( gRenderer, SDL_BLENDMODE_BLEND );
+					SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xD7, 0x00, 0x80 );
+					SDL_RenderFillRect( gRenderer, &marker );
+				}
+
+				//Outline the star picked to push
+				if( shown.selectedStar >= 0 )
+				{
+					SDL_Rect outline = { board.entityX( shown.selectedStar ) - 4 - camera.x, board.entityY( shown.selectedStar ) - 4 - camera.y, Dot::DOT_WIDTH + 8, Dot::DOT_HEIGHT + 8 };
+					SDL_SetRenderDrawColor( gRenderer, 0x00, 0x7F, 0xFF, 0xFF );
+					SDL_RenderDrawRect( gRenderer, &outline );
+				}
+
+				//Render ghosts under the player, their stars then their dots, each in one batch
+				ghostPoints.clear();
+				for( size_t i = 0; i < ghostStars.size(); ++i )
+				{
+					SDL_Point point = { interpolate( ghostStars[ i ].prevX, ghostStars[ i ].x, ghostAlpha ) - camera.x, interpolate( ghostStars[ i ].prevY, ghostStars[ i ].y, ghostAlpha ) - camera.y };
+					ghostPoints.push_back( point );
+				}
+				gStarTexture.renderBatch( ghostPoints.empty() ? NULL : &ghostPoints[ 0 ], (int)ghostPoints.size(), GHOST_ALPHA );
+
+				ghostPoints.clear();
+				for( size_t i = 0; i < ghostDots.size(); ++i )
+				{
+					SDL_Point point = { interpolate( ghostDots[ i ].prevX, ghostDots[ i ].x, ghostAlpha ) - camera.x, interpolate( ghostDots[ i ].prevY, ghostDots[ i ].y, ghostAlpha ) - camera.y };
+					ghostPoints.push_back( point );
+				}
+				gDotTexture.renderBatch( ghostPoints.empty() ? NULL : &ghostPoints[ 0 ], (int)ghostPoints.size(), GHOST_ALPHA );
+
+				//Render dot and stars
+				shownDot.render( camera, alpha );
+				for( int i = 0; i < TOTAL_LEVELS; ++i )
+				{
+					for( int j = 0; j < gLevels[ i ].starCount; ++j )
+					{
+						shownStars[ i ][ j ].render( camera, alpha );
+					}
+				}
 
 				//Update screen
+				workMs = ( SDL_GetPerformanceCounter() - frameStart ) * 1000.0 / frequency;
+				int presentedSequence = shown.sequence;
 				SDL_RenderPresent( gRenderer );
 
-				if (level == 1 && level1Goal1.getActive() == true && level1Goal2.getActive() == true)
-                {
-                    solve();
-                    level++;
-                    dot.setPosition(172, 1019);
-                }
-                else if (level == 2 && level2Goal1.getActive() == true && level2Goal2.getActive() == true)
-                {
-                    solve();
-                    level ++;
-                    dot.setPosition(172, 2083);
-                }
-                else if (level == 3 && level3Goal1.getActive() == true)
-                {
-                    solve();
-                    level++;
-                    dot.setPosition(322, 2867);
-                }
-                else if (level == 4 && level4Goal1.getActive() == true && level4Goal2.getActive() == true && level4Goal3.getActive() == true)
-                {
-                    solve();
-                    level++;
-                    dot.setPosition(97, 3595);
-                }
-                else if (level == 5 && level5Goal1.getActive() == true && level5Goal2.getActive() == true)
-                {
-                    solve();
-                    level++;
-                }
+				//Keep the offscreen frame's hash, and the frame itself if asked
+				AllocationScope bookkeepingScope( ALLOC_FRAME );
+				if( gHeadless )
+				{
+					renderMs += ( SDL_GetPerformanceCounter() - renderStart ) * 1000.0 / frequency;
+
+					unsigned long long frameHash = hashSurface( gFrameSurface );
+					runHash = ( runHash ^ frameHash ) * 1099511628211ull;
+					if( hashFile != NULL )
+					{
+						fprintf( hashFile, "%d %016llx\n", framesDrawn, frameHash );
+					}
+
+					if( !gFrameDumpDirectory.empty() )
+					{
+						char name[ 1024 ];
+						snprintf( name, sizeof( name ), "%s/frame%05d.bmp", gFrameDumpDirectory.c_str(), framesDrawn );
+						if( SDL_SaveBMP( gFrameSurface, name ) != 0 )
+						{
+							printf( "Unable to dump frame %d! SDL Error: %s\n", framesDrawn, SDL_GetError() );
+						}
+					}
+
+					if( ++framesDrawn >= headlessFrames )
+					{
+						quit = true;
+					}
+				}
+
+				//Every press in the snapshot just presented has now been shown
+				Uint64 presented = SDL_GetPerformanceCounter();
+				AppliedPress press;
+				while( applied.pop( press ) )
+				{
+					unshown.push_back( press );
+				}
+
+				for( size_t i = 0; i < unshown.size(); )
+				{
+					if( unshown[ i ].sequence <= presentedSequence )
+					{
+						latency.add( ( presented - unshown[ i ].pressedAt ) * 1000.0 / frequency );
+						unshown[ i ] = unshown.back();
+						unshown.pop_back();
+					}
+					else
+					{
+						++i;
+					}
+				}
 
+				//Show the solved screen once the finishing push is on screen, then let the simulation move on
+				if( shown.levelDone && shown.completions != continuedCompletions )
+				{
+					if( !gHeadless )
+					{
+						solve();
+					}
 
+					QueuedAction queued = { ACTION_CONTINUE, 0, -1 };
+					if( actions.push( queued ) )
+					{
+						continuedCompletions = shown.completions;
+					}
+				}
+
+				//Gameplay shouldn't allocate once the first frames are out of the way
+				bool allocated = false;
+				for( int i = 0; i < ALLOC_SUBSYSTEMS; ++i )
+				{
+					frameCounts[ i ] = allocationCount( i ) - frameCounts[ i ];
+					if( frameNumber >= ALLOC_WARMUP_FRAMES )
+					{
+						steadyCounts[ i ] += frameCounts[ i ];
+						allocated = allocated || ( frameCounts[ i ] > 0 && ( i == ALLOC_INPUT || i == ALLOC_SIMULATION || i == ALLOC_RENDER ) );
+					}
+				}
+
+				if( allocated && ++allocatingFrames <= ALLOC_FRAME_REPORTS )
+				{
+					printf( "Frame %d allocated: %lld input, %lld simulation, %lld render\n", frameNumber,
+						frameCounts[ ALLOC_INPUT ], frameCounts[ ALLOC_SIMULATION ], frameCounts[ ALLOC_RENDER ] );
+				}
+				++frameNumber;
+
+				//Keep frame times apart by whether a search was running
+				double frameMs = ( SDL_GetPerformanceCounter() - frameStart ) * 1000.0 / frequency;
+				( searching ? searchFrames : idleFrames ).add( frameMs );
+
+				//Hold the target frame rate, sleeping through most of the wait and spinning out the rest
+				if( gPacing == PACING_TARGET_FPS )
+				{
+					Uint64 deadline = frameStart + frequency / gTargetFps;
+					Uint64 current = SDL_GetPerformanceCounter();
+					while( current < deadline )
+					{
+						double leftMs = ( deadline - current ) * 1000.0 / frequency;
+						if( leftMs > 2.0 )
+						{
+							SDL_Delay( (Uint32)( leftMs - 1.0 ) );
+						}
+
+						current = SDL_GetPerformanceCounter();
+					}
+				}
+			}
+
+			//Stop the simulation before anything it uses goes away
+			if( simThread.joinable() )
+			{
+				simQuit = true;
+				simThread.join();
+			}
+
+			hints.stop();
+			if( !gHeadless && autosaveDirty )
+			{
+				saveGameState( AUTOSAVE_PATH, captureGame( level, dot, stars, goals ) );
+			}
+
+			for( int i = 0; i < TOTAL_TILES; ++i )
+			{
+				delete shownTiles[ i ];
+			}
+
+			if( gHeadless )
+			{
+				if( hashFile != NULL )
+				{
+					fclose( hashFile );
+				}
+
+				printf( "Headless: %d frames, %d of %d moves played, %.2f ms drawing, %.1f frames per second, run hash %016llx\n",
+					framesDrawn, (int)scriptStep, (int)scripted.size(), renderMs, renderMs > 0.0 ? framesDrawn * 1000.0 / renderMs : 0.0, runHash );
+			}
+
+			idleFrames.print( "Frames without a hint search" );
+			searchFrames.print( "Frames during a hint search" );
+			latency.print( gLowLatency ? "Input latency, low latency mode" : "Input latency" );
+
+			//Report where the heap was used, and fail if gameplay touched it
+			if( allocationTracking() )
+			{
+				for( int i = 0; i < ALLOC_SUBSYSTEMS; ++i )
+				{
+					printf( "Allocations, %s: %lld in total, %.1f KB, %lld after warm up\n", allocationSubsystemName( i ),
+						allocationCount( i ), allocationBytes( i ) / 1024.0, steadyCounts[ i ] );
+				}
+
+				if( allocatingFrames > 0 )
+				{
+					printf( "%d of %d frames allocated during play!\n", allocatingFrames, frameNumber );
+					exitCode = 1;
+				}
 			}
 		}
 
@@ -1452,7 +2658,7 @@ int main( int argc, char* args[] )
 		close( tileSet );
 	}
 
-	return 0;
+	return exitCode;
 }
 
 void DotOnStar (Dot *dot, Star *star, Tile *tileSet[], int movement )
@@ -1528,7 +2734,7 @@ void solve()
 		else
 		{
 			//Apply the image
-			SDL_BlitSurface( gSolved, NULL, gScreenSurface, NULL );
+			SDL_BlitSurface( gSolved.get(), NULL, gScreenSurface, NULL );
 
 			//Update the surface
 			SDL_UpdateWindowSurface( gWindow );
@@ -1540,3 +2746,146 @@ void solve()
 	close();
 }
 
+void buildBoard( Board& board, Tile* tiles[] )
+{
+	int types[ TOTAL_TILES ];
+	for( int i = 0; i < TOTAL_TILES; ++i )
+	{
+		types[ i ] = tiles[ i ]->getType();
+	}
+
+	board.loadFromTypes( types, BOARD_COLUMNS, TOTAL_TILES / BOARD_COLUMNS );
+}
+
+BoardState levelState( const Board& board, Dot& dot, Star stars[], int starCount )
+{
+	BoardState state;
+	state.player = board.cellFromEntity( dot.getX(), dot.getY() );
+	state.starCount = starCount;
+	for( int i = 0; i < starCount; ++i )
+	{
+		state.stars[ i ] = board.cellFromEntity( stars[ i ].getX(), stars[ i ].getY() );
+	}
+
+	sortStars( state );
+	return state;
+}
+
+bool levelSolved( Goal goals[], int goalCount )
+{
+	for( int i = 0; i < goalCount; ++i )
+	{
+		if( !goals[ i ].getActive() )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+GameState captureGame( int level, Dot& dot, Star stars[][ MAX_STARS ], Goal goals[][ MAX_STARS ] )
+{
+	GameState state;
+	state.level = level;
+	state.dotX = (short)dot.getX();
+	state.dotY = (short)dot.getY();
+	for( int i = 0; i < TOTAL_LEVELS; ++i )
+	{
+		for( int j = 0; j < MAX_STARS; ++j )
+		{
+			bool used = j < gLevels[ i ].starCount;
+			state.starX[ i ][ j ] = used ? (short)stars[ i ][ j ].getX() : 0;
+			state.starY[ i ][ j ] = used ? (short)stars[ i ][ j ].getY() : 0;
+			state.goalLit[ i ][ j ] = j < gLevels[ i ].goalCount && goals[ i ][ j ].getActive();
+		}
+	}
+
+	return state;
+}
+
+void restoreGame( const GameState& state, int& level, Dot& dot, Star stars[][ MAX_STARS ], Goal goals[][ MAX_STARS ] )
+{
+	level = state.level;
+	dot.setPosition( state.dotX, state.dotY );
+	for( int i = 0; i < TOTAL_LEVELS; ++i )
+	{
+		for( int j = 0; j < gLevels[ i ].starCount; ++j )
+		{
+			stars[ i ][ j ].setPosition( state.starX[ i ][ j ], state.starY[ i ][ j ] );
+		}
+
+		for( int j = 0; j < gLevels[ i ].goalCount; ++j )
+		{
+			goals[ i ][ j ].setLit( state.goalLit[ i ][ j ] != 0 );
+		}
+	}
+}
+
+int interpolate( int from, int to, double alpha )
+{
+	return from + (int)( ( to - from ) * alpha );
+}
+
+unsigned long long hashSurface( SDL_Surface* surface )
+{
+	if( SDL_MUSTLOCK( surface ) )
+	{
+		SDL_LockSurface( surface );
+	}
+
+	//Row by row, so padding at the end of a row doesn't count
+	unsigned long long hash = 14695981039346656037ull;
+	int rowBytes = surface->w * surface->format->BytesPerPixel;
+	for( int y = 0; y < surface->h; ++y )
+	{
+		const unsigned char* row = (const unsigned char*)surface->pixels + y * surface->pitch;
+		for( int x = 0; x < rowBytes; ++x )
+		{
+			hash = ( hash ^ row[ x ] ) * 1099511628211ull;
+		}
+	}
+
+	if( SDL_MUSTLOCK( surface ) )
+	{
+		SDL_UnlockSurface( surface );
+	}
+
+	return hash;
+}
+
+int reloadMap( Board& board, Tile* tiles[], const BoardState& occupied )
+{
+	//A half written file fails here and the next write gets another try
+	Board next;
+	if( !next.loadFromFile( LEVEL_MAP_PATH ) )
+	{
+		return -1;
+	}
+
+	//The tile set is a fixed size
+	if( next.getCellCount() != TOTAL_TILES )
+	{
+		printf( "Error reloading map: Expected %d tiles but found %d!\n", TOTAL_TILES, next.getCellCount() );
+		return -1;
+	}
+
+	int changed = 0;
+	for( int i = 0; i < TOTAL_TILES; ++i )
+	{
+		if( next.getTileType( i ) != tiles[ i ]->getType() )
+		{
+			if( next.isWall( i ) && !board.isWall( i ) && ( i == occupied.player || findStar( occupied, i ) >= 0 ) )
+			{
+				printf( "Kept tile %d as floor, the %s is on it\n", i, i == occupied.player ? "dot" : "star" );
+				continue;
+			}
+
+			tiles[ i ]->setType( next.getTileType( i ) );
+			board.setTileType( i, next.getTileType( i ) );
+			++changed;
+		}
+	}
+
+	return changed;
+}
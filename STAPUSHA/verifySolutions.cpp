@@ -0,0 +1,372 @@
+/*Checks submitted solutions against the game rules across every core.
+Usage: SolutionVerifier [--pack path] [--out path] [--threads n] [input ...]
+Each input is a solution file, a directory of them or - for standard input, which is read when none are given.
+Solution files hold solution lines, the 1 based level number and then its move log letters.
+Levels are the shipped ones unless --pack names a level pack. Results are written as CSV, one row per solution.*/
+
+//Using standard IO, the standard library, strings, vectors, sorting and timers
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "board.h"
+#include "levels.h"
+#include "levelPack.h"
+#include "moveLog.h"
+#include "parallel.h"
+
+//How many solutions are read before a batch is verified
+const int VERIFY_BATCH = 1 << 16;
+
+//How many solutions each parallelFor index verifies
+const int SOLUTIONS_PER_CHUNK = 256;
+
+//A level as the verifier plays it, boards are shared and never change
+struct VerifyLevel
+{
+	const Board* board;
+	BoardState start;
+	int goals[ MAX_STARS ];
+	int goalCount;
+};
+
+//Why a solution failed
+enum VerifyResult
+{
+	VERIFY_PASS,
+	VERIFY_MALFORMED,
+	VERIFY_UNKNOWN_LEVEL,
+	VERIFY_UNSOLVED,
+	VERIFY_MOVES_AFTER_SOLVE
+};
+
+//The CSV result column for each outcome
+const char* VERIFY_RESULT_NAMES[] = { "pass", "malformed", "unknown level", "unsolved", "moves after solve" };
+
+//One submitted solution and how it did
+struct Submission
+{
+	int source;
+	int line;
+	int level;
+	std::vector<int> moves;
+
+	VerifyResult result;
+	int moveCount;
+	int pushCount;
+};
+
+//Adds the files of a directory in name order, or the path itself if it isn't one
+static void addInput( const std::string& path, std::vector<std::string>& inputs )
+{
+	std::vector<std::string> files;
+
+	#ifdef _WIN32
+	DWORD attributes = GetFileAttributesA( path.c_str() );
+	if( attributes == INVALID_FILE_ATTRIBUTES || !( attributes & FILE_ATTRIBUTE_DIRECTORY ) )
+	{
+		inputs.push_back( path );
+		return;
+	}
+
+	WIN32_FIND_DATAA found;
+	HANDLE search = FindFirstFileA( ( path + "\\*" ).c_str(), &found );
+	while( search != INVALID_HANDLE_VALUE )
+	{
+		if( !( found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) )
+		{
+			files.push_back( path + "/" + found.cFileName );
+		}
+
+		if( !FindNextFileA( search, &found ) )
+		{
+			FindClose( search );
+			search = INVALID_HANDLE_VALUE;
+		}
+	}
+	#else
+	DIR* directory = opendir( path.c_str() );
+	if( directory == NULL )
+	{
+		inputs.push_back( path );
+		return;
+	}
+	for( dirent* entry = readdir( directory ); entry != NULL; entry = readdir( directory ) )
+	{
+		std::string file = path + "/" + entry->d_name;
+		struct stat info;
+		if( stat( file.c_str(), &info ) == 0 && S_ISREG( info.st_mode ) )
+		{
+			files.push_back( file );
+		}
+	}
+	closedir( directory );
+	#endif
+
+	std::sort( files.begin(), files.end() );
+	inputs.insert( inputs.end(), files.begin(), files.end() );
+}
+
+//Replays one solution by the rules of Dot::move, DotOnStar and starOnStar
+static void verify( const std::vector<VerifyLevel>& levels, Submission& submission )
+{
+	submission.moveCount = 0;
+	submission.pushCount = 0;
+	if( submission.result == VERIFY_MALFORMED )
+	{
+		return;
+	}
+
+	if( submission.level < 1 || submission.level > (int)levels.size() )
+	{
+		submission.result = VERIFY_UNKNOWN_LEVEL;
+		return;
+	}
+
+	const VerifyLevel& level = levels[ submission.level - 1 ];
+	BoardState state = level.start;
+	bool solved = false;
+	for( size_t i = 0; i < submission.moves.size(); ++i )
+	{
+		//The game moves on to the next level as soon as this one is solved
+		if( solved )
+		{
+			submission.result = VERIFY_MOVES_AFTER_SOLVE;
+			return;
+		}
+
+		if( submission.moves[ i ] == MOVE_RESET )
+		{
+			state = level.start;
+			continue;
+		}
+
+		//Blocked moves leave the dot where it is, just like in the game
+		bool pushed = false;
+		level.board->applyMove( state, submission.moves[ i ], &pushed );
+		++submission.moveCount;
+		if( pushed )
+		{
+			++submission.pushCount;
+			solved = isSolved( state, level.goals, level.goalCount );
+		}
+	}
+
+	submission.result = solved ? VERIFY_PASS : VERIFY_UNSOLVED;
+}
+
+int main( int argc, char* args[] )
+{
+	const char* packPath = NULL;
+	const char* outPath = NULL;
+	int threads = workerCount();
+	std::vector<std::string> inputs;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		if( strncmp( args[ i ], "--", 2 ) != 0 )
+		{
+			if( strcmp( args[ i ], "-" ) == 0 )
+			{
+				inputs.push_back( args[ i ] );
+			}
+			else
+			{
+				addInput( args[ i ], inputs );
+			}
+			continue;
+		}
+
+		if( i + 1 >= argc )
+		{
+			printf( "Option %s needs a value!\n", args[ i ] );
+			return 1;
+		}
+
+		const char* value = args[ ++i ];
+		if( strcmp( args[ i - 1 ], "--pack" ) == 0 )
+		{
+			packPath = value;
+		}
+		else if( strcmp( args[ i - 1 ], "--out" ) == 0 )
+		{
+			outPath = value;
+		}
+		else if( strcmp( args[ i - 1 ], "--threads" ) == 0 )
+		{
+			threads = atoi( value ) > 0 && atoi( value ) < threads ? atoi( value ) : threads;
+			setWorkerLimit( threads );
+		}
+		else
+		{
+			printf( "Unknown option %s!\n", args[ i - 1 ] );
+			return 1;
+		}
+	}
+
+	if( inputs.empty() )
+	{
+		inputs.push_back( "-" );
+	}
+
+	//Load every level once up front, the workers only ever read them
+	std::vector<Board> boards;
+	std::vector<VerifyLevel> levels;
+	if( packPath != NULL )
+	{
+		std::vector<PackLevel> pack;
+		if( !loadLevelPack( packPath, pack ) )
+		{
+			return 1;
+		}
+
+		boards.resize( pack.size() );
+		levels.resize( pack.size() );
+		for( size_t i = 0; i < pack.size(); ++i )
+		{
+			packLevelBoard( pack[ i ], boards[ i ] );
+			levels[ i ].start = pack[ i ].start;
+			levels[ i ].goalCount = pack[ i ].goalCount;
+			memcpy( levels[ i ].goals, pack[ i ].goals, sizeof( levels[ i ].goals ) );
+		}
+	}
+	else
+	{
+		boards.resize( 1 );
+		if( !boards[ 0 ].loadFromFile( LEVEL_MAP_PATH ) )
+		{
+			printf( "Failed to load board!\n" );
+			return 1;
+		}
+
+		levels.resize( TOTAL_LEVELS );
+		for( int i = 0; i < TOTAL_LEVELS; ++i )
+		{
+			levels[ i ].start.player = boards[ 0 ].cellFromEntity( gLevels[ i ].dot.x, gLevels[ i ].dot.y );
+			levels[ i ].start.starCount = levelStarCells( boards[ 0 ], gLevels[ i ], levels[ i ].start.stars );
+			sortStars( levels[ i ].start );
+			levels[ i ].goalCount = levelGoalCells( boards[ 0 ], gLevels[ i ], levels[ i ].goals );
+		}
+	}
+
+	for( size_t i = 0; i < levels.size(); ++i )
+	{
+		levels[ i ].board = &boards[ packPath != NULL ? i : 0 ];
+	}
+
+	FILE* out = stdout;
+	if( outPath != NULL )
+	{
+		out = fopen( outPath, "w" );
+		if( out == NULL )
+		{
+			printf( "Unable to write results %s!\n", outPath );
+			return 1;
+		}
+	}
+	fprintf( out, "source,line,level,result,moves,pushes\n" );
+
+	long long counts[ VERIFY_MOVES_AFTER_SOLVE + 1 ] = { 0 };
+	long long totalMoves = 0;
+	double verifySeconds = 0.0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<Submission> batch( VERIFY_BATCH );
+	int batchSize = 0;
+	std::string line;
+
+	//Verifies the solutions read so far and writes their rows in input order
+	auto flush = [ & ]()
+	{
+		std::chrono::steady_clock::time_point verifyStart = std::chrono::steady_clock::now();
+		int chunks = ( batchSize + SOLUTIONS_PER_CHUNK - 1 ) / SOLUTIONS_PER_CHUNK;
+		parallelFor( chunks, [ & ]( int chunk )
+		{
+			int end = ( chunk + 1 ) * SOLUTIONS_PER_CHUNK < batchSize ? ( chunk + 1 ) * SOLUTIONS_PER_CHUNK : batchSize;
+			for( int i = chunk * SOLUTIONS_PER_CHUNK; i < end; ++i )
+			{
+				verify( levels, batch[ i ] );
+			}
+		} );
+		verifySeconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - verifyStart ).count();
+
+		for( int i = 0; i < batchSize; ++i )
+		{
+			const Submission& submission = batch[ i ];
+			fprintf( out, "%s,%d,%d,%s,%d,%d\n", inputs[ submission.source ].c_str(), submission.line, submission.level,
+				VERIFY_RESULT_NAMES[ submission.result ], submission.moveCount, submission.pushCount );
+			++counts[ submission.result ];
+			totalMoves += submission.moves.size();
+		}
+		batchSize = 0;
+	};
+
+	for( size_t source = 0; source < inputs.size(); ++source )
+	{
+		bool standardInput = inputs[ source ] == "-";
+		FILE* file = standardInput ? stdin : fopen( inputs[ source ].c_str(), "r" );
+		if( file == NULL )
+		{
+			printf( "Unable to open solutions %s!\n", inputs[ source ].c_str() );
+			continue;
+		}
+
+		for( int number = 1; readSolutionLine( file, line ); ++number )
+		{
+			Submission& submission = batch[ batchSize ];
+			submission.level = parseSolutionLine( line.c_str(), submission.moves );
+			if( submission.level == 0 )
+			{
+				continue;
+			}
+
+			submission.source = (int)source;
+			submission.line = number;
+			submission.result = submission.level < 0 ? VERIFY_MALFORMED : VERIFY_PASS;
+			if( ++batchSize == VERIFY_BATCH )
+			{
+				flush();
+			}
+		}
+
+		if( !standardInput )
+		{
+			fclose( file );
+		}
+	}
+	flush();
+
+	double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+	if( out != stdout && fclose( out ) != 0 )
+	{
+		printf( "Unable to write results %s!\n", outPath );
+		return 1;
+	}
+
+	//Keep the summary out of the CSV when that goes to standard output
+	FILE* summary = out == stdout ? stderr : stdout;
+	long long total = 0;
+	for( int i = 0; i <= VERIFY_MOVES_AFTER_SOLVE; ++i )
+	{
+		total += counts[ i ];
+	}
+	fprintf( summary, "Verified %lld solutions in %.2f s: %lld passed, %lld unsolved, %lld with moves after solving, %lld malformed, %lld on unknown levels\n",
+		total, seconds, counts[ VERIFY_PASS ], counts[ VERIFY_UNSOLVED ], counts[ VERIFY_MOVES_AFTER_SOLVE ], counts[ VERIFY_MALFORMED ], counts[ VERIFY_UNKNOWN_LEVEL ] );
+	if( verifySeconds > 0.0 )
+	{
+		fprintf( summary, "Replayed %lld moves in %.3f s on %d workers, %.2f M moves per second per worker\n", totalMoves, verifySeconds,
+			threads, totalMoves / verifySeconds / threads / 1e6 );
+	}
+
+	return counts[ VERIFY_PASS ] == total ? 0 : 2;
+}